@@ -161,24 +161,15 @@ public:
 //[asio_rr_notify
     void notify() noexcept {
         // Something has happened that should wake one or more fibers BEFORE
-        // suspend_timer_ expires. Reset the timer to cause it to fire
-        // immediately, causing the run_one() call to return. In theory we
-        // could use cancel() because we don't care whether suspend_timer_'s
-        // handler is called with operation_aborted or success. However --
-        // cancel() doesn't change the expiration time, and we use
-        // suspend_timer_'s expiration time to decide whether it's already
-        // set. If suspend_until() set some specific wake time, then notify()
-        // canceled it, then suspend_until() was called again with the same
-        // wake time, it would match suspend_timer_'s expiration time and we'd
-        // refrain from setting the timer. So instead of simply calling
-        // cancel(), reset the timer, which cancels the pending sleep AND sets
-        // a new expiration time. This will cause us to spin the loop twice --
-        // once for the operation_aborted handler, once for timer expiration
-        // -- but that shouldn't be a big problem.
-        suspend_timer_.async_wait([](boost::system::error_code const&){
-                                    this_fiber::yield();
-                                  });
-        suspend_timer_.expires_at( std::chrono::steady_clock::now() );
+        // suspend_timer_ expires. notify() is called by the thread which
+        // schedules a fiber owned by this thread (e.g. fiber mutex or
+        // condition variable shared between threads), so suspend_timer_ can't
+        // be touched here: asio timers are not thread safe. Post a handler
+        // instead, it makes run_one() return and yield() lets the dispatcher
+        // pick up remotely scheduled fibers. Posting is thread safe.
+        io_svc_->post([](){
+                        this_fiber::yield();
+                      });
     }
 //]
 };
@@ -28,9 +28,17 @@ struct adl_serializer<jwlrep::Credentials> {
     if (!serverUrlOrError) {
       throw std::runtime_error(fmt::format("Bad Url: '{}'", serverUrlStr));
     }
+    auto const authModeStr = json.value("authMode", "basic");
+    auto authMode = jwlrep::AuthMode::Basic;
+    if (authModeStr == "session") {
+      authMode = jwlrep::AuthMode::Session;
+    } else if (authModeStr == "token") {
+      authMode = jwlrep::AuthMode::Token;
+    }
     return jwlrep::Credentials{std::move(serverUrlOrError.value()),
                                json["userName"].get<std::string>(),
-                               json["password"].get<std::string>()};
+                               json["password"].get<std::string>(), authMode,
+                               json.value("token", "")};
     ;
   }
 };
@@ -46,20 +54,244 @@ struct adl_serializer<jwlrep::Options> {
       associations.emplace(boost::algorithm::to_lower_copy(key), value);
     }
 
+    auto const kDefaultCpuThreads = 1U;
     return jwlrep::Options{
         boost::gregorian::from_string(json["dateStart"].get<std::string>()),
         boost::gregorian::from_string(json["dateEnd"].get<std::string>()),
         json["users"].get<std::vector<std::string>>(),
-        json["defaultAssociation"].get<std::string>(), std::move(associations)};
+        json["defaultAssociation"].get<std::string>(), std::move(associations),
+        json.value("jsonParser", "nlohmann") == "simdjson"
+            ? jwlrep::JsonParser::Simdjson
+            : jwlrep::JsonParser::Nlohmann,
+        json.value("cpuThreads", kDefaultCpuThreads),
+        json.value("dataSource", "timesheetGadget") == "restApi"
+            ? jwlrep::DataSource::RestApi
+            : jwlrep::DataSource::TimesheetGadget};
     ;
   }
 };
 
+template <>
+struct adl_serializer<jwlrep::ConnectionPoolOptions> {
+  static auto from_json(json const& json) -> jwlrep::ConnectionPoolOptions {
+    auto const kDefaultMaxSize = 8U;
+    auto const kDefaultIdleTimeoutSec = 30U;
+    // Recommended by RFC 8305
+    auto const kDefaultConnectAttemptDelayMSec = 250U;
+    return jwlrep::ConnectionPoolOptions{
+        json.value("maxSize", kDefaultMaxSize),
+        std::chrono::seconds{
+            json.value("idleTimeoutSec", kDefaultIdleTimeoutSec)},
+        std::chrono::milliseconds{json.value(
+            "connectAttemptDelayMSec", kDefaultConnectAttemptDelayMSec)}};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::TlsSessionCacheOptions> {
+  static auto from_json(json const& json) -> jwlrep::TlsSessionCacheOptions {
+    return jwlrep::TlsSessionCacheOptions{json.value("enabled", true),
+                                          json.value("file", std::string{})};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::DnsCacheOptions> {
+  static auto from_json(json const& json) -> jwlrep::DnsCacheOptions {
+    auto const kDefaultTtlSec = 300U;
+    return jwlrep::DnsCacheOptions{
+        json.value("enabled", true),
+        std::chrono::seconds{json.value("ttlSec", kDefaultTtlSec)},
+        json.value("file", std::string{})};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::ResponseCacheOptions> {
+  static auto from_json(json const& json) -> jwlrep::ResponseCacheOptions {
+    auto const kDefaultMaxSizeMb = std::size_t{256U};
+    auto const kBytesInMb = std::size_t{1024U * 1024U};
+    return jwlrep::ResponseCacheOptions{
+        json.value("enabled", false),
+        json.value("directory", std::string{"jwlrep-cache"}),
+        json.value("maxSizeMb", kDefaultMaxSizeMb) * kBytesInMb,
+        json.value("trustClosedRanges", false)};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::IncrementalSyncOptions> {
+  static auto from_json(json const& json) -> jwlrep::IncrementalSyncOptions {
+    auto const kDefaultOverlapDays = 7;
+    auto const kDefaultFullResyncDays = 7;
+    return jwlrep::IncrementalSyncOptions{
+        json.value("enabled", false),
+        json.value("file", std::string{"jwlrep-sync.jsonl"}),
+        boost::gregorian::days{json.value("overlapDays", kDefaultOverlapDays)},
+        boost::gregorian::days{
+            json.value("fullResyncDays", kDefaultFullResyncDays)}};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::BatchFetchOptions> {
+  static auto from_json(json const& json) -> jwlrep::BatchFetchOptions {
+    return jwlrep::BatchFetchOptions{
+        json.value("enabled", false),
+        json.value("groups", std::vector<std::string>{})};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::RateLimitOptions> {
+  static auto from_json(json const& json) -> jwlrep::RateLimitOptions {
+    auto const kDefaultRequestsPerSec = 10.0;
+    auto const kDefaultBurst = 10U;
+    return jwlrep::RateLimitOptions{
+        json.value("enabled", false),
+        json.value("requestsPerSec", kDefaultRequestsPerSec),
+        json.value("burst", kDefaultBurst)};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::BodyBufferOptions> {
+  static auto from_json(json const& json) -> jwlrep::BodyBufferOptions {
+    auto const kDefaultMemoryBudgetKiB = std::size_t{16384U};
+    auto const kBytesPerKiB = std::size_t{1024U};
+    return jwlrep::BodyBufferOptions{
+        json.value("memoryBudgetKiB", kDefaultMemoryBudgetKiB) * kBytesPerKiB,
+        json.value("spillDirectory", std::string{})};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::CircuitBreakerOptions> {
+  static auto from_json(json const& json) -> jwlrep::CircuitBreakerOptions {
+    auto const kDefaultConsecutiveFailures = 5U;
+    auto const kDefaultFailureRate = 0.5;
+    auto const kDefaultWindowSize = 20U;
+    auto const kDefaultOpenSec = 30;
+    return jwlrep::CircuitBreakerOptions{
+        json.value("enabled", false),
+        json.value("consecutiveFailures", kDefaultConsecutiveFailures),
+        json.value("failureRate", kDefaultFailureRate),
+        json.value("windowSize", kDefaultWindowSize),
+        std::chrono::seconds{json.value("openSec", kDefaultOpenSec)}};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::AdaptiveConcurrencyOptions> {
+  static auto from_json(json const& json)
+      -> jwlrep::AdaptiveConcurrencyOptions {
+    auto const kDefaultMinLimit = 1U;
+    auto const kDefaultInitialLimit = 4U;
+    auto const kDefaultLatencyTolerance = 2.0;
+    auto const kDefaultBackoffRatio = 0.5;
+    return jwlrep::AdaptiveConcurrencyOptions{
+        json.value("enabled", false), json.value("minLimit", kDefaultMinLimit),
+        json.value("initialLimit", kDefaultInitialLimit),
+        json.value("latencyTolerance", kDefaultLatencyTolerance),
+        json.value("backoffRatio", kDefaultBackoffRatio)};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::RetryOptions> {
+  static auto from_json(json const& json) -> jwlrep::RetryOptions {
+    auto const kDefaultMaxAttempts = 4U;
+    auto const kDefaultAttemptTimeoutSec = 10U;
+    auto const kDefaultTotalTimeoutSec = 60U;
+    auto const kDefaultBaseDelayMSec = 500U;
+    auto const kDefaultMaxDelayMSec = 10000U;
+    return jwlrep::RetryOptions{
+        json.value("maxAttempts", kDefaultMaxAttempts),
+        std::chrono::seconds{
+            json.value("attemptTimeoutSec", kDefaultAttemptTimeoutSec)},
+        std::chrono::seconds{
+            json.value("totalTimeoutSec", kDefaultTotalTimeoutSec)},
+        std::chrono::milliseconds{
+            json.value("baseDelayMSec", kDefaultBaseDelayMSec)},
+        std::chrono::milliseconds{
+            json.value("maxDelayMSec", kDefaultMaxDelayMSec)}};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::HedgingOptions> {
+  static auto from_json(json const& json) -> jwlrep::HedgingOptions {
+    auto const kDefaultPercentile = 0.95;
+    auto const kDefaultMinSamples = 10U;
+    auto const kDefaultMaxHedgeRatio = 0.1;
+    return jwlrep::HedgingOptions{
+        json.value("enabled", false),
+        json.value("percentile", kDefaultPercentile),
+        json.value("minSamples", kDefaultMinSamples),
+        json.value("maxHedgeRatio", kDefaultMaxHedgeRatio)};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::DateRangeChunkingOptions> {
+  static auto from_json(json const& json) -> jwlrep::DateRangeChunkingOptions {
+    auto const kDefaultInitialDays = 31U;
+    auto const kDefaultMinDays = 7U;
+    auto const kDefaultMaxDays = 92U;
+    auto const kDefaultTargetResponseKiB = 1024U;
+    auto const kBytesPerKiB = std::size_t{1024U};
+    return jwlrep::DateRangeChunkingOptions{
+        json.value("enabled", false),
+        json.value("initialDays", kDefaultInitialDays),
+        json.value("minDays", kDefaultMinDays),
+        json.value("maxDays", kDefaultMaxDays),
+        json.value("targetResponseKiB", kDefaultTargetResponseKiB) *
+            kBytesPerKiB};
+  }
+};
+
+template <>
+struct adl_serializer<jwlrep::NetworkOptions> {
+  static auto from_json(json const& json) -> jwlrep::NetworkOptions {
+    auto const kDefaultMaxParallelRequests = 8U;
+    auto const kDefaultThreads = 1U;
+    return jwlrep::NetworkOptions{
+        json.value("connectionPool", json::object())
+            .get<jwlrep::ConnectionPoolOptions>(),
+        json.value("tlsSessionCache", json::object())
+            .get<jwlrep::TlsSessionCacheOptions>(),
+        json.value("maxParallelRequests", kDefaultMaxParallelRequests),
+        json.value("adaptiveConcurrency", json::object())
+            .get<jwlrep::AdaptiveConcurrencyOptions>(),
+        json.value("retry", json::object()).get<jwlrep::RetryOptions>(),
+        json.value("hedging", json::object()).get<jwlrep::HedgingOptions>(),
+        json.value("dateRangeChunking", json::object())
+            .get<jwlrep::DateRangeChunkingOptions>(),
+        json.value("threads", kDefaultThreads),
+        json.value("dnsCache", json::object()).get<jwlrep::DnsCacheOptions>(),
+        json.value("timingFile", std::string{}),
+        json.value("responseCache", json::object())
+            .get<jwlrep::ResponseCacheOptions>(),
+        json.value("incrementalSync", json::object())
+            .get<jwlrep::IncrementalSyncOptions>(),
+        json.value("batchFetch", json::object())
+            .get<jwlrep::BatchFetchOptions>(),
+        json.value("rateLimit", json::object())
+            .get<jwlrep::RateLimitOptions>(),
+        json.value("circuitBreaker", json::object())
+            .get<jwlrep::CircuitBreakerOptions>(),
+        json.value("bodyBuffer", json::object())
+            .get<jwlrep::BodyBufferOptions>()};
+  }
+};
+
 template <>
 struct adl_serializer<jwlrep::AppConfig> {
   static auto from_json(json const& json) -> jwlrep::AppConfig {
-    return jwlrep::AppConfig{json["credentials"].get<jwlrep::Credentials>(),
-                             json["options"].get<jwlrep::Options>()};
+    return jwlrep::AppConfig{
+        json["credentials"].get<jwlrep::Credentials>(),
+        json["options"].get<jwlrep::Options>(),
+        json.value("network", json::object()).get<jwlrep::NetworkOptions>()};
     ;
   }
 };
@@ -79,7 +311,9 @@ auto isJsonValid(nlohmann::json const& jsonAppConfigJson) -> bool {
             "additionalProperties": false,
             "properties": {"serverUrl": {"type": "string"},
                            "userName": {"type": "string"},
-                           "password": {"password": "string"}
+                           "password": {"password": "string"},
+                           "authMode": {"type": "string", "enum": ["basic", "session", "token"]},
+                           "token": {"type": "string"}
                           },
             "required": [
                  "serverUrl",
@@ -94,7 +328,10 @@ auto isJsonValid(nlohmann::json const& jsonAppConfigJson) -> bool {
                            "dateEnd": {"type": "string", "format": "date"},
                            "users": {"type": "array", "items": {"type": "string"}},
                            "defaultAssociation": {"type": "string"},
-                           "associations": {"type": "object", "additionalProperties": { "type": "string" }}
+                           "associations": {"type": "object", "additionalProperties": { "type": "string" }},
+                           "jsonParser": {"type": "string", "enum": ["nlohmann", "simdjson"]},
+                           "dataSource": {"type": "string", "enum": ["timesheetGadget", "restApi"]},
+                           "cpuThreads": {"type": "integer", "minimum": 0}
                           },
             "required": [
                  "dateStart",
@@ -103,6 +340,127 @@ auto isJsonValid(nlohmann::json const& jsonAppConfigJson) -> bool {
                  "defaultAssociation",
                  "associations"
                  ]
+        },
+        "network": {
+            "type": "object",
+            "additionalProperties": false,
+            "properties": {
+                "connectionPool": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"maxSize": {"type": "integer", "minimum": 1},
+                                   "idleTimeoutSec": {"type": "integer", "minimum": 0},
+                                   "connectAttemptDelayMSec": {"type": "integer", "minimum": 0}
+                                  }
+                },
+                "tlsSessionCache": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"enabled": {"type": "boolean"},
+                                   "file": {"type": "string"}
+                                  }
+                },
+                "maxParallelRequests": {"type": "integer", "minimum": 1},
+                "adaptiveConcurrency": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"enabled": {"type": "boolean"},
+                                   "minLimit": {"type": "integer", "minimum": 1},
+                                   "initialLimit": {"type": "integer", "minimum": 1},
+                                   "latencyTolerance": {"type": "number", "exclusiveMinimum": 1},
+                                   "backoffRatio": {"type": "number", "exclusiveMinimum": 0, "exclusiveMaximum": 1}
+                                  }
+                },
+                "retry": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"maxAttempts": {"type": "integer", "minimum": 1},
+                                   "attemptTimeoutSec": {"type": "integer", "minimum": 1},
+                                   "totalTimeoutSec": {"type": "integer", "minimum": 1},
+                                   "baseDelayMSec": {"type": "integer", "minimum": 0},
+                                   "maxDelayMSec": {"type": "integer", "minimum": 0}
+                                  }
+                },
+                "hedging": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"enabled": {"type": "boolean"},
+                                   "percentile": {"type": "number", "minimum": 0, "maximum": 1},
+                                   "minSamples": {"type": "integer", "minimum": 1},
+                                   "maxHedgeRatio": {"type": "number", "minimum": 0, "maximum": 1}
+                                  }
+                },
+                "dateRangeChunking": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"enabled": {"type": "boolean"},
+                                   "initialDays": {"type": "integer", "minimum": 1},
+                                   "minDays": {"type": "integer", "minimum": 1},
+                                   "maxDays": {"type": "integer", "minimum": 1},
+                                   "targetResponseKiB": {"type": "integer", "minimum": 1}
+                                  }
+                },
+                "threads": {"type": "integer", "minimum": 0},
+                "dnsCache": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"enabled": {"type": "boolean"},
+                                   "ttlSec": {"type": "integer", "minimum": 1},
+                                   "file": {"type": "string"}
+                                  }
+                },
+                "timingFile": {"type": "string"},
+                "responseCache": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"enabled": {"type": "boolean"},
+                                   "directory": {"type": "string", "minLength": 1},
+                                   "maxSizeMb": {"type": "integer", "minimum": 1},
+                                   "trustClosedRanges": {"type": "boolean"}
+                                  }
+                },
+                "incrementalSync": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"enabled": {"type": "boolean"},
+                                   "file": {"type": "string", "minLength": 1},
+                                   "overlapDays": {"type": "integer", "minimum": 0},
+                                   "fullResyncDays": {"type": "integer", "minimum": 1}
+                                  }
+                },
+                "batchFetch": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"enabled": {"type": "boolean"},
+                                   "groups": {"type": "array", "items": {"type": "string", "minLength": 1}}
+                                  }
+                },
+                "rateLimit": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"enabled": {"type": "boolean"},
+                                   "requestsPerSec": {"type": "number", "exclusiveMinimum": 0},
+                                   "burst": {"type": "integer", "minimum": 1}
+                                  }
+                },
+                "circuitBreaker": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"enabled": {"type": "boolean"},
+                                   "consecutiveFailures": {"type": "integer", "minimum": 1},
+                                   "failureRate": {"type": "number", "exclusiveMinimum": 0, "maximum": 1},
+                                   "windowSize": {"type": "integer", "minimum": 1},
+                                   "openSec": {"type": "integer", "minimum": 1}
+                                  }
+                },
+                "bodyBuffer": {
+                    "type": "object",
+                    "additionalProperties": false,
+                    "properties": {"memoryBudgetKiB": {"type": "integer", "minimum": 1},
+                                   "spillDirectory": {"type": "string"}
+                                  }
+                }
+            }
         }
     },
     "required": [
@@ -213,10 +571,13 @@ auto processCmdArgs(int argc, char** argv) -> Expected<AppConfig> {
 }
 
 Credentials::Credentials(Url serverUrl, std::string userName,
-                         std::string password)
+                         std::string password, AuthMode authMode,
+                         std::string token)
     : serverUrl_(std::move(serverUrl)),
       userName_(std::move(userName)),
-      password_(std::move(password)) {}
+      password_(std::move(password)),
+      authMode_(authMode),
+      token_(std::move(token)) {}
 
 auto Credentials::serverUrl() const -> Url const& { return serverUrl_; }
 
@@ -224,15 +585,23 @@ auto Credentials::userName() const -> std::string const& { return userName_; }
 
 auto Credentials::password() const -> std::string const& { return password_; }
 
+auto Credentials::authMode() const -> AuthMode { return authMode_; }
+
+auto Credentials::token() const -> std::string const& { return token_; }
+
 Options::Options(
     boost::gregorian::date dateStart, boost::gregorian::date dateEnd,
     std::vector<std::string>&& users, std::string defaultAssociation,
-    boost::container::flat_map<std::string, std::string>&& associations)
+    boost::container::flat_map<std::string, std::string>&& associations,
+    JsonParser jsonParser, std::size_t cpuThreads, DataSource dataSource)
     : dateStart_(dateStart),
       dateEnd_(dateEnd),
       users_(std::move(users)),
       defaultAssociation_(std::move(defaultAssociation)),
-      associations_(std::move(associations)) {}
+      associations_(std::move(associations)),
+      jsonParser_(jsonParser),
+      cpuThreads_(cpuThreads),
+      dataSource_(dataSource) {}
 
 auto Options::dateStart() const -> boost::gregorian::date const& {
   return dateStart_;
@@ -255,8 +624,361 @@ auto Options::associations() const
   return associations_;
 }
 
-AppConfig::AppConfig(Credentials&& credentials, Options&& options)
-    : credentials_(credentials), options_(options) {}
+auto Options::jsonParser() const -> JsonParser { return jsonParser_; }
+
+auto Options::cpuThreads() const -> std::size_t { return cpuThreads_; }
+
+auto Options::dataSource() const -> DataSource { return dataSource_; }
+
+ConnectionPoolOptions::ConnectionPoolOptions(
+    std::size_t maxSize, std::chrono::seconds idleTimeout,
+    std::chrono::milliseconds connectAttemptDelay)
+    : maxSize_(maxSize),
+      idleTimeout_(idleTimeout),
+      connectAttemptDelay_(connectAttemptDelay) {}
+
+auto ConnectionPoolOptions::maxSize() const -> std::size_t { return maxSize_; }
+
+auto ConnectionPoolOptions::idleTimeout() const
+    -> std::chrono::seconds const& {
+  return idleTimeout_;
+}
+
+auto ConnectionPoolOptions::connectAttemptDelay() const
+    -> std::chrono::milliseconds const& {
+  return connectAttemptDelay_;
+}
+
+TlsSessionCacheOptions::TlsSessionCacheOptions(bool enabled,
+                                               std::string filePath)
+    : enabled_(enabled), filePath_(std::move(filePath)) {}
+
+auto TlsSessionCacheOptions::enabled() const -> bool { return enabled_; }
+
+auto TlsSessionCacheOptions::filePath() const -> std::string const& {
+  return filePath_;
+}
+
+DnsCacheOptions::DnsCacheOptions(bool enabled, std::chrono::seconds ttl,
+                                 std::string filePath)
+    : enabled_(enabled), ttl_(ttl), filePath_(std::move(filePath)) {}
+
+auto DnsCacheOptions::enabled() const -> bool { return enabled_; }
+
+auto DnsCacheOptions::ttl() const -> std::chrono::seconds const& {
+  return ttl_;
+}
+
+auto DnsCacheOptions::filePath() const -> std::string const& {
+  return filePath_;
+}
+
+ResponseCacheOptions::ResponseCacheOptions(bool enabled,
+                                           std::string directoryPath,
+                                           std::size_t maxSize,
+                                           bool trustClosedRanges)
+    : enabled_(enabled),
+      directoryPath_(std::move(directoryPath)),
+      maxSize_(maxSize),
+      trustClosedRanges_(trustClosedRanges) {}
+
+auto ResponseCacheOptions::enabled() const -> bool { return enabled_; }
+
+auto ResponseCacheOptions::directoryPath() const -> std::string const& {
+  return directoryPath_;
+}
+
+auto ResponseCacheOptions::maxSize() const -> std::size_t { return maxSize_; }
+
+auto ResponseCacheOptions::trustClosedRanges() const -> bool {
+  return trustClosedRanges_;
+}
+
+IncrementalSyncOptions::IncrementalSyncOptions(
+    bool enabled, std::string filePath, boost::gregorian::days overlap,
+    boost::gregorian::days fullResyncInterval)
+    : enabled_(enabled),
+      filePath_(std::move(filePath)),
+      overlap_(overlap),
+      fullResyncInterval_(fullResyncInterval) {}
+
+auto IncrementalSyncOptions::enabled() const -> bool { return enabled_; }
+
+auto IncrementalSyncOptions::filePath() const -> std::string const& {
+  return filePath_;
+}
+
+auto IncrementalSyncOptions::overlap() const -> boost::gregorian::days const& {
+  return overlap_;
+}
+
+auto IncrementalSyncOptions::fullResyncInterval() const
+    -> boost::gregorian::days const& {
+  return fullResyncInterval_;
+}
+
+BatchFetchOptions::BatchFetchOptions(bool enabled,
+                                     std::vector<std::string> groups)
+    : enabled_(enabled), groups_(std::move(groups)) {}
+
+auto BatchFetchOptions::enabled() const -> bool { return enabled_; }
+
+auto BatchFetchOptions::groups() const -> std::vector<std::string> const& {
+  return groups_;
+}
+
+RateLimitOptions::RateLimitOptions(bool enabled, double requestsPerSec,
+                                   std::size_t burst)
+    : enabled_(enabled), requestsPerSec_(requestsPerSec), burst_(burst) {}
+
+auto RateLimitOptions::enabled() const -> bool { return enabled_; }
+
+auto RateLimitOptions::requestsPerSec() const -> double {
+  return requestsPerSec_;
+}
+
+auto RateLimitOptions::burst() const -> std::size_t { return burst_; }
+
+BodyBufferOptions::BodyBufferOptions(std::size_t memoryBudget,
+                                     std::string spillDirectory)
+    : memoryBudget_(memoryBudget),
+      spillDirectory_(std::move(spillDirectory)) {}
+
+auto BodyBufferOptions::memoryBudget() const -> std::size_t {
+  return memoryBudget_;
+}
+
+auto BodyBufferOptions::spillDirectory() const -> std::string const& {
+  return spillDirectory_;
+}
+
+CircuitBreakerOptions::CircuitBreakerOptions(bool enabled,
+                                             std::size_t consecutiveFailures,
+                                             double failureRate,
+                                             std::size_t windowSize,
+                                             std::chrono::seconds openDuration)
+    : enabled_(enabled),
+      consecutiveFailures_(consecutiveFailures),
+      failureRate_(failureRate),
+      windowSize_(windowSize),
+      openDuration_(openDuration) {}
+
+auto CircuitBreakerOptions::enabled() const -> bool { return enabled_; }
+
+auto CircuitBreakerOptions::consecutiveFailures() const -> std::size_t {
+  return consecutiveFailures_;
+}
+
+auto CircuitBreakerOptions::failureRate() const -> double {
+  return failureRate_;
+}
+
+auto CircuitBreakerOptions::windowSize() const -> std::size_t {
+  return windowSize_;
+}
+
+auto CircuitBreakerOptions::openDuration() const
+    -> std::chrono::seconds const& {
+  return openDuration_;
+}
+
+AdaptiveConcurrencyOptions::AdaptiveConcurrencyOptions(bool enabled,
+                                                       std::size_t minLimit,
+                                                       std::size_t initialLimit,
+                                                       double latencyTolerance,
+                                                       double backoffRatio)
+    : enabled_(enabled),
+      minLimit_(minLimit),
+      initialLimit_(initialLimit),
+      latencyTolerance_(latencyTolerance),
+      backoffRatio_(backoffRatio) {}
+
+auto AdaptiveConcurrencyOptions::enabled() const -> bool { return enabled_; }
+
+auto AdaptiveConcurrencyOptions::minLimit() const -> std::size_t {
+  return minLimit_;
+}
+
+auto AdaptiveConcurrencyOptions::initialLimit() const -> std::size_t {
+  return initialLimit_;
+}
+
+auto AdaptiveConcurrencyOptions::latencyTolerance() const -> double {
+  return latencyTolerance_;
+}
+
+auto AdaptiveConcurrencyOptions::backoffRatio() const -> double {
+  return backoffRatio_;
+}
+
+RetryOptions::RetryOptions(std::size_t maxAttempts,
+                           std::chrono::seconds attemptTimeout,
+                           std::chrono::seconds totalTimeout,
+                           std::chrono::milliseconds baseDelay,
+                           std::chrono::milliseconds maxDelay)
+    : maxAttempts_(maxAttempts),
+      attemptTimeout_(attemptTimeout),
+      totalTimeout_(totalTimeout),
+      baseDelay_(baseDelay),
+      maxDelay_(maxDelay) {}
+
+auto RetryOptions::maxAttempts() const -> std::size_t { return maxAttempts_; }
+
+auto RetryOptions::attemptTimeout() const -> std::chrono::seconds const& {
+  return attemptTimeout_;
+}
+
+auto RetryOptions::totalTimeout() const -> std::chrono::seconds const& {
+  return totalTimeout_;
+}
+
+auto RetryOptions::baseDelay() const -> std::chrono::milliseconds const& {
+  return baseDelay_;
+}
+
+auto RetryOptions::maxDelay() const -> std::chrono::milliseconds const& {
+  return maxDelay_;
+}
+
+HedgingOptions::HedgingOptions(bool enabled, double percentile,
+                               std::size_t minSamples, double maxHedgeRatio)
+    : enabled_(enabled),
+      percentile_(percentile),
+      minSamples_(minSamples),
+      maxHedgeRatio_(maxHedgeRatio) {}
+
+auto HedgingOptions::enabled() const -> bool { return enabled_; }
+
+auto HedgingOptions::percentile() const -> double { return percentile_; }
+
+auto HedgingOptions::minSamples() const -> std::size_t { return minSamples_; }
+
+auto HedgingOptions::maxHedgeRatio() const -> double { return maxHedgeRatio_; }
+
+DateRangeChunkingOptions::DateRangeChunkingOptions(
+    bool enabled, std::size_t initialDays, std::size_t minDays,
+    std::size_t maxDays, std::size_t targetResponseSize)
+    : enabled_(enabled),
+      initialDays_(initialDays),
+      minDays_(minDays),
+      maxDays_(maxDays),
+      targetResponseSize_(targetResponseSize) {}
+
+auto DateRangeChunkingOptions::enabled() const -> bool { return enabled_; }
+
+auto DateRangeChunkingOptions::initialDays() const -> std::size_t {
+  return initialDays_;
+}
+
+auto DateRangeChunkingOptions::minDays() const -> std::size_t {
+  return minDays_;
+}
+
+auto DateRangeChunkingOptions::maxDays() const -> std::size_t {
+  return maxDays_;
+}
+
+auto DateRangeChunkingOptions::targetResponseSize() const -> std::size_t {
+  return targetResponseSize_;
+}
+
+NetworkOptions::NetworkOptions(ConnectionPoolOptions connectionPool,
+                               TlsSessionCacheOptions tlsSessionCache,
+                               std::size_t maxParallelRequests,
+                               AdaptiveConcurrencyOptions adaptiveConcurrency,
+                               RetryOptions retry, HedgingOptions hedging,
+                               DateRangeChunkingOptions dateRangeChunking,
+                               std::size_t threads, DnsCacheOptions dnsCache,
+                               std::string timingFilePath,
+                               ResponseCacheOptions responseCache,
+                               IncrementalSyncOptions incrementalSync,
+                               BatchFetchOptions batchFetch,
+                               RateLimitOptions rateLimit,
+                               CircuitBreakerOptions circuitBreaker,
+                               BodyBufferOptions bodyBuffer)
+    : connectionPool_(connectionPool),
+      tlsSessionCache_(std::move(tlsSessionCache)),
+      maxParallelRequests_(maxParallelRequests),
+      adaptiveConcurrency_(adaptiveConcurrency),
+      retry_(retry),
+      hedging_(hedging),
+      dateRangeChunking_(dateRangeChunking),
+      threads_(threads),
+      dnsCache_(std::move(dnsCache)),
+      timingFilePath_(std::move(timingFilePath)),
+      responseCache_(std::move(responseCache)),
+      incrementalSync_(std::move(incrementalSync)),
+      batchFetch_(std::move(batchFetch)),
+      rateLimit_(rateLimit),
+      circuitBreaker_(circuitBreaker),
+      bodyBuffer_(std::move(bodyBuffer)) {}
+
+auto NetworkOptions::connectionPool() const -> ConnectionPoolOptions const& {
+  return connectionPool_;
+}
+
+auto NetworkOptions::tlsSessionCache() const
+    -> TlsSessionCacheOptions const& {
+  return tlsSessionCache_;
+}
+
+auto NetworkOptions::maxParallelRequests() const -> std::size_t {
+  return maxParallelRequests_;
+}
+
+auto NetworkOptions::adaptiveConcurrency() const
+    -> AdaptiveConcurrencyOptions const& {
+  return adaptiveConcurrency_;
+}
+
+auto NetworkOptions::retry() const -> RetryOptions const& { return retry_; }
+
+auto NetworkOptions::hedging() const -> HedgingOptions const& {
+  return hedging_;
+}
+
+auto NetworkOptions::dateRangeChunking() const
+    -> DateRangeChunkingOptions const& {
+  return dateRangeChunking_;
+}
+
+auto NetworkOptions::threads() const -> std::size_t { return threads_; }
+
+auto NetworkOptions::dnsCache() const -> DnsCacheOptions const& {
+  return dnsCache_;
+}
+
+auto NetworkOptions::timingFilePath() const -> std::string const& {
+  return timingFilePath_;
+}
+
+auto NetworkOptions::responseCache() const -> ResponseCacheOptions const& {
+  return responseCache_;
+}
+
+auto NetworkOptions::incrementalSync() const -> IncrementalSyncOptions const& {
+  return incrementalSync_;
+}
+
+auto NetworkOptions::batchFetch() const -> BatchFetchOptions const& {
+  return batchFetch_;
+}
+
+auto NetworkOptions::rateLimit() const -> RateLimitOptions const& {
+  return rateLimit_;
+}
+
+auto NetworkOptions::circuitBreaker() const -> CircuitBreakerOptions const& {
+  return circuitBreaker_;
+}
+
+auto NetworkOptions::bodyBuffer() const -> BodyBufferOptions const& {
+  return bodyBuffer_;
+}
+
+AppConfig::AppConfig(Credentials&& credentials, Options&& options,
+                     NetworkOptions&& network)
+    : credentials_(credentials), options_(options), network_(network) {}
 
 auto AppConfig::credentials() const -> Credentials const& {
   return credentials_;
@@ -264,4 +986,6 @@ auto AppConfig::credentials() const -> Credentials const& {
 
 auto AppConfig::options() const -> Options const& { return options_; }
 
+auto AppConfig::network() const -> NetworkOptions const& { return network_; }
+
 }  // namespace jwlrep
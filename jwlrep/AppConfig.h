@@ -6,17 +6,40 @@
 
 #include <jwlrep/Outcome.h>
 #include <jwlrep/Url.h>
+#include <jwlrep/Worklog.h>
 
 #include <boost/container/flat_map.hpp>
 #include <boost/date_time/gregorian/gregorian.hpp>
+#include <chrono>
 #include <string>
 #include <vector>
 
 namespace jwlrep {
 
+/**
+ * How requests are authenticated on the server.
+ */
+enum class AuthMode {
+  /**
+   * User name and password in each request.
+   */
+  Basic,
+  /**
+   * User name and password are verified once, then the session cookies are
+   * sent instead.
+   */
+  Session,
+  /**
+   * Personal access token is verified once, then the session cookies are
+   * sent instead.
+   */
+  Token
+};
+
 class Credentials {
  public:
-  Credentials(Url serverUrl, std::string userName, std::string password);
+  Credentials(Url serverUrl, std::string userName, std::string password,
+              AuthMode authMode = AuthMode::Basic, std::string token = {});
 
   [[nodiscard]] auto serverUrl() const -> Url const&;
 
@@ -24,19 +47,45 @@ class Credentials {
 
   [[nodiscard]] auto password() const -> std::string const&;
 
+  [[nodiscard]] auto authMode() const -> AuthMode;
+
+  [[nodiscard]] auto token() const -> std::string const&;
+
  private:
   Url serverUrl_;
 
   std::string userName_;
 
   std::string password_;
+
+  AuthMode authMode_;
+
+  std::string token_;
+};
+
+/**
+ * Jira API which timesheets are loaded from.
+ */
+enum class DataSource {
+  /**
+   * Timesheet of the user in the single response. Requires the plugin.
+   */
+  TimesheetGadget,
+  /**
+   * JQL search of the issues with the worklog of the user, then worklog of
+   * each issue. Pages are requested in parallel.
+   */
+  RestApi
 };
 
 class Options {
  public:
   Options(boost::gregorian::date dateStart, boost::gregorian::date dateEnd,
           std::vector<std::string>&& users, std::string defaultAssociation,
-          boost::container::flat_map<std::string, std::string>&& associations);
+          boost::container::flat_map<std::string, std::string>&& associations,
+          JsonParser jsonParser = JsonParser::Nlohmann,
+          std::size_t cpuThreads = 1U,
+          DataSource dataSource = DataSource::TimesheetGadget);
 
   [[nodiscard]] auto dateStart() const -> boost::gregorian::date const&;
 
@@ -49,6 +98,19 @@ class Options {
   [[nodiscard]] auto associations() const
       -> boost::container::flat_map<std::string, std::string> const&;
 
+  /**
+   * Backend of the timesheet parser.
+   */
+  [[nodiscard]] auto jsonParser() const -> JsonParser;
+
+  /**
+   * Count of threads which decode, parse timesheets and generate the report
+   * off the network thread. Zero means that this work is done in place.
+   */
+  [[nodiscard]] auto cpuThreads() const -> std::size_t;
+
+  [[nodiscard]] auto dataSource() const -> DataSource;
+
  private:
   boost::gregorian::date dateStart_;
 
@@ -59,20 +121,557 @@ class Options {
   std::string defaultAssociation_;
 
   boost::container::flat_map<std::string, std::string> associations_;
+
+  JsonParser jsonParser_;
+
+  std::size_t cpuThreads_;
+
+  DataSource dataSource_;
+};
+
+class ConnectionPoolOptions {
+ public:
+  ConnectionPoolOptions(std::size_t maxSize, std::chrono::seconds idleTimeout,
+                        std::chrono::milliseconds connectAttemptDelay);
+
+  /**
+   * Max count of simultaneously opened connections to the single host.
+   */
+  [[nodiscard]] auto maxSize() const -> std::size_t;
+
+  /**
+   * Idle connections older than this are closed instead of being reused.
+   */
+  [[nodiscard]] auto idleTimeout() const -> std::chrono::seconds const&;
+
+  /**
+   * Delay before connecting to the next resolved address while the previous
+   * attempt is still in progress (RFC 8305). Zero means that the next address
+   * is tried only after the previous attempt has failed.
+   */
+  [[nodiscard]] auto connectAttemptDelay() const
+      -> std::chrono::milliseconds const&;
+
+ private:
+  std::size_t maxSize_;
+
+  std::chrono::seconds idleTimeout_;
+
+  std::chrono::milliseconds connectAttemptDelay_;
+};
+
+class TlsSessionCacheOptions {
+ public:
+  TlsSessionCacheOptions(bool enabled, std::string filePath);
+
+  [[nodiscard]] auto enabled() const -> bool;
+
+  /**
+   * File to keep sessions between runs. Empty if sessions are kept in memory
+   * only.
+   */
+  [[nodiscard]] auto filePath() const -> std::string const&;
+
+ private:
+  bool enabled_;
+
+  std::string filePath_;
+};
+
+/**
+ * Cache of the resolved server addresses.
+ */
+class DnsCacheOptions {
+ public:
+  DnsCacheOptions(bool enabled, std::chrono::seconds ttl, std::string filePath);
+
+  [[nodiscard]] auto enabled() const -> bool;
+
+  /**
+   * Time while resolved addresses are considered fresh.
+   */
+  [[nodiscard]] auto ttl() const -> std::chrono::seconds const&;
+
+  /**
+   * File to keep addresses between runs. Empty if addresses are kept in
+   * memory only.
+   */
+  [[nodiscard]] auto filePath() const -> std::string const&;
+
+ private:
+  bool enabled_;
+
+  std::chrono::seconds ttl_;
+
+  std::string filePath_;
+};
+
+/**
+ * Settings of the on-disk cache of the timesheet responses. Cached response
+ * is revalidated with the conditional request.
+ */
+class ResponseCacheOptions {
+ public:
+  ResponseCacheOptions(bool enabled, std::string directoryPath,
+                       std::size_t maxSize, bool trustClosedRanges);
+
+  [[nodiscard]] auto enabled() const -> bool;
+
+  [[nodiscard]] auto directoryPath() const -> std::string const&;
+
+  /**
+   * Max total size of the cached bodies in bytes. Least recently used
+   * responses are evicted when it is exceeded.
+   */
+  [[nodiscard]] auto maxSize() const -> std::size_t;
+
+  /**
+   * Serve responses for the date ranges which have ended before today
+   * without revalidation. Worklog of the past days might still be changed,
+   * so such report might be outdated.
+   */
+  [[nodiscard]] auto trustClosedRanges() const -> bool;
+
+ private:
+  bool enabled_;
+
+  std::string directoryPath_;
+
+  std::size_t maxSize_;
+
+  bool trustClosedRanges_;
+};
+
+/**
+ * Settings of the incremental sync. Timesheets of the previous run are kept
+ * in the file, so only the days since the last sync are requested. Entries
+ * which are edited, moved or deleted on the server before the overlap stay
+ * stale in the report till the next full resync. Timesheets of the batched
+ * groups are always requested for the whole report period.
+ */
+class IncrementalSyncOptions {
+ public:
+  IncrementalSyncOptions(bool enabled, std::string filePath,
+                         boost::gregorian::days overlap,
+                         boost::gregorian::days fullResyncInterval);
+
+  [[nodiscard]] auto enabled() const -> bool;
+
+  [[nodiscard]] auto filePath() const -> std::string const&;
+
+  /**
+   * Days before the last sync which are requested again. Worklog is often
+   * reported after the day it belongs to.
+   */
+  [[nodiscard]] auto overlap() const -> boost::gregorian::days const&;
+
+  /**
+   * Days after which the whole report period of the user is requested again
+   * to pick up the changes made before the overlap.
+   */
+  [[nodiscard]] auto fullResyncInterval() const
+      -> boost::gregorian::days const&;
+
+ private:
+  bool enabled_;
+
+  std::string filePath_;
+
+  boost::gregorian::days overlap_;
+
+  boost::gregorian::days fullResyncInterval_;
+};
+
+/**
+ * Settings of the batched fetch. Timesheets of the whole Jira group are
+ * requested at once and split by the entry author. Users which are not
+ * found in any group response are requested one by one.
+ */
+class BatchFetchOptions {
+ public:
+  BatchFetchOptions(bool enabled, std::vector<std::string> groups);
+
+  [[nodiscard]] auto enabled() const -> bool;
+
+  [[nodiscard]] auto groups() const -> std::vector<std::string> const&;
+
+ private:
+  bool enabled_;
+
+  std::vector<std::string> groups_;
+};
+
+/**
+ * Settings of the client side limit of the request rate (token bucket).
+ * Requests of all threads share the same budget.
+ */
+class RateLimitOptions {
+ public:
+  RateLimitOptions(bool enabled, double requestsPerSec, std::size_t burst);
+
+  [[nodiscard]] auto enabled() const -> bool;
+
+  /**
+   * Sustained rate of the requests.
+   */
+  [[nodiscard]] auto requestsPerSec() const -> double;
+
+  /**
+   * Count of the requests which might be made at once after idle period.
+   */
+  [[nodiscard]] auto burst() const -> std::size_t;
+
+ private:
+  bool enabled_;
+
+  double requestsPerSec_;
+
+  std::size_t burst_;
+};
+
+/**
+ * Settings of the buffer of the response body which is parsed as a whole
+ * (simdjson parser, REST API pages). Body which exceeds the memory budget is
+ * written to the temporary file and read from its memory-mapped view. Budget
+ * limits only the buffered body. Memory of the parser and of the parsed result
+ * is not limited.
+ */
+class BodyBufferOptions {
+ public:
+  BodyBufferOptions(std::size_t memoryBudget, std::string spillDirectory);
+
+  /**
+   * Bytes of the body which are kept in memory.
+   */
+  [[nodiscard]] auto memoryBudget() const -> std::size_t;
+
+  /**
+   * Directory of the temporary files. System temporary directory if empty.
+   */
+  [[nodiscard]] auto spillDirectory() const -> std::string const&;
+
+ private:
+  std::size_t memoryBudget_;
+
+  std::string spillDirectory_;
+};
+
+/**
+ * Settings of the circuit breaker. Once the server looks down, requests fail
+ * without being sent. After the open period single probe request is let
+ * through, its success closes the circuit.
+ */
+class CircuitBreakerOptions {
+ public:
+  CircuitBreakerOptions(bool enabled, std::size_t consecutiveFailures,
+                        double failureRate, std::size_t windowSize,
+                        std::chrono::seconds openDuration);
+
+  [[nodiscard]] auto enabled() const -> bool;
+
+  /**
+   * Circuit is opened after this many failures in a row.
+   */
+  [[nodiscard]] auto consecutiveFailures() const -> std::size_t;
+
+  /**
+   * Circuit is opened when share of the failures among the last windowSize
+   * requests reaches this rate.
+   */
+  [[nodiscard]] auto failureRate() const -> double;
+
+  [[nodiscard]] auto windowSize() const -> std::size_t;
+
+  /**
+   * Time till the probe request is let through.
+   */
+  [[nodiscard]] auto openDuration() const -> std::chrono::seconds const&;
+
+ private:
+  bool enabled_;
+
+  std::size_t consecutiveFailures_;
+
+  double failureRate_;
+
+  std::size_t windowSize_;
+
+  std::chrono::seconds openDuration_;
+};
+
+/**
+ * Settings of the in-flight requests limit which is adapted to the observed
+ * latency and errors. Limit never exceeds max count of parallel requests.
+ */
+class AdaptiveConcurrencyOptions {
+ public:
+  AdaptiveConcurrencyOptions(bool enabled, std::size_t minLimit,
+                             std::size_t initialLimit, double latencyTolerance,
+                             double backoffRatio);
+
+  [[nodiscard]] auto enabled() const -> bool;
+
+  [[nodiscard]] auto minLimit() const -> std::size_t;
+
+  [[nodiscard]] auto initialLimit() const -> std::size_t;
+
+  /**
+   * Limit is cut when recent latency exceeds the baseline this many times.
+   */
+  [[nodiscard]] auto latencyTolerance() const -> double;
+
+  /**
+   * Limit is multiplied by this ratio when it is cut.
+   */
+  [[nodiscard]] auto backoffRatio() const -> double;
+
+ private:
+  bool enabled_;
+
+  std::size_t minLimit_;
+
+  std::size_t initialLimit_;
+
+  double latencyTolerance_;
+
+  double backoffRatio_;
+};
+
+/**
+ * Settings of repeating of the failed requests.
+ */
+class RetryOptions {
+ public:
+  RetryOptions(std::size_t maxAttempts, std::chrono::seconds attemptTimeout,
+               std::chrono::seconds totalTimeout,
+               std::chrono::milliseconds baseDelay,
+               std::chrono::milliseconds maxDelay);
+
+  /**
+   * Max count of attempts including the first one.
+   */
+  [[nodiscard]] auto maxAttempts() const -> std::size_t;
+
+  /**
+   * Timeout of each network operation of the single attempt.
+   */
+  [[nodiscard]] auto attemptTimeout() const -> std::chrono::seconds const&;
+
+  /**
+   * Time budget of all attempts including delays between them.
+   */
+  [[nodiscard]] auto totalTimeout() const -> std::chrono::seconds const&;
+
+  /**
+   * Delay before the first retry. Doubled for each next retry.
+   */
+  [[nodiscard]] auto baseDelay() const -> std::chrono::milliseconds const&;
+
+  [[nodiscard]] auto maxDelay() const -> std::chrono::milliseconds const&;
+
+ private:
+  std::size_t maxAttempts_;
+
+  std::chrono::seconds attemptTimeout_;
+
+  std::chrono::seconds totalTimeout_;
+
+  std::chrono::milliseconds baseDelay_;
+
+  std::chrono::milliseconds maxDelay_;
+};
+
+/**
+ * Settings of sending duplicates of the slow requests.
+ */
+class HedgingOptions {
+ public:
+  HedgingOptions(bool enabled, double percentile, std::size_t minSamples,
+                 double maxHedgeRatio);
+
+  [[nodiscard]] auto enabled() const -> bool;
+
+  /**
+   * Duplicate is sent when request is outstanding longer than this
+   * percentile (in range [0, 1]) of latencies of the completed requests.
+   */
+  [[nodiscard]] auto percentile() const -> double;
+
+  /**
+   * Count of completed requests required to start hedging.
+   */
+  [[nodiscard]] auto minSamples() const -> std::size_t;
+
+  /**
+   * Max ratio of duplicates to the count of requests.
+   */
+  [[nodiscard]] auto maxHedgeRatio() const -> double;
+
+ private:
+  bool enabled_;
+
+  double percentile_;
+
+  std::size_t minSamples_;
+
+  double maxHedgeRatio_;
+};
+
+/**
+ * Settings of splitting of the report period into sub-ranges which are
+ * requested in parallel.
+ */
+class DateRangeChunkingOptions {
+ public:
+  DateRangeChunkingOptions(bool enabled, std::size_t initialDays,
+                           std::size_t minDays, std::size_t maxDays,
+                           std::size_t targetResponseSize);
+
+  [[nodiscard]] auto enabled() const -> bool;
+
+  /**
+   * Length of the sub-range in days until response sizes are observed.
+   */
+  [[nodiscard]] auto initialDays() const -> std::size_t;
+
+  [[nodiscard]] auto minDays() const -> std::size_t;
+
+  [[nodiscard]] auto maxDays() const -> std::size_t;
+
+  /**
+   * Length of the sub-range is adjusted to get responses of this size in
+   * bytes.
+   */
+  [[nodiscard]] auto targetResponseSize() const -> std::size_t;
+
+ private:
+  bool enabled_;
+
+  std::size_t initialDays_;
+
+  std::size_t minDays_;
+
+  std::size_t maxDays_;
+
+  std::size_t targetResponseSize_;
+};
+
+/**
+ * Tuning of the communication with Jira. Optional section of the config,
+ * defaults are used for the missing values.
+ */
+class NetworkOptions {
+ public:
+  NetworkOptions(ConnectionPoolOptions connectionPool,
+                 TlsSessionCacheOptions tlsSessionCache,
+                 std::size_t maxParallelRequests,
+                 AdaptiveConcurrencyOptions adaptiveConcurrency,
+                 RetryOptions retry, HedgingOptions hedging,
+                 DateRangeChunkingOptions dateRangeChunking,
+                 std::size_t threads, DnsCacheOptions dnsCache,
+                 std::string timingFilePath,
+                 ResponseCacheOptions responseCache,
+                 IncrementalSyncOptions incrementalSync,
+                 BatchFetchOptions batchFetch, RateLimitOptions rateLimit,
+                 CircuitBreakerOptions circuitBreaker,
+                 BodyBufferOptions bodyBuffer);
+
+  [[nodiscard]] auto connectionPool() const -> ConnectionPoolOptions const&;
+
+  [[nodiscard]] auto tlsSessionCache() const -> TlsSessionCacheOptions const&;
+
+  /**
+   * Max count of requests which are processed simultaneously.
+   */
+  [[nodiscard]] auto maxParallelRequests() const -> std::size_t;
+
+  [[nodiscard]] auto adaptiveConcurrency() const
+      -> AdaptiveConcurrencyOptions const&;
+
+  [[nodiscard]] auto retry() const -> RetryOptions const&;
+
+  [[nodiscard]] auto hedging() const -> HedgingOptions const&;
+
+  [[nodiscard]] auto dateRangeChunking() const
+      -> DateRangeChunkingOptions const&;
+
+  /**
+   * Count of threads which run network I/O and parsing. Zero means the count
+   * of hardware threads.
+   */
+  [[nodiscard]] auto threads() const -> std::size_t;
+
+  [[nodiscard]] auto dnsCache() const -> DnsCacheOptions const&;
+
+  /**
+   * File for the timings of the requests (JSON lines). Empty if timings are
+   * only logged.
+   */
+  [[nodiscard]] auto timingFilePath() const -> std::string const&;
+
+  [[nodiscard]] auto responseCache() const -> ResponseCacheOptions const&;
+
+  [[nodiscard]] auto incrementalSync() const -> IncrementalSyncOptions const&;
+
+  [[nodiscard]] auto batchFetch() const -> BatchFetchOptions const&;
+
+  [[nodiscard]] auto rateLimit() const -> RateLimitOptions const&;
+
+  [[nodiscard]] auto circuitBreaker() const -> CircuitBreakerOptions const&;
+
+  [[nodiscard]] auto bodyBuffer() const -> BodyBufferOptions const&;
+
+ private:
+  ConnectionPoolOptions connectionPool_;
+
+  TlsSessionCacheOptions tlsSessionCache_;
+
+  std::size_t maxParallelRequests_;
+
+  AdaptiveConcurrencyOptions adaptiveConcurrency_;
+
+  RetryOptions retry_;
+
+  HedgingOptions hedging_;
+
+  DateRangeChunkingOptions dateRangeChunking_;
+
+  std::size_t threads_;
+
+  DnsCacheOptions dnsCache_;
+
+  std::string timingFilePath_;
+
+  ResponseCacheOptions responseCache_;
+
+  IncrementalSyncOptions incrementalSync_;
+
+  BatchFetchOptions batchFetch_;
+
+  RateLimitOptions rateLimit_;
+
+  CircuitBreakerOptions circuitBreaker_;
+
+  BodyBufferOptions bodyBuffer_;
 };
 
 class AppConfig {
  public:
-  AppConfig(Credentials&& credentials, Options&& options);
+  AppConfig(Credentials&& credentials, Options&& options,
+            NetworkOptions&& network);
 
   [[nodiscard]] auto credentials() const -> Credentials const&;
 
   [[nodiscard]] auto options() const -> Options const&;
 
+  [[nodiscard]] auto network() const -> NetworkOptions const&;
+
  private:
   Credentials credentials_;
 
   Options options_;
+
+  NetworkOptions network_;
 };
 
 auto createAppConfigFromJson(std::string const& configFileJsonStr)
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AuthSession.h>
+#include <jwlrep/GeneralError.h>
+#include <jwlrep/Logger.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <mutex>
+#include <string_view>
+
+namespace jwlrep {
+
+auto AuthSession::ticket() const -> Ticket {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  return {cookie_, generation_};
+}
+
+auto AuthSession::renew(std::size_t rejectedGeneration, Login const& login)
+    -> std::error_code {
+  // Lock is held during the login, so the other requests wait for the new
+  // session rather than open their own ones
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  if (generation_ != rejectedGeneration) {
+    return GeneralError::Success;
+  }
+
+  auto responseOrError = login();
+  if (!responseOrError) {
+    return responseOrError.error();
+  }
+  auto const& response = responseOrError.value();
+  if (response.result() != boost::beast::http::status::ok) {
+    LOG_ERROR("Login has been rejected with status {}", response.result_int());
+    return GeneralError::AuthenticationFailed;
+  }
+  for (auto& [name, value] : parseSetCookies(response)) {
+    if (value.empty()) {
+      cookies_.erase(name);
+    } else {
+      cookies_.insert_or_assign(name, std::move(value));
+    }
+  }
+  if (cookies_.empty()) {
+    LOG_ERROR("Server hasn't opened the session");
+    return GeneralError::AuthenticationFailed;
+  }
+
+  cookie_.clear();
+  for (auto const& [name, value] : cookies_) {
+    if (!cookie_.empty()) {
+      cookie_ += "; ";
+    }
+    cookie_ += name + "=" + value;
+  }
+  ++generation_;
+  ++loginsCount_;
+  LOG_DEBUG("Session has been opened, {} cookies", cookies_.size());
+  return GeneralError::Success;
+}
+
+auto AuthSession::loginsCount() const -> std::size_t {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  return loginsCount_;
+}
+
+auto parseSetCookies(HttpResponse const& response)
+    -> std::map<std::string, std::string> {
+  std::map<std::string, std::string> cookies;
+  // JSESSIONID=ABC; Path=/; HttpOnly
+  auto const [begin, end] =
+      response.equal_range(boost::beast::http::field::set_cookie);
+  for (auto it = begin; it != end; ++it) {
+    std::string_view const setCookie{it->value().data(), it->value().size()};
+    auto const pairEnd = setCookie.find(';');
+    auto const pair = setCookie.substr(0U, pairEnd);
+    auto const equalPos = pair.find('=');
+    if (equalPos == std::string_view::npos) {
+      continue;
+    }
+    auto name =
+        boost::algorithm::trim_copy(std::string{pair.substr(0U, equalPos)});
+    if (name.empty()) {
+      continue;
+    }
+    auto value =
+        boost::algorithm::trim_copy(std::string{pair.substr(equalPos + 1U)});
+    // Expired cookie is the way to delete it
+    auto const attributes = pairEnd == std::string_view::npos
+                                ? std::string_view{}
+                                : setCookie.substr(pairEnd);
+    if (boost::algorithm::icontains(attributes, "max-age=0")) {
+      value.clear();
+    }
+    cookies.insert_or_assign(std::move(name), std::move(value));
+  }
+  return cookies;
+}
+
+}  // namespace jwlrep
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/NetUtil.h>
+#include <jwlrep/Outcome.h>
+
+#include <boost/fiber/mutex.hpp>
+#include <functional>
+#include <map>
+#include <string>
+#include <system_error>
+
+namespace jwlrep {
+
+/**
+ * Jira session which is shared by all requests and connections of the run.
+ * Credentials are verified by the server once, when the session is opened,
+ * the other requests carry the session cookies only. Session which is
+ * rejected by the server is opened anew by the single request, concurrent
+ * requests wait for it.
+ */
+class AuthSession final {
+ public:
+  /**
+   * Authenticated request. Server responds with the session cookies.
+   */
+  using Login = std::function<Expected<HttpResponse>()>;
+
+  /**
+   * Value of the Cookie field and the generation of the session it belongs
+   * to. Cookie is empty if the session hasn't been opened yet.
+   */
+  struct Ticket {
+    std::string cookie;
+
+    std::size_t generation{0U};
+  };
+
+  AuthSession() = default;
+
+  AuthSession(AuthSession const&) = delete;
+  auto operator=(AuthSession const&) -> AuthSession& = delete;
+
+  [[nodiscard]] auto ticket() const -> Ticket;
+
+  /**
+   * Open the session unless it has been reopened after the given generation.
+   */
+  auto renew(std::size_t rejectedGeneration, Login const& login)
+      -> std::error_code;
+
+  /**
+   * Count of the sessions opened by the run.
+   */
+  [[nodiscard]] auto loginsCount() const -> std::size_t;
+
+ private:
+  mutable boost::fibers::mutex mutex_;
+
+  std::map<std::string, std::string> cookies_;
+
+  std::string cookie_;
+
+  std::size_t generation_{0U};
+
+  std::size_t loginsCount_{0U};
+};
+
+/**
+ * Cookies which are set by the response. Attributes are dropped, deleted
+ * cookies have empty value.
+ */
+auto parseSetCookies(HttpResponse const& response)
+    -> std::map<std::string, std::string>;
+
+}  // namespace jwlrep
@@ -3,6 +3,7 @@
 // Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
 
 #include <jwlrep/Base64.h>
+#include <jwlrep/GeneralError.h>
 
 #include <boost/beast/core/detail/base64.hpp>
 
@@ -25,4 +26,26 @@ auto base64Encode(std::string_view dataView) -> std::string {
                         dataView.size());
 }
 
+auto base64Decode(std::string_view dataView) -> Expected<std::string> {
+  auto const kMaxPaddingSize = 2U;
+  auto const dataEnd = dataView.find_last_not_of('=');
+  auto const paddingSize =
+      dataEnd == std::string_view::npos ? 0U : dataView.size() - dataEnd - 1U;
+  if (paddingSize > kMaxPaddingSize) {
+    return GeneralError::WrongArg;
+  }
+  dataView.remove_suffix(paddingSize);
+
+  std::string result;
+  result.resize(
+      boost::beast::detail::base64::decoded_size(dataView.size() + 3U));
+  auto const [written, read] = boost::beast::detail::base64::decode(
+      &result[0], dataView.data(), dataView.size());
+  if (read != dataView.size()) {
+    return GeneralError::WrongArg;
+  }
+  result.resize(written);
+  return result;
+}
+
 }  // namespace jwlrep
\ No newline at end of file
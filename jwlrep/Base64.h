@@ -4,10 +4,15 @@
 
 #pragma once
 
+#include <jwlrep/Outcome.h>
+
+#include <string>
 #include <string_view>
 
 namespace jwlrep {
 
 std::string base64Encode(std::string_view dataView);
 
+auto base64Decode(std::string_view dataView) -> Expected<std::string>;
+
 }  // namespace jwlrep
\ No newline at end of file
@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <functional>
+#include <string_view>
+
+namespace jwlrep {
+
+/**
+ * Supplier of the consecutive parts of the document. Returns empty chunk when
+ * document is over. Might suspend the calling fiber while waiting for the
+ * data. Chunk is valid until the next call.
+ */
+using ChunkSource = std::function<std::string_view()>;
+
+}  // namespace jwlrep
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/CircuitBreaker.h>
+#include <jwlrep/Logger.h>
+
+#include <mutex>
+#include <utility>
+
+namespace jwlrep {
+
+CircuitBreaker::CircuitBreaker(CircuitBreakerOptions const& options)
+    : consecutiveFailuresLimit_(options.consecutiveFailures()),
+      failureRateLimit_(options.failureRate()),
+      windowSize_(options.windowSize()),
+      openDuration_(options.openDuration()) {}
+
+auto CircuitBreaker::allow(Clock::time_point now) -> Permit {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  switch (state_) {
+    case State::Closed:
+      return Permit::Request;
+    case State::Open:
+      if (now - openedAt_ < openDuration_) {
+        break;
+      }
+      LOG_INFO("Circuit is half-open, sending probe request");
+      state_ = State::HalfOpen;
+      isProbeInFlight_ = true;
+      return Permit::Probe;
+    case State::HalfOpen:
+      if (isProbeInFlight_) {
+        break;
+      }
+      isProbeInFlight_ = true;
+      return Permit::Probe;
+  }
+  ++stats_.rejected;
+  return Permit::Rejected;
+}
+
+void CircuitBreaker::onResult(Permit permit, bool isFailure,
+                              Clock::time_point now) {
+  std::function<void()> openHandler;
+  {
+    std::unique_lock<boost::fibers::mutex> lock(mutex_);
+    if (!update(permit, isFailure, now)) {
+      return;
+    }
+    openHandler = openHandler_;
+  }
+  // Handler takes the locks of the waiting requests
+  if (openHandler) {
+    openHandler();
+  }
+}
+
+auto CircuitBreaker::isAllowed(Permit permit) const -> bool {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  return permit == Permit::Probe || state_ == State::Closed;
+}
+
+void CircuitBreaker::onAborted() {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  ++stats_.aborted;
+}
+
+void CircuitBreaker::setOpenHandler(std::function<void()> handler) {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  openHandler_ = std::move(handler);
+}
+
+auto CircuitBreaker::state() const -> State {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  return state_;
+}
+
+auto CircuitBreaker::stats() const -> Stats {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  return stats_;
+}
+
+auto CircuitBreaker::update(Permit permit, bool isFailure,
+                            Clock::time_point now) -> bool {
+  switch (state_) {
+    case State::HalfOpen:
+      if (permit != Permit::Probe) {
+        // Request has been sent before the circuit was opened
+        return false;
+      }
+      isProbeInFlight_ = false;
+      if (isFailure) {
+        open(now);
+        return true;
+      }
+      LOG_INFO("Circuit is closed, probe request has succeeded");
+      state_ = State::Closed;
+      consecutiveFailures_ = 0U;
+      window_.clear();
+      windowFailures_ = 0U;
+      return false;
+    case State::Open:
+      // Request has been sent before the circuit was opened
+      return false;
+    case State::Closed:
+      break;
+  }
+
+  consecutiveFailures_ = isFailure ? consecutiveFailures_ + 1U : 0U;
+  window_.push_back(isFailure);
+  windowFailures_ += isFailure ? 1U : 0U;
+  if (window_.size() > windowSize_) {
+    windowFailures_ -= window_.front() ? 1U : 0U;
+    window_.pop_front();
+  }
+
+  auto const isRateExceeded =
+      window_.size() == windowSize_ &&
+      static_cast<double>(windowFailures_) >=
+          failureRateLimit_ * static_cast<double>(windowSize_);
+  if (consecutiveFailures_ >= consecutiveFailuresLimit_ || isRateExceeded) {
+    open(now);
+    return true;
+  }
+  return false;
+}
+
+void CircuitBreaker::open(Clock::time_point now) {
+  LOG_WARN("Circuit is open for {} s, server looks down",
+           std::chrono::duration_cast<std::chrono::seconds>(openDuration_)
+               .count());
+  state_ = State::Open;
+  openedAt_ = now;
+  ++stats_.trips;
+}
+
+}  // namespace jwlrep
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <boost/fiber/mutex.hpp>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+
+namespace jwlrep {
+
+class CircuitBreakerOptions;
+
+/**
+ * Stops sending requests to the server which looks down. Circuit is opened
+ * after a run of consecutive failures or when failure rate among the recent
+ * requests is too high. Requests are rejected while it is open. Once the open
+ * period is over the single probe request is let through (half-open state):
+ * its success closes the circuit, failure opens it again. Requests which are
+ * in flight when the circuit is opened are not cancelled: they have already
+ * reached the server, so cancelling them frees no server capacity, while the
+ * response might still arrive. Their results don't change the state.
+ * Requests which are allowed but are still waiting for their turn are not
+ * sent once the circuit is opened.
+ */
+class CircuitBreaker final {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class State { Closed, Open, HalfOpen };
+
+  /**
+   * Kind of the request allowed by the circuit. Only the result of the probe
+   * decides whether half-open circuit is closed.
+   */
+  enum class Permit { Rejected, Request, Probe };
+
+  struct Stats {
+    /**
+     * Count of transitions to the open state.
+     */
+    std::size_t trips{0U};
+
+    std::size_t rejected{0U};
+
+    /**
+     * Requests which have been allowed but have not been sent, since the
+     * circuit was opened while they were waiting for their turn.
+     */
+    std::size_t aborted{0U};
+  };
+
+  explicit CircuitBreaker(CircuitBreakerOptions const& options);
+
+  CircuitBreaker(CircuitBreaker const&) = delete;
+  auto operator=(CircuitBreaker const&) -> CircuitBreaker& = delete;
+
+  /**
+   * Check whether request might be sent. Result of the allowed request has to
+   * be reported by onResult with the returned permit, otherwise half-open
+   * circuit never lets the next probe through.
+   */
+  auto allow(Clock::time_point now) -> Permit;
+
+  void onResult(Permit permit, bool isFailure, Clock::time_point now);
+
+  /**
+   * Check again just before sending that the allowed request still might be
+   * sent. Probe always might, other requests only while circuit is closed.
+   */
+  [[nodiscard]] auto isAllowed(Permit permit) const -> bool;
+
+  /**
+   * Account the allowed request which has not been sent since the circuit has
+   * been opened. It is reported instead of the result.
+   */
+  void onAborted();
+
+  /**
+   * Called once the circuit is opened, outside of the lock. Allows to wake up
+   * the requests which wait for their turn, so they see the circuit open.
+   * Might be called by any thread.
+   */
+  void setOpenHandler(std::function<void()> handler);
+
+  [[nodiscard]] auto state() const -> State;
+
+  [[nodiscard]] auto stats() const -> Stats;
+
+ private:
+  /**
+   * Account the result. True if the circuit has been opened.
+   */
+  auto update(Permit permit, bool isFailure, Clock::time_point now) -> bool;
+
+  void open(Clock::time_point now);
+
+  mutable boost::fibers::mutex mutex_;
+
+  std::size_t const consecutiveFailuresLimit_;
+
+  double const failureRateLimit_;
+
+  std::size_t const windowSize_;
+
+  std::chrono::nanoseconds const openDuration_;
+
+  State state_{State::Closed};
+
+  Clock::time_point openedAt_;
+
+  bool isProbeInFlight_{false};
+
+  std::size_t consecutiveFailures_{0U};
+
+  /**
+   * Results of the recent requests, true for the failure.
+   */
+  std::deque<bool> window_;
+
+  std::size_t windowFailures_{0U};
+
+  Stats stats_;
+
+  std::function<void()> openHandler_;
+};
+
+}  // namespace jwlrep
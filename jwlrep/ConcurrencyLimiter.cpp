@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/ConcurrencyLimiter.h>
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <mutex>
+
+namespace {
+
+auto const kRecentLatencyWeight = 0.3;
+auto const kBaselineLatencyWeight = 0.05;
+
+/**
+ * Latency is not judged until the baseline is established.
+ */
+auto const kWarmupSamplesCount = 5U;
+
+auto movingAverage(double average, double sample, double weight) -> double {
+  return average + weight * (sample - average);
+}
+
+}  // namespace
+
+namespace jwlrep {
+
+AimdController::AimdController(AdaptiveConcurrencyOptions const& options,
+                               std::size_t maxLimit)
+    : minLimit_(static_cast<double>(std::max<std::size_t>(
+          1U, std::min(options.minLimit(), maxLimit)))),
+      maxLimit_(static_cast<double>(std::max<std::size_t>(1U, maxLimit))),
+      latencyTolerance_(options.latencyTolerance()),
+      backoffRatio_(options.backoffRatio()),
+      limit_(std::clamp(static_cast<double>(options.initialLimit()), minLimit_,
+                        maxLimit_)),
+      samplesSinceDecrease_(limit()),
+      startedAt_(Clock::now()) {
+  recordLimit();
+}
+
+void AimdController::onSample(std::chrono::nanoseconds latency,
+                              RequestOutcome outcome) {
+  ++samplesSinceDecrease_;
+  switch (outcome) {
+    case RequestOutcome::Overload:
+      decrease();
+      return;
+    case RequestOutcome::Failure:
+      return;
+    case RequestOutcome::Success:
+      break;
+  }
+
+  auto const latencyMSec =
+      std::chrono::duration<double, std::milli>(latency).count();
+  if (samplesCount_ == 0U) {
+    baselineLatency_ = latencyMSec;
+    recentLatency_ = latencyMSec;
+  } else {
+    baselineLatency_ =
+        movingAverage(baselineLatency_, latencyMSec, kBaselineLatencyWeight);
+    recentLatency_ =
+        movingAverage(recentLatency_, latencyMSec, kRecentLatencyWeight);
+  }
+  ++samplesCount_;
+
+  if (samplesCount_ > kWarmupSamplesCount &&
+      recentLatency_ > baselineLatency_ * latencyTolerance_) {
+    decrease();
+  } else {
+    increase();
+  }
+}
+
+auto AimdController::limit() const -> std::size_t {
+  return static_cast<std::size_t>(limit_);
+}
+
+auto AimdController::trajectory() const
+    -> std::vector<std::pair<std::chrono::milliseconds, std::size_t>> const& {
+  return trajectory_;
+}
+
+void AimdController::increase() {
+  auto const previousLimit = limit();
+  // Grows by one after the whole window of limit() requests
+  limit_ = std::min(maxLimit_, limit_ + 1.0 / static_cast<double>(limit()));
+  if (limit() != previousLimit) {
+    recordLimit();
+  }
+}
+
+void AimdController::decrease() {
+  if (samplesSinceDecrease_ < limit()) {
+    return;
+  }
+  samplesSinceDecrease_ = 0U;
+
+  auto const previousLimit = limit();
+  limit_ = std::max(minLimit_, limit_ * backoffRatio_);
+  if (limit() != previousLimit) {
+    recordLimit();
+  }
+}
+
+void AimdController::recordLimit() {
+  trajectory_.emplace_back(
+      std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                            startedAt_),
+      limit());
+}
+
+ConcurrencyLimiter::ConcurrencyLimiter(
+    AdaptiveConcurrencyOptions const& options, std::size_t maxLimit)
+    : controller_(options, maxLimit) {}
+
+auto ConcurrencyLimiter::acquire(std::function<bool()> const& isCancelled)
+    -> bool {
+  auto const isWaitCancelled = [&isCancelled]() {
+    return isCancelled && isCancelled();
+  };
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  released_.wait(lock, [this, &isWaitCancelled]() {
+    return inFlight_ < controller_.limit() || isWaitCancelled();
+  });
+  if (isWaitCancelled()) {
+    return false;
+  }
+  ++inFlight_;
+  return true;
+}
+
+void ConcurrencyLimiter::wakeUp() {
+  // Lock is taken, so the fiber which is about to wait doesn't miss it
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  released_.notify_all();
+}
+
+void ConcurrencyLimiter::release(std::chrono::nanoseconds latency,
+                                 RequestOutcome outcome) {
+  {
+    std::unique_lock<boost::fibers::mutex> lock(mutex_);
+    --inFlight_;
+    controller_.onSample(latency, outcome);
+  }
+  released_.notify_all();
+}
+
+auto ConcurrencyLimiter::limit() const -> std::size_t {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  return controller_.limit();
+}
+
+auto ConcurrencyLimiter::trajectoryToString() const -> std::string {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  std::string result;
+  for (auto const& [offset, limit] : controller_.trajectory()) {
+    if (!result.empty()) {
+      result += ", ";
+    }
+    auto const kMSecsPerSec = 1000.0;
+    result += fmt::format("{:.1f}s:{}", offset.count() / kMSecsPerSec, limit);
+  }
+  return result;
+}
+
+}  // namespace jwlrep
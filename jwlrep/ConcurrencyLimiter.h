@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace jwlrep {
+
+class AdaptiveConcurrencyOptions;
+
+/**
+ * Result of the request from the point of view of the server load.
+ */
+enum class RequestOutcome {
+  /**
+   * Request has been served.
+   */
+  Success,
+  /**
+   * Server is overloaded: timeout, 429 Too Many Requests, 503 Service
+   * Unavailable, 504 Gateway Timeout.
+   */
+  Overload,
+  /**
+   * Request has failed by the reason not related to the server load.
+   */
+  Failure
+};
+
+/**
+ * Additive increase/multiplicative decrease of the in-flight requests limit.
+ * Limit grows by one per limit-size window of requests while latency is
+ * stable and is cut when server is overloaded or latency climbs over the
+ * baseline.
+ */
+class AimdController final {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  AimdController(AdaptiveConcurrencyOptions const& options,
+                 std::size_t maxLimit);
+
+  void onSample(std::chrono::nanoseconds latency, RequestOutcome outcome);
+
+  [[nodiscard]] auto limit() const -> std::size_t;
+
+  /**
+   * Limit changes since creation: time offset and new limit.
+   */
+  [[nodiscard]] auto trajectory() const
+      -> std::vector<std::pair<std::chrono::milliseconds, std::size_t>> const&;
+
+ private:
+  void increase();
+
+  void decrease();
+
+  void recordLimit();
+
+  double const minLimit_;
+
+  double const maxLimit_;
+
+  double const latencyTolerance_;
+
+  double const backoffRatio_;
+
+  double limit_;
+
+  /**
+   * Slow moving average of latency of successful requests.
+   */
+  double baselineLatency_{0.0};
+
+  /**
+   * Fast moving average of latency of successful requests.
+   */
+  double recentLatency_{0.0};
+
+  std::size_t samplesCount_{0U};
+
+  /**
+   * Limit is cut at most once per window to not react several times to the
+   * same burst of failures.
+   */
+  std::size_t samplesSinceDecrease_{0U};
+
+  Clock::time_point const startedAt_;
+
+  std::vector<std::pair<std::chrono::milliseconds, std::size_t>> trajectory_;
+};
+
+/**
+ * Fiber aware gate which keeps count of in-flight requests under the limit
+ * calculated by AimdController.
+ */
+class ConcurrencyLimiter final {
+ public:
+  ConcurrencyLimiter(AdaptiveConcurrencyOptions const& options,
+                     std::size_t maxLimit);
+
+  /**
+   * Suspend the fiber until there is a room for one more request. Condition
+   * (if given) cancels the wait, false is returned and no room is taken then.
+   * It is checked once the fiber is woken up.
+   */
+  auto acquire(std::function<bool()> const& isCancelled = {}) -> bool;
+
+  /**
+   * Wake up the waiting fibers, so they check their cancellation.
+   */
+  void wakeUp();
+
+  /**
+   * Finish request started with acquire() and account its result.
+   */
+  void release(std::chrono::nanoseconds latency, RequestOutcome outcome);
+
+  [[nodiscard]] auto limit() const -> std::size_t;
+
+  /**
+   * Limit trajectory in the form "time:limit, ...".
+   */
+  [[nodiscard]] auto trajectoryToString() const -> std::string;
+
+ private:
+  mutable boost::fibers::mutex mutex_;
+
+  boost::fibers::condition_variable released_;
+
+  AimdController controller_;
+
+  std::size_t inFlight_{0U};
+};
+
+}  // namespace jwlrep
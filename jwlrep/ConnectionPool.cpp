@@ -0,0 +1,377 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/ConnectionPool.h>
+#include <jwlrep/DnsCache.h>
+#include <jwlrep/ErrorCodeUtil.h>
+#include <jwlrep/Logger.h>
+#include <jwlrep/NetUtil.h>
+#include <jwlrep/RequestCancellation.h>
+#include <jwlrep/RequestTiming.h>
+#include <jwlrep/ScopeGuard.h>
+#include <jwlrep/TlsSessionCache.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <mutex>
+
+namespace {
+
+auto const kBodyBufferSize = 64U * 1024U;
+
+}  // namespace
+
+namespace jwlrep {
+
+Connection::Connection(boost::asio::io_context& ioContext,
+                       boost::asio::ssl::context& sslContext)
+    : stream_(ioContext, sslContext),
+      bodyBuffer_(kBodyBufferSize),
+      lastUsed_(std::chrono::steady_clock::now()) {}
+
+auto Connection::stream() -> SslStream& { return stream_; }
+
+auto Connection::buffer() -> boost::beast::flat_buffer& { return buffer_; }
+
+auto Connection::bodyBuffer() -> std::vector<char>& { return bodyBuffer_; }
+
+auto Connection::lastUsed() const
+    -> std::chrono::steady_clock::time_point const& {
+  return lastUsed_;
+}
+
+void Connection::touch() { lastUsed_ = std::chrono::steady_clock::now(); }
+
+auto Connection::isAlive() -> bool {
+  auto& socket = boost::beast::get_lowest_layer(stream_).socket();
+  if (!socket.is_open()) {
+    return false;
+  }
+
+  // Idle keep-alive connection must have no application data to read.
+  // Received records are read through the TLS layer: TLS 1.3 server sends
+  // session tickets after the handshake, they are consumed here and don't
+  // make the connection look dead. Socket is non-blocking, so the read stops
+  // once the received records are processed. Application data, close_notify
+  // or closed socket mean that the connection can't be reused.
+  boost::system::error_code errorCode;
+  socket.non_blocking(true, errorCode);
+  if (errorCode) {
+    return false;
+  }
+  std::array<char, 1U> probe{};
+  auto const size = stream_.read_some(boost::asio::buffer(probe), errorCode);
+  boost::system::error_code ignored;
+  socket.non_blocking(false, ignored);
+
+  return size == 0U && errorCode == boost::asio::error::would_block;
+}
+
+void Connection::close() {
+  boost::system::error_code ignored;
+  boost::beast::get_lowest_layer(stream_).socket().shutdown(
+      boost::asio::ip::tcp::socket::shutdown_both, ignored);
+  boost::beast::get_lowest_layer(stream_).close();
+}
+
+void Connection::retire() {
+  // OpenSSL marks session as not resumable if connection is dropped without
+  // TLS shutdown. Connection is dropped deliberately, so keep the session.
+  SSL_set_shutdown(stream_.native_handle(),
+                   SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+  close();
+}
+
+ConnectionPool::Lease::Lease(ConnectionPool& pool,
+                             std::unique_ptr<Connection> connection,
+                             bool reused,
+                             std::chrono::steady_clock::time_point takenAt)
+    : pool_(&pool),
+      connection_(std::move(connection)),
+      reused_(reused),
+      takenAt_(takenAt) {}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_),
+      connection_(std::move(other.connection_)),
+      reused_(other.reused_),
+      takenAt_(other.takenAt_),
+      keepAlive_(other.keepAlive_) {}
+
+ConnectionPool::Lease::~Lease() {
+  if (connection_) {
+    pool_->release(std::move(connection_), keepAlive_);
+  }
+}
+
+auto ConnectionPool::Lease::stream() -> SslStream& {
+  return connection_->stream();
+}
+
+auto ConnectionPool::Lease::buffer() -> boost::beast::flat_buffer& {
+  return connection_->buffer();
+}
+
+auto ConnectionPool::Lease::bodyBuffer() -> std::vector<char>& {
+  return connection_->bodyBuffer();
+}
+
+auto ConnectionPool::Lease::isReused() const -> bool { return reused_; }
+
+auto ConnectionPool::Lease::takenAt() const
+    -> std::chrono::steady_clock::time_point {
+  return takenAt_;
+}
+
+void ConnectionPool::Lease::keepAlive() { keepAlive_ = true; }
+
+ConnectionPool::ConnectionPool(
+    boost::asio::io_context& ioContext, boost::asio::ssl::context& sslContext,
+    TlsSessionCache* tlsSessionCache, DnsCache* dnsCache, std::string host,
+    boost::asio::ip::tcp::resolver::results_type endpoints,
+    ConnectionPoolOptions const& options)
+    : ioContext_(ioContext),
+      sslContext_(sslContext),
+      tlsSessionCache_(tlsSessionCache),
+      dnsCache_(dnsCache),
+      host_(std::move(host)),
+      sessionKey_(fmt::format(
+          "{}:{}", host_,
+          endpoints.empty() ? 0U : endpoints.begin()->endpoint().port())),
+      endpoints_(std::move(endpoints)),
+      maxSize_(options.maxSize()),
+      idleTimeout_(options.idleTimeout()),
+      connectAttemptDelay_(options.connectAttemptDelay()) {
+  assert(maxSize_ > 0U);
+}
+
+auto ConnectionPool::acquire(std::chrono::nanoseconds timeout,
+                             boost::fibers::asio::yield_t& yield,
+                             RequestTiming* timing,
+                             RequestCancellation* cancellation)
+    -> Expected<Lease> {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  ++usersCount_;
+  if (cancellation != nullptr) {
+    cancellation->attach([this]() { connectionReleased_.notify_all(); });
+  }
+  auto const detachGuard = ScopeGuard{[cancellation]() {
+    if (cancellation != nullptr) {
+      cancellation->attach({});
+    }
+  }};
+  while (true) {
+    if (cancellation != nullptr && cancellation->isCancelled()) {
+      --usersCount_;
+      connectionReleased_.notify_all();
+      return toStd(boost::asio::error::operation_aborted);
+    }
+
+    evictExpired();
+
+    while (!idle_.empty()) {
+      auto connection = std::move(idle_.back());
+      idle_.pop_back();
+      if (connection->isAlive()) {
+        ++stats_.reused;
+        return Lease{*this, std::move(connection), true,
+                     std::chrono::steady_clock::now()};
+      }
+      LOG_DEBUG("Idle connection to {} has been closed by peer", host_);
+      connection->close();
+      --openedCount_;
+      ++stats_.evicted;
+    }
+
+    if (openedCount_ < maxSize_) {
+      break;
+    }
+
+    connectionReleased_.wait(lock);
+  }
+
+  // Reserve the slot and connect without holding the lock.
+  ++openedCount_;
+  lock.unlock();
+  auto const takenAt = std::chrono::steady_clock::now();
+
+  auto connectionOrError = connect(timeout, yield, timing, cancellation);
+
+  lock.lock();
+  if (!connectionOrError) {
+    --openedCount_;
+    --usersCount_;
+    connectionReleased_.notify_all();
+    return connectionOrError.error();
+  }
+  ++stats_.created;
+  return Lease{*this, std::move(connectionOrError.value()), false, takenAt};
+}
+
+void ConnectionPool::wakeUp() {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  connectionReleased_.notify_all();
+}
+
+void ConnectionPool::shutdown(std::chrono::nanoseconds timeout,
+                              boost::fibers::asio::yield_t& yield) {
+  std::vector<std::unique_ptr<Connection>> idle;
+  auto const deadline = std::chrono::steady_clock::now() + timeout;
+  {
+    std::unique_lock<boost::fibers::mutex> lock(mutex_);
+    connectionReleased_.wait(lock, [this]() { return usersCount_ == 0U; });
+    idle.swap(idle_);
+    openedCount_ -= idle.size();
+  }
+
+  for (auto& connection : idle) {
+    boost::beast::error_code errorCode;
+    boost::beast::get_lowest_layer(connection->stream()).expires_at(deadline);
+    connection->stream().async_shutdown(yield[errorCode]);
+    if (errorCode && errorCode != boost::asio::error::eof &&
+        errorCode != boost::asio::ssl::error::stream_truncated) {
+      LOG_DEBUG("Failed to shutdown connection. Error: {}",
+                errorCode.message());
+    }
+    connection->retire();
+  }
+}
+
+auto ConnectionPool::stats() const -> Stats {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  return stats_;
+}
+
+auto ConnectionPool::connect(std::chrono::nanoseconds timeout,
+                             boost::fibers::asio::yield_t& yield,
+                             RequestTiming* timing,
+                             RequestCancellation* cancellation)
+    -> Expected<std::unique_ptr<Connection>> {
+  namespace beast = boost::beast;
+  namespace ssl = boost::asio::ssl;
+
+  // Lookup, connect and handshake share the timeout
+  auto const deadline = std::chrono::steady_clock::now() + timeout;
+  auto connection = std::make_unique<Connection>(ioContext_, sslContext_);
+  auto& stream = connection->stream();
+
+  // Set SNI Hostname (many hosts need this to handshake successfully)
+  if (SSL_set_tlsext_host_name(stream.native_handle(), host_.c_str()) == 0) {
+    beast::error_code const errorCode{static_cast<int>(::ERR_get_error()),
+                                      boost::asio::error::get_ssl_category()};
+    LOG_ERROR("Failed to set SNI host name. Error: {}", errorCode.message());
+    return toStd(errorCode);
+  }
+
+  if (tlsSessionCache_ != nullptr) {
+    tlsSessionCache_->prepare(stream.native_handle(), sessionKey_);
+  }
+
+  // Cache is refreshed in the background, so addresses of the host might
+  // differ from the initial ones
+  auto endpoints = endpoints_;
+  if (dnsCache_ != nullptr && !endpoints_.empty()) {
+    auto const lookupStartedAt = RequestTiming::Clock::now();
+    auto endpointsOrError = dnsCache_->lookup(
+        ioContext_, endpoints_.begin()->host_name(),
+        endpoints_.begin()->service_name(), yield);
+    if (timing != nullptr) {
+      timing->addSince(RequestPhase::Dns, lookupStartedAt);
+    }
+    if (endpointsOrError) {
+      endpoints = std::move(endpointsOrError.value());
+    }
+  }
+
+  // Lookup is shared with the other fibers through the cache, so it is not
+  // aborted. Cancelled request stops right after it.
+  if (cancellation != nullptr && cancellation->isCancelled()) {
+    return toStd(boost::asio::error::operation_aborted);
+  }
+  auto const connectStartedAt = RequestTiming::Clock::now();
+  auto socketOrError = connectFirst(
+      ioContext_, interleaveAddressFamilies(endpoints, preferredProtocol_),
+      connectAttemptDelay_,
+      std::max(std::chrono::nanoseconds::zero(),
+               std::chrono::nanoseconds{deadline -
+                                        std::chrono::steady_clock::now()}),
+      cancellation);
+  if (!socketOrError) {
+    LOG_ERROR("Failed to connect. Error: {}", socketOrError.error().message());
+    return socketOrError.error();
+  }
+  if (timing != nullptr) {
+    timing->addSince(RequestPhase::Connect, connectStartedAt);
+  }
+  auto& socket = socketOrError.value();
+  boost::system::error_code endpointErrorCode;
+  auto const protocol = socket.remote_endpoint(endpointErrorCode).protocol();
+  if (!endpointErrorCode && preferredProtocol_ != protocol) {
+    LOG_DEBUG("Prefer {} addresses of {}",
+              protocol == boost::asio::ip::tcp::v6() ? "IPv6" : "IPv4", host_);
+    preferredProtocol_ = protocol;
+  }
+  beast::get_lowest_layer(stream).socket() = std::move(socket);
+
+  beast::error_code errorCode;
+  if (cancellation != nullptr) {
+    if (cancellation->isCancelled()) {
+      return toStd(boost::asio::error::operation_aborted);
+    }
+    cancellation->attach(
+        [&stream]() { beast::get_lowest_layer(stream).cancel(); });
+  }
+  auto const handshakeStartedAt = RequestTiming::Clock::now();
+  beast::get_lowest_layer(stream).expires_at(deadline);
+  stream.async_handshake(ssl::stream_base::client, yield[errorCode]);
+  if (cancellation != nullptr) {
+    cancellation->attach({});
+  }
+  if (errorCode) {
+    LOG_ERROR("Failed to make handshake. Error: {}", errorCode.message());
+    return toStd(errorCode);
+  }
+  if (timing != nullptr) {
+    timing->addSince(RequestPhase::TlsHandshake, handshakeStartedAt);
+  }
+
+  if (tlsSessionCache_ != nullptr) {
+    tlsSessionCache_->onHandshake(stream.native_handle());
+  }
+
+  return connection;
+}
+
+void ConnectionPool::release(std::unique_ptr<Connection> connection,
+                             bool keepAlive) {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  if (keepAlive) {
+    boost::beast::get_lowest_layer(connection->stream()).expires_never();
+    connection->touch();
+    idle_.push_back(std::move(connection));
+  } else {
+    connection->close();
+    --openedCount_;
+  }
+  --usersCount_;
+  connectionReleased_.notify_all();
+}
+
+void ConnectionPool::evictExpired() {
+  auto const now = std::chrono::steady_clock::now();
+  auto const firstAlive =
+      std::find_if(idle_.begin(), idle_.end(), [&](auto const& connection) {
+        return now - connection->lastUsed() < idleTimeout_;
+      });
+  for (auto it = idle_.begin(); it != firstAlive; ++it) {
+    (*it)->retire();
+    --openedCount_;
+    ++stats_.evicted;
+  }
+  idle_.erase(idle_.begin(), firstAlive);
+}
+
+}  // namespace jwlrep
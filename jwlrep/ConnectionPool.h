@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/Outcome.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/fiber/asio/yield.hpp>
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace jwlrep {
+
+class ConnectionPoolOptions;
+class DnsCache;
+class RequestCancellation;
+class RequestTiming;
+class TlsSessionCache;
+
+using SslStream = boost::beast::ssl_stream<boost::beast::tcp_stream>;
+
+/**
+ * Persistent TLS connection. Keeps own read buffer and body buffer which are
+ * reused between requests.
+ */
+class Connection final {
+ public:
+  Connection(boost::asio::io_context& ioContext,
+             boost::asio::ssl::context& sslContext);
+
+  [[nodiscard]] auto stream() -> SslStream&;
+
+  [[nodiscard]] auto buffer() -> boost::beast::flat_buffer&;
+
+  /**
+   * Storage for the chunks of the response body.
+   */
+  [[nodiscard]] auto bodyBuffer() -> std::vector<char>&;
+
+  [[nodiscard]] auto lastUsed() const
+      -> std::chrono::steady_clock::time_point const&;
+
+  void touch();
+
+  /**
+   * Check that peer has not closed the connection while it was idle. TLS
+   * records without application data (e.g. session tickets) received while
+   * idle are consumed.
+   */
+  [[nodiscard]] auto isAlive() -> bool;
+
+  /**
+   * Close the connection after failure. OpenSSL marks its TLS session as not
+   * resumable.
+   */
+  void close();
+
+  /**
+   * Close the healthy connection which is no longer needed. Its TLS session
+   * stays resumable.
+   */
+  void retire();
+
+ private:
+  SslStream stream_;
+
+  boost::beast::flat_buffer buffer_;
+
+  std::vector<char> bodyBuffer_;
+
+  std::chrono::steady_clock::time_point lastUsed_;
+};
+
+/**
+ * Pool of persistent keep-alive connections to the single host. Fibers check
+ * out connection with acquire() and return it back when Lease is destroyed.
+ */
+class ConnectionPool final {
+ public:
+  /**
+   * Connection checked out from the pool. Connection is returned to the pool
+   * on destruction if it was marked as reusable, otherwise it is closed.
+   */
+  class Lease final {
+   public:
+    Lease(ConnectionPool& pool, std::unique_ptr<Connection> connection,
+          bool reused, std::chrono::steady_clock::time_point takenAt);
+
+    Lease(Lease&& other) noexcept;
+    Lease(Lease const&) = delete;
+    auto operator=(Lease&&) -> Lease& = delete;
+    auto operator=(Lease const&) -> Lease& = delete;
+
+    ~Lease();
+
+    [[nodiscard]] auto stream() -> SslStream&;
+
+    [[nodiscard]] auto buffer() -> boost::beast::flat_buffer&;
+
+    [[nodiscard]] auto bodyBuffer() -> std::vector<char>&;
+
+    /**
+     * Whether connection was taken from the idle list instead of being
+     * created.
+     */
+    [[nodiscard]] auto isReused() const -> bool;
+
+    /**
+     * When the pool has stopped waiting: idle connection has been taken or
+     * the new one has started to open. Time spent waiting for the busy
+     * connections is before it.
+     */
+    [[nodiscard]] auto takenAt() const -> std::chrono::steady_clock::time_point;
+
+    /**
+     * Mark connection as reusable. Should be called only after complete
+     * request-response exchange when the server allows keep-alive.
+     */
+    void keepAlive();
+
+   private:
+    ConnectionPool* pool_;
+
+    std::unique_ptr<Connection> connection_;
+
+    bool reused_;
+
+    std::chrono::steady_clock::time_point takenAt_;
+
+    bool keepAlive_{false};
+  };
+
+  struct Stats {
+    std::size_t created{0U};
+
+    std::size_t reused{0U};
+
+    std::size_t evicted{0U};
+  };
+
+  /**
+   * @param tlsSessionCache Cache to resume TLS sessions. Optional.
+   * @param dnsCache Cache which provides actual addresses of the host for
+   * each new connection. Optional. Given endpoints are used without it.
+   */
+  ConnectionPool(boost::asio::io_context& ioContext,
+                 boost::asio::ssl::context& sslContext,
+                 TlsSessionCache* tlsSessionCache, DnsCache* dnsCache,
+                 std::string host,
+                 boost::asio::ip::tcp::resolver::results_type endpoints,
+                 ConnectionPoolOptions const& options);
+
+  ConnectionPool(ConnectionPool const&) = delete;
+  auto operator=(ConnectionPool const&) -> ConnectionPool& = delete;
+
+  /**
+   * Take healthy idle connection or open the new one. Suspends the fiber
+   * while the pool is exhausted. Waiting is not limited by the timeout: it
+   * is the queue of the local requests, not the slow server. It ends once a
+   * connection is released or the request is cancelled.
+   * @param timeout Timeout for lookup, connect and handshake of the new
+   * connection together. It starts once the pool has stopped waiting.
+   * @param timing Receives durations of opening the new connection. Optional.
+   * @param cancellation Aborts waiting for the connection, connect and
+   * handshake. Optional.
+   */
+  auto acquire(std::chrono::nanoseconds timeout,
+               boost::fibers::asio::yield_t& yield,
+               RequestTiming* timing = nullptr,
+               RequestCancellation* cancellation = nullptr) -> Expected<Lease>;
+
+  /**
+   * Wake up the fibers which wait for the connection, so they check their
+   * cancellation. Might be called by any thread.
+   */
+  void wakeUp();
+
+  /**
+   * Gracefully close all idle connections. Waits until the connections which
+   * are in use are returned, e.g. by the cancelled requests which are
+   * finished in the background. Timeout limits closing of all idle
+   * connections together.
+   */
+  void shutdown(std::chrono::nanoseconds timeout,
+                boost::fibers::asio::yield_t& yield);
+
+  [[nodiscard]] auto stats() const -> Stats;
+
+ private:
+  auto connect(std::chrono::nanoseconds timeout,
+               boost::fibers::asio::yield_t& yield, RequestTiming* timing,
+               RequestCancellation* cancellation)
+      -> Expected<std::unique_ptr<Connection>>;
+
+  void release(std::unique_ptr<Connection> connection, bool keepAlive);
+
+  void evictExpired();
+
+  boost::asio::io_context& ioContext_;
+
+  boost::asio::ssl::context& sslContext_;
+
+  TlsSessionCache* const tlsSessionCache_;
+
+  DnsCache* const dnsCache_;
+
+  std::string const host_;
+
+  /**
+   * Key of the TLS session in the cache: "host:port".
+   */
+  std::string const sessionKey_;
+
+  boost::asio::ip::tcp::resolver::results_type const endpoints_;
+
+  std::size_t const maxSize_;
+
+  std::chrono::seconds const idleTimeout_;
+
+  std::chrono::milliseconds const connectAttemptDelay_;
+
+  /**
+   * Address family of the last successful connection. Its addresses are
+   * tried first for the next connections.
+   */
+  std::optional<boost::asio::ip::tcp> preferredProtocol_;
+
+  mutable boost::fibers::mutex mutex_;
+
+  boost::fibers::condition_variable connectionReleased_;
+
+  /**
+   * Most recently used connection is at the back.
+   */
+  std::vector<std::unique_ptr<Connection>> idle_;
+
+  std::size_t openedCount_{0U};
+
+  /**
+   * Fibers which acquire connection or hold the lease.
+   */
+  std::size_t usersCount_{0U};
+
+  Stats stats_;
+};
+
+}  // namespace jwlrep
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/ContentDecoder.h>
+#include <jwlrep/Logger.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+
+// Makes input of the inflate stream const
+#define ZLIB_CONST
+#include <zlib.h>
+
+namespace {
+
+/**
+ * Same size as the network body buffer.
+ */
+auto const kDecodedBufferSize = 64U * 1024U;
+
+/**
+ * Window bits which make zlib to accept both gzip and zlib headers.
+ */
+auto const kAutoDetectWindowBits = MAX_WBITS + 32;
+
+}  // namespace
+
+namespace jwlrep {
+
+void ContentDecoder::StreamDeleter::operator()(z_stream_s* stream) const {
+  inflateEnd(stream);
+  delete stream;  // NOLINT
+}
+
+auto ContentDecoder::create(std::string_view contentEncoding,
+                            ChunkSource const& source)
+    -> Expected<ContentDecoder> {
+  auto const encoding =
+      boost::algorithm::trim_copy(std::string(contentEncoding));
+  if (encoding.empty() || boost::algorithm::iequals(encoding, "identity")) {
+    return ContentDecoder{Encoding::Identity, source};
+  }
+  if (boost::algorithm::iequals(encoding, "gzip") ||
+      boost::algorithm::iequals(encoding, "x-gzip")) {
+    return ContentDecoder{Encoding::Gzip, source};
+  }
+  if (boost::algorithm::iequals(encoding, "deflate")) {
+    return ContentDecoder{Encoding::Deflate, source};
+  }
+  LOG_ERROR("Content encoding '{}' is not supported", encoding);
+  return make_error_code(std::errc::invalid_argument);
+}
+
+ContentDecoder::ContentDecoder(Encoding encoding, ChunkSource const& source)
+    : encoding_(encoding), source_(&source) {
+  if (encoding_ == Encoding::Identity) {
+    return;
+  }
+  stream_.reset(new z_stream_s{});  // NOLINT
+  if (inflateInit2(stream_.get(), kAutoDetectWindowBits) != Z_OK) {
+    LOG_ERROR("Failed to init inflate stream");
+    error_ = make_error_code(std::errc::not_enough_memory);
+    return;
+  }
+  buffer_.resize(kDecodedBufferSize);
+}
+
+auto ContentDecoder::nextChunk() -> std::string_view {
+  if (encoding_ != Encoding::Identity) {
+    return inflateChunk();
+  }
+  auto const chunk = (*source_)();
+  encodedSize_ += chunk.size();
+  decodedSize_ += chunk.size();
+  return chunk;
+}
+
+auto ContentDecoder::error() const -> std::error_code { return error_; }
+
+auto ContentDecoder::isEncoded() const -> bool {
+  return encoding_ != Encoding::Identity;
+}
+
+auto ContentDecoder::encodedSize() const -> std::size_t { return encodedSize_; }
+
+auto ContentDecoder::decodedSize() const -> std::size_t { return decodedSize_; }
+
+auto ContentDecoder::inflateChunk() -> std::string_view {
+  while (!isFinished_ && !error_) {
+    if (stream_->avail_in == 0U) {
+      input_ = (*source_)();
+      if (input_.empty()) {
+        LOG_ERROR("Encoded body is truncated");
+        error_ = make_error_code(std::errc::illegal_byte_sequence);
+        break;
+      }
+      encodedSize_ += input_.size();
+      // NOLINTNEXTLINE
+      stream_->next_in = reinterpret_cast<Bytef const*>(input_.data());
+      stream_->avail_in = static_cast<uInt>(input_.size());
+    }
+
+    // NOLINTNEXTLINE
+    stream_->next_out = reinterpret_cast<Bytef*>(buffer_.data());
+    stream_->avail_out = static_cast<uInt>(buffer_.size());
+    auto const result = inflate(stream_.get(), Z_NO_FLUSH);
+    auto const decodedSize = buffer_.size() - stream_->avail_out;
+
+    if (result == Z_STREAM_END) {
+      // Gzip body might consist of several members
+      if (encoding_ == Encoding::Gzip && stream_->avail_in > 0U) {
+        inflateReset(stream_.get());
+      } else {
+        isFinished_ = true;
+      }
+    } else if (result == Z_DATA_ERROR && restartAsRawDeflate()) {
+      continue;
+    } else if (result != Z_OK && result != Z_BUF_ERROR) {
+      LOG_ERROR("Failed to decode body. Error: {}",
+                stream_->msg != nullptr ? stream_->msg : "unknown");
+      error_ = make_error_code(std::errc::illegal_byte_sequence);
+      break;
+    }
+
+    if (decodedSize > 0U) {
+      decodedSize_ += decodedSize;
+      return {buffer_.data(), decodedSize};
+    }
+  }
+  return {};
+}
+
+auto ContentDecoder::restartAsRawDeflate() -> bool {
+  // Possible only while nothing is decoded and the first chunk is at hand
+  if (encoding_ != Encoding::Deflate || isRawDeflate_ ||
+      stream_->total_out != 0U || encodedSize_ != input_.size()) {
+    return false;
+  }
+  isRawDeflate_ = true;
+  if (inflateReset2(stream_.get(), -MAX_WBITS) != Z_OK) {
+    return false;
+  }
+  // NOLINTNEXTLINE
+  stream_->next_in = reinterpret_cast<Bytef const*>(input_.data());
+  stream_->avail_in = static_cast<uInt>(input_.size());
+  return true;
+}
+
+}  // namespace jwlrep
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/ChunkSource.h>
+#include <jwlrep/Outcome.h>
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+struct z_stream_s;
+
+namespace jwlrep {
+
+/**
+ * Decodes response body according to Content-Encoding while it is being read.
+ * Supports identity, gzip and deflate (zlib wrapped or raw). Only one chunk of
+ * the encoded and one chunk of the decoded body are kept in memory.
+ */
+class ContentDecoder final {
+ public:
+  /**
+   * Fails with invalid_argument if encoding is not supported. Source must
+   * outlive the decoder.
+   */
+  static auto create(std::string_view contentEncoding,
+                     ChunkSource const& source) -> Expected<ContentDecoder>;
+
+  /**
+   * Next chunk of the decoded body. Empty chunk means end of the body or
+   * failure. Chunk is valid until the next call.
+   */
+  auto nextChunk() -> std::string_view;
+
+  /**
+   * Corrupted or truncated encoded body.
+   */
+  [[nodiscard]] auto error() const -> std::error_code;
+
+  [[nodiscard]] auto isEncoded() const -> bool;
+
+  /**
+   * Count of bytes pulled from the source.
+   */
+  [[nodiscard]] auto encodedSize() const -> std::size_t;
+
+  /**
+   * Count of bytes handed out.
+   */
+  [[nodiscard]] auto decodedSize() const -> std::size_t;
+
+ private:
+  enum class Encoding { Identity, Gzip, Deflate };
+
+  struct StreamDeleter {
+    void operator()(z_stream_s* stream) const;
+  };
+
+  ContentDecoder(Encoding encoding, ChunkSource const& source);
+
+  auto inflateChunk() -> std::string_view;
+
+  /**
+   * Some servers send raw deflate instead of zlib wrapped one. Restart
+   * decoding of the first input chunk in raw mode.
+   */
+  auto restartAsRawDeflate() -> bool;
+
+  Encoding encoding_;
+
+  ChunkSource const* source_;
+
+  std::unique_ptr<z_stream_s, StreamDeleter> stream_;
+
+  std::vector<char> buffer_;
+
+  std::string_view input_;
+
+  bool isFinished_{false};
+
+  bool isRawDeflate_{false};
+
+  std::error_code error_;
+
+  std::size_t encodedSize_{0U};
+
+  std::size_t decodedSize_{0U};
+};
+
+}  // namespace jwlrep
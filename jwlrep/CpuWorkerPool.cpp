@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/CpuWorkerPool.h>
+#include <jwlrep/ScopeGuard.h>
+
+#include <algorithm>
+#include <atomic>
+#include <boost/fiber/buffered_channel.hpp>
+#include <string>
+#include <string_view>
+
+namespace {
+
+/**
+ * Capacity of the queue of the body chunks. Channel holds one chunk less,
+ * the capacity has to be a power of two.
+ */
+auto const kQueuedChunksCapacity = std::size_t{8U};
+
+}  // namespace
+
+namespace jwlrep {
+
+CpuWorkerPool::CpuWorkerPool(std::size_t threadsCount) {
+  threads_.reserve(threadsCount);
+  for (std::size_t index = 0U; index < threadsCount; ++index) {
+    threads_.emplace_back([this]() { run(); });
+  }
+}
+
+CpuWorkerPool::~CpuWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    isStopped_ = true;
+  }
+  taskQueued_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+auto CpuWorkerPool::size() const -> std::size_t { return threads_.size(); }
+
+auto CpuWorkerPool::queueDepth() const -> std::size_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_.size();
+}
+
+auto CpuWorkerPool::stats() const -> Stats {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void CpuWorkerPool::post(std::function<void()> function) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(Task{std::move(function), Clock::now()});
+    stats_.maxQueueDepth = std::max(stats_.maxQueueDepth, tasks_.size());
+  }
+  taskQueued_.notify_one();
+}
+
+auto CpuWorkerPool::runBuffered(
+    ChunkSource const& source,
+    std::function<std::error_code(ChunkSource const&)> const& function)
+    -> std::error_code {
+  if (threads_.empty()) {
+    return function(source);
+  }
+
+  // Chunks are copied since they are valid only until the next call of source
+  boost::fibers::buffered_channel<std::string> chunks{kQueuedChunksCapacity};
+  std::atomic<std::size_t> queuedSize{0U};
+  // Task refers to the function and to the queue which are owned by the
+  // calling fiber. It is safe only because the fiber waits for the task.
+  auto result = submit([&function, &chunks, &queuedSize]() {
+    // Function which stops early doesn't leave the fiber on the full queue
+    auto const closeGuard = ScopeGuard{[&chunks]() { chunks.close(); }};
+    std::string chunk;
+    ChunkSource const nextChunk = [&chunks, &queuedSize,
+                                   &chunk]() -> std::string_view {
+      if (chunks.pop(chunk) != boost::fibers::channel_op_status::success) {
+        return {};
+      }
+      queuedSize -= chunk.size();
+      return chunk;
+    };
+    return function(nextChunk);
+  });
+
+  std::size_t maxQueuedSize = 0U;
+  {
+    // Task is waited for even if the source throws
+    auto const waitGuard = ScopeGuard{[&chunks, &result]() {
+      chunks.close();
+      result.wait();
+    }};
+    for (auto chunk = source(); !chunk.empty(); chunk = source()) {
+      maxQueuedSize = std::max(maxQueuedSize, queuedSize += chunk.size());
+      if (chunks.push(std::string{chunk}) !=
+          boost::fibers::channel_op_status::success) {
+        break;
+      }
+    }
+  }
+  recordBufferedSize(maxQueuedSize);
+  return result.get();
+}
+
+void CpuWorkerPool::recordBufferedSize(std::size_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.maxBufferedSize = std::max(stats_.maxBufferedSize, size);
+}
+
+void CpuWorkerPool::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    taskQueued_.wait(lock, [this]() { return isStopped_ || !tasks_.empty(); });
+    if (tasks_.empty()) {
+      return;
+    }
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    lock.unlock();
+
+    auto const startedAt = Clock::now();
+    task.function();
+    auto const finishedAt = Clock::now();
+
+    lock.lock();
+    ++stats_.tasks;
+    stats_.queueTime += startedAt - task.queuedAt;
+    stats_.busyTime += finishedAt - startedAt;
+  }
+}
+
+}  // namespace jwlrep
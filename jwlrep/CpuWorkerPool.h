@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/ChunkSource.h>
+
+#include <boost/fiber/future.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jwlrep {
+
+/**
+ * Threads which run CPU heavy work (decoding, parsing, report generation) off
+ * the network fibers. Fiber which waits for the result is suspended, so the
+ * other fibers of its thread keep on servicing their sockets.
+ */
+class CpuWorkerPool final {
+ public:
+  struct Stats {
+    std::size_t tasks{0U};
+
+    std::size_t maxQueueDepth{0U};
+
+    /**
+     * Sum of the time which tasks have spent in the queue.
+     */
+    std::chrono::nanoseconds queueTime{0};
+
+    /**
+     * Sum of the time which tasks have spent running.
+     */
+    std::chrono::nanoseconds busyTime{0};
+
+    /**
+     * Largest size of the body chunks which have been queued for the task at
+     * once.
+     */
+    std::size_t maxBufferedSize{0U};
+  };
+
+  /**
+   * Without threads tasks are run in place by the calling fiber.
+   */
+  explicit CpuWorkerPool(std::size_t threadsCount);
+
+  CpuWorkerPool(CpuWorkerPool const&) = delete;
+  auto operator=(CpuWorkerPool const&) -> CpuWorkerPool& = delete;
+
+  /**
+   * Run queued tasks and join the threads.
+   */
+  ~CpuWorkerPool();
+
+  /**
+   * Queue function. Result (or exception) is delivered by the fiber future.
+   */
+  template <typename Fn>
+  auto submit(Fn&& function)
+      -> boost::fibers::future<std::invoke_result_t<Fn>>;
+
+  /**
+   * Run function on the worker thread with the chunks of the source which
+   * are read by the calling fiber. Chunks are passed over the bounded queue,
+   * so the function consumes the body while it is being received and only a
+   * few chunks are held in memory. Calling fiber is suspended while the queue
+   * is full. Source is not read further once the function has returned.
+   * Blocks calling fiber until function is finished.
+   */
+  auto runBuffered(
+      ChunkSource const& source,
+      std::function<std::error_code(ChunkSource const&)> const& function)
+      -> std::error_code;
+
+  [[nodiscard]] auto size() const -> std::size_t;
+
+  [[nodiscard]] auto queueDepth() const -> std::size_t;
+
+  [[nodiscard]] auto stats() const -> Stats;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Task {
+    std::function<void()> function;
+
+    Clock::time_point queuedAt;
+  };
+
+  void post(std::function<void()> function);
+
+  void recordBufferedSize(std::size_t size);
+
+  void run();
+
+  mutable std::mutex mutex_;
+
+  std::condition_variable taskQueued_;
+
+  std::deque<Task> tasks_;
+
+  bool isStopped_{false};
+
+  Stats stats_;
+
+  std::vector<std::thread> threads_;
+};
+
+template <typename Fn>
+auto CpuWorkerPool::submit(Fn&& function)
+    -> boost::fibers::future<std::invoke_result_t<Fn>> {
+  using Result = std::invoke_result_t<Fn>;
+  // Packaged task is move only while queue keeps copyable functions
+  auto task = std::make_shared<boost::fibers::packaged_task<Result()>>(
+      std::forward<Fn>(function));
+  auto future = task->get_future();
+  if (threads_.empty()) {
+    (*task)();
+  } else {
+    post([task]() { (*task)(); });
+  }
+  return future;
+}
+
+}  // namespace jwlrep
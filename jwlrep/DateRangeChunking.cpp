@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/DateRangeChunking.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+auto const kDensityWeight = 0.3;
+
+}  // namespace
+
+namespace jwlrep {
+
+ChunkSizeController::ChunkSizeController(
+    DateRangeChunkingOptions const& options)
+    : minDays_(std::max<std::size_t>(1U, options.minDays())),
+      maxDays_(std::max(minDays_, options.maxDays())),
+      targetResponseSize_(static_cast<double>(options.targetResponseSize())),
+      days_(std::clamp(options.initialDays(), minDays_, maxDays_)) {}
+
+auto ChunkSizeController::days() const -> std::size_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return days_;
+}
+
+void ChunkSizeController::onResponse(std::size_t days,
+                                     std::size_t responseSize) {
+  if (days == 0U) {
+    return;
+  }
+  auto const bytesPerDay =
+      static_cast<double>(responseSize) / static_cast<double>(days);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (bytesPerDay_) {
+    *bytesPerDay_ += kDensityWeight * (bytesPerDay - *bytesPerDay_);
+  } else {
+    bytesPerDay_ = bytesPerDay;
+  }
+  if (*bytesPerDay_ < 1.0) {
+    days_ = maxDays_;
+    return;
+  }
+  auto const targetDays = std::round(targetResponseSize_ / *bytesPerDay_);
+  days_ = targetDays >= static_cast<double>(maxDays_)
+              ? maxDays_
+              : std::max(minDays_, static_cast<std::size_t>(targetDays));
+}
+
+DateRangeSplitter::DateRangeSplitter(boost::gregorian::date_period period)
+    : rest_(period) {}
+
+auto DateRangeSplitter::next(std::size_t days)
+    -> std::optional<boost::gregorian::date_period> {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (rest_.is_null()) {
+    return std::nullopt;
+  }
+  auto const end =
+      std::min(rest_.begin() + boost::gregorian::days(static_cast<long>(
+                                   std::max<std::size_t>(1U, days))),
+               rest_.end());
+  boost::gregorian::date_period const range{rest_.begin(), end};
+  rest_ = boost::gregorian::date_period{end, rest_.end()};
+  return range;
+}
+
+}  // namespace jwlrep
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+
+namespace jwlrep {
+
+class DateRangeChunkingOptions;
+
+/**
+ * Picks length of the date sub-ranges so that responses have about the target
+ * size. Density of the data (bytes per day) is learned from the completed
+ * responses of all users. Thread-safe.
+ */
+class ChunkSizeController final {
+ public:
+  explicit ChunkSizeController(DateRangeChunkingOptions const& options);
+
+  /**
+   * Length of the next sub-range in days.
+   */
+  [[nodiscard]] auto days() const -> std::size_t;
+
+  /**
+   * Account size of the response for the sub-range of the given length.
+   */
+  void onResponse(std::size_t days, std::size_t responseSize);
+
+ private:
+  mutable std::mutex mutex_;
+
+  std::size_t const minDays_;
+
+  std::size_t const maxDays_;
+
+  double const targetResponseSize_;
+
+  std::size_t days_;
+
+  /**
+   * Moving average of the response size per day.
+   */
+  std::optional<double> bytesPerDay_;
+};
+
+/**
+ * Hands out consecutive sub-ranges of the period. Thread-safe.
+ */
+class DateRangeSplitter final {
+ public:
+  explicit DateRangeSplitter(boost::gregorian::date_period period);
+
+  /**
+   * Next sub-range of at most the given length. Nothing if the period is
+   * exhausted.
+   */
+  auto next(std::size_t days) -> std::optional<boost::gregorian::date_period>;
+
+ private:
+  std::mutex mutex_;
+
+  boost::gregorian::date_period rest_;
+};
+
+}  // namespace jwlrep
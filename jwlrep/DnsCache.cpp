@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/DnsCache.h>
+#include <jwlrep/GeneralError.h>
+#include <jwlrep/Logger.h>
+#include <jwlrep/NetUtil.h>
+
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+namespace jwlrep {
+
+namespace {
+
+auto makeKey(std::string_view host, std::string_view service) -> std::string {
+  return fmt::format("{} {}", host, service);
+}
+
+/**
+ * Part of TTL after which entry is refreshed in the background.
+ */
+auto refreshAfter(std::chrono::seconds ttl) -> std::chrono::seconds {
+  return ttl * 4 / 5;
+}
+
+}  // namespace
+
+DnsCache::DnsCache(DnsCacheOptions const& options) : ttl_(options.ttl()) {}
+
+auto DnsCache::lookup(boost::asio::io_context& ioContext,
+                      std::string_view host, std::string_view service,
+                      boost::fibers::asio::yield_t& yield)
+    -> Expected<Results> {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  auto& entry = entries_[makeKey(host, service)];
+  resolved_.wait(lock, [&entry]() {
+    return !entry.endpoints.empty() || !entry.isResolving;
+  });
+
+  if (entry.endpoints.empty()) {
+    ++stats_.misses;
+    entry.host = host;
+    entry.service = service;
+    entry.isResolving = true;
+    lock.unlock();
+    return resolve(ioContext, entry, yield);
+  }
+
+  ++stats_.hits;
+  auto const age = Clock::now() - entry.resolvedAt;
+  if (age >= ttl_) {
+    ++stats_.staleHits;
+  }
+  auto results = toResults(entry);
+  if (age >= refreshAfter(ttl_) && !entry.isResolving) {
+    entry.isResolving = true;
+    ++refreshesCount_;
+    boost::fibers::fiber([this, &ioContext, &entry]() {
+      LOG_DEBUG("Refreshing addresses of {}:{}", entry.host, entry.service);
+      auto const resultsOrError =
+          resolve(ioContext, entry, boost::fibers::asio::this_yield());
+      std::unique_lock<boost::fibers::mutex> lock(mutex_);
+      if (resultsOrError) {
+        ++stats_.refreshes;
+      }
+      --refreshesCount_;
+      resolved_.notify_all();
+    }).detach();
+  }
+  return results;
+}
+
+void DnsCache::waitRefreshes() {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  resolved_.wait(lock, [this]() { return refreshesCount_ == 0U; });
+}
+
+auto DnsCache::load(std::filesystem::path const& filePath) -> std::error_code {
+  std::ifstream file(filePath);
+  if (!file) {
+    return GeneralError::SystemError;
+  }
+
+  std::size_t loadedCount = 0U;
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  for (std::string line; std::getline(file, line);) {
+    std::istringstream stream(line);
+    Entry entry;
+    std::int64_t resolvedAt = 0;
+    if (!(stream >> entry.host >> entry.service >> resolvedAt)) {
+      continue;
+    }
+    entry.resolvedAt =
+        Clock::from_time_t(static_cast<std::time_t>(resolvedAt));
+
+    std::string address;
+    unsigned short port = 0U;
+    while (stream >> address >> port) {
+      boost::system::error_code errorCode;
+      auto const ipAddress =
+          boost::asio::ip::make_address(address, errorCode);
+      if (errorCode) {
+        LOG_WARN("Skip malformed address {} of {}", address, entry.host);
+        continue;
+      }
+      entry.endpoints.emplace_back(ipAddress, port);
+    }
+    if (entry.endpoints.empty()) {
+      continue;
+    }
+    // Expired entries are kept as well. They are served until refreshed.
+    auto key = makeKey(entry.host, entry.service);
+    entries_[key] = std::move(entry);
+    ++loadedCount;
+  }
+
+  LOG_DEBUG("Loaded {} DNS entries from {}", loadedCount, filePath.string());
+  return GeneralError::Success;
+}
+
+auto DnsCache::save(std::filesystem::path const& filePath) const
+    -> std::error_code {
+  std::ofstream file(filePath, std::ios::trunc);
+  if (!file) {
+    return GeneralError::SystemError;
+  }
+
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  for (auto const& [key, entry] : entries_) {
+    if (entry.endpoints.empty()) {
+      continue;
+    }
+    file << entry.host << ' ' << entry.service << ' '
+         << static_cast<std::int64_t>(Clock::to_time_t(entry.resolvedAt));
+    for (auto const& endpoint : entry.endpoints) {
+      file << ' ' << endpoint.address().to_string() << ' ' << endpoint.port();
+    }
+    file << '\n';
+  }
+
+  return file ? GeneralError::Success : GeneralError::SystemError;
+}
+
+auto DnsCache::stats() const -> Stats {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  return stats_;
+}
+
+auto DnsCache::resolve(boost::asio::io_context& ioContext, Entry& entry,
+                       boost::fibers::asio::yield_t& yield)
+    -> Expected<Results> {
+  // Host and service are not changed once entry is created
+  auto resultsOrError = dnsLookup(ioContext, entry.host, entry.service, yield);
+
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  entry.isResolving = false;
+  if (resultsOrError) {
+    entry.endpoints.clear();
+    for (auto const& result : resultsOrError.value()) {
+      entry.endpoints.push_back(result.endpoint());
+    }
+    entry.resolvedAt = Clock::now();
+  } else if (!entry.endpoints.empty()) {
+    LOG_WARN("Keep serving previous addresses of {}:{}", entry.host,
+             entry.service);
+  }
+  resolved_.notify_all();
+  return resultsOrError;
+}
+
+auto DnsCache::toResults(Entry const& entry) -> Results {
+  return Results::create(entry.endpoints.begin(), entry.endpoints.end(),
+                         entry.host, entry.service);
+}
+
+}  // namespace jwlrep
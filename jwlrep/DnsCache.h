@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/Outcome.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/fiber/asio/yield.hpp>
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jwlrep {
+
+class DnsCacheOptions;
+
+/**
+ * Cache of the resolved addresses keyed by host and service. System resolver
+ * doesn't report TTL of the records, so the same configured TTL is used for
+ * all entries. Entry is refreshed in the background shortly before it
+ * expires. Last good result is served while refresh is pending or if it has
+ * failed.
+ */
+class DnsCache final {
+ public:
+  using Results = boost::asio::ip::tcp::resolver::results_type;
+
+  using Clock = std::chrono::system_clock;
+
+  struct Stats {
+    std::size_t hits{0U};
+
+    std::size_t misses{0U};
+
+    std::size_t refreshes{0U};
+
+    /**
+     * Hits of the expired entries.
+     */
+    std::size_t staleHits{0U};
+  };
+
+  explicit DnsCache(DnsCacheOptions const& options);
+
+  DnsCache(DnsCache const&) = delete;
+  auto operator=(DnsCache const&) -> DnsCache& = delete;
+
+  /**
+   * Cached addresses if there are any. Otherwise resolve them in the calling
+   * fiber. Concurrent lookups of the same missing entry wait for the single
+   * resolution. Refresh of the entry is started in the new fiber of the
+   * calling thread.
+   */
+  auto lookup(boost::asio::io_context& ioContext, std::string_view host,
+              std::string_view service, boost::fibers::asio::yield_t& yield)
+      -> Expected<Results>;
+
+  /**
+   * Suspend the fiber until all background refreshes are finished. Must be
+   * called before io_context of the refreshing fibers is stopped.
+   */
+  void waitRefreshes();
+
+  /**
+   * Load addresses saved by the previous run. Age of the entries is kept.
+   */
+  auto load(std::filesystem::path const& filePath) -> std::error_code;
+
+  auto save(std::filesystem::path const& filePath) const -> std::error_code;
+
+  [[nodiscard]] auto stats() const -> Stats;
+
+ private:
+  struct Entry {
+    std::string host;
+
+    std::string service;
+
+    std::vector<boost::asio::ip::tcp::endpoint> endpoints;
+
+    Clock::time_point resolvedAt;
+
+    bool isResolving{false};
+  };
+
+  /**
+   * Resolve host and store the result. Failed resolution keeps the previous
+   * result.
+   */
+  auto resolve(boost::asio::io_context& ioContext, Entry& entry,
+               boost::fibers::asio::yield_t& yield) -> Expected<Results>;
+
+  static auto toResults(Entry const& entry) -> Results;
+
+  std::chrono::seconds const ttl_;
+
+  mutable boost::fibers::mutex mutex_;
+
+  /**
+   * Notified when resolution of any entry is finished.
+   */
+  boost::fibers::condition_variable resolved_;
+
+  std::map<std::string, Entry> entries_;
+
+  std::size_t refreshesCount_{0U};
+
+  Stats stats_;
+};
+
+}  // namespace jwlrep
@@ -4,24 +4,146 @@
 
 #include <jwlrep/AppConfig.h>
 #include <jwlrep/Base64.h>
+#include <jwlrep/ContentDecoder.h>
+#include <jwlrep/DateRangeChunking.h>
 #include <jwlrep/Engine.h>
+#include <jwlrep/ErrorCodeUtil.h>
 #include <jwlrep/ExcelReport.h>
+#include <jwlrep/FiberThreadPool.h>
+#include <jwlrep/FiberUtil.h>
+#include <jwlrep/GeneralError.h>
 #include <jwlrep/IEngineEventHandler.h>
+#include <jwlrep/JiraRestApi.h>
 #include <jwlrep/Logger.h>
 #include <jwlrep/NetUtil.h>
 #include <jwlrep/RootCertificates.h>
 #include <jwlrep/ScopeGuard.h>
+#include <jwlrep/SpillBuffer.h>
 #include <jwlrep/Worklog.h>
 
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/post.hpp>
 #include <boost/beast.hpp>
 #include <boost/beast/http.hpp>
-#include <boost/fiber/asio/round_robin.hpp>
 #include <boost/fiber/asio/yield.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <fstream>
+#include <iterator>
 #include <magic_enum.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
+
+namespace {
+
+auto classifyOutcome(
+    jwlrep::Expected<jwlrep::HttpResponse> const& responseOrError)
+    -> jwlrep::RequestOutcome {
+  namespace http = boost::beast::http;
+  if (!responseOrError) {
+    auto const isTimeout =
+        responseOrError.error() == jwlrep::toStd(boost::beast::error::timeout);
+    return isTimeout ? jwlrep::RequestOutcome::Overload
+                     : jwlrep::RequestOutcome::Failure;
+  }
+  switch (responseOrError.value().result()) {
+    case http::status::ok:
+    case http::status::not_modified:
+      return jwlrep::RequestOutcome::Success;
+    case http::status::too_many_requests:
+    case http::status::service_unavailable:
+    case http::status::gateway_timeout:
+      return jwlrep::RequestOutcome::Overload;
+    default:
+      return jwlrep::RequestOutcome::Failure;
+  }
+}
+
+/**
+ * Time the server took to answer: from the start of the connection setup till
+ * the response headers. Body transfer and parsing are excluded since they
+ * depend on the size of the timesheet and on the load of the CPU workers.
+ * Empty if the headers were not received.
+ */
+auto timeToFirstByte(jwlrep::RequestTiming const& timing)
+    -> std::optional<std::chrono::nanoseconds> {
+  using jwlrep::RequestPhase;
+  if (!timing.get(RequestPhase::FirstByte)) {
+    return std::nullopt;
+  }
+  auto result = std::chrono::nanoseconds::zero();
+  for (auto const phase :
+       {RequestPhase::Dns, RequestPhase::Connect, RequestPhase::TlsHandshake,
+        RequestPhase::Write, RequestPhase::FirstByte}) {
+    result += timing.get(phase).value_or(std::chrono::nanoseconds::zero());
+  }
+  return result;
+}
+
+auto describeFailure(
+    jwlrep::Expected<jwlrep::HttpResponse> const& responseOrError)
+    -> std::string {
+  if (!responseOrError) {
+    return responseOrError.error().message();
+  }
+  return fmt::format(
+      "status {}", magic_enum::enum_integer(responseOrError.value().result()));
+}
+
+/**
+ * Count of timesheets buffered between the pipeline stages. Has to be power
+ * of two as required by buffered_channel, which keeps one less.
+ */
+std::size_t const kPipelineCapacity = 4U;
+
+/**
+ * Issues per page of the worklog search. Jira caps it by
+ * jira.search.views.default.max, actual page size is taken from response.
+ */
+std::size_t const kSearchPageSize = 100U;
+
+std::size_t const kWorklogPageSize = 1000U;
+
+/**
+ * Resource of the current user. It is cheap and requires authentication, so
+ * it is requested to open the session.
+ */
+char const* const kAuthSessionTarget = "/rest/auth/1/session";
+
+/**
+ * Password is sent for the basic and session authentication, personal access
+ * token otherwise.
+ */
+void setAuthorization(jwlrep::HttpRequest& request,
+                      jwlrep::Credentials const& credentials) {
+  namespace http = boost::beast::http;
+  if (credentials.authMode() == jwlrep::AuthMode::Token) {
+    request.set(http::field::authorization, "Bearer " + credentials.token());
+    return;
+  }
+  request.set(http::field::authorization,
+              "Basic " + jwlrep::base64Encode(fmt::format(
+                             "{}:{}", credentials.userName(),
+                             credentials.password())));
+}
+
+/**
+ * Share of the limit for the thread. Remainder goes to the first threads, so
+ * the shares sum up to the limit. Count of threads must not exceed the limit.
+ */
+auto perThreadShare(std::size_t limit, std::size_t threadsCount,
+                    std::size_t threadIndex) -> std::size_t {
+  return limit / threadsCount + (threadIndex < limit % threadsCount ? 1U : 0U);
+}
+
+}  // namespace
 
 namespace jwlrep {
 
@@ -30,18 +152,78 @@ Engine::Engine(std::shared_ptr<boost::asio::io_context> ioContext,
                AppConfig const& appConfig)
     : ioContext_(std::move(ioContext)),
       engineEventHandler_(engineEventHandler),
-      appConfig_(appConfig) {
+      appConfig_(appConfig),
+      retryPolicy_(appConfig_.network().retry()) {
   LOG_DEBUG("Engine has been created.");
   assert(ioContext_);
-  boost::fibers::use_scheduling_algorithm<boost::fibers::asio::round_robin>(
-      ioContext_);
+  useAsioFiberScheduler(ioContext_);
 
+  // TLS 1.2 and TLS 1.3 are allowed
   sslContext_ = std::make_unique<boost::asio::ssl::context>(
-      boost::asio::ssl::context::tlsv12_client);
+      boost::asio::ssl::context::tls_client);
+  sslContext_->set_options(boost::asio::ssl::context::default_workarounds |
+                           boost::asio::ssl::context::no_sslv2 |
+                           boost::asio::ssl::context::no_sslv3 |
+                           boost::asio::ssl::context::no_tlsv1 |
+                           boost::asio::ssl::context::no_tlsv1_1);
 
   loadRootCertificates(*sslContext_);
 
   sslContext_->set_verify_mode(boost::asio::ssl::verify_peer);
+
+  cpuWorkerPool_ =
+      std::make_unique<CpuWorkerPool>(appConfig_.options().cpuThreads());
+
+  auto const& tlsSessionCacheOptions = appConfig_.network().tlsSessionCache();
+  if (tlsSessionCacheOptions.enabled()) {
+    tlsSessionCache_ = std::make_unique<TlsSessionCache>(*sslContext_);
+    if (!tlsSessionCacheOptions.filePath().empty()) {
+      auto const errorCode =
+          tlsSessionCache_->load(tlsSessionCacheOptions.filePath());
+      if (errorCode) {
+        LOG_DEBUG("No TLS sessions loaded from {}: {}",
+                  tlsSessionCacheOptions.filePath(), errorCode.message());
+      }
+    }
+  }
+
+  auto const& dnsCacheOptions = appConfig_.network().dnsCache();
+  if (dnsCacheOptions.enabled()) {
+    dnsCache_ = std::make_unique<DnsCache>(dnsCacheOptions);
+    if (!dnsCacheOptions.filePath().empty()) {
+      auto const errorCode = dnsCache_->load(dnsCacheOptions.filePath());
+      if (errorCode) {
+        LOG_DEBUG("No DNS entries loaded from {}: {}",
+                  dnsCacheOptions.filePath(), errorCode.message());
+      }
+    }
+  }
+
+  auto const& responseCacheOptions = appConfig_.network().responseCache();
+  if (responseCacheOptions.enabled()) {
+    auto responseCacheOrError = ResponseCache::create(responseCacheOptions);
+    if (responseCacheOrError) {
+      responseCache_ = std::move(responseCacheOrError.value());
+    } else {
+      LOG_WARN("Response cache is disabled: {}",
+               responseCacheOrError.error().message());
+    }
+  }
+
+  auto const& incrementalSyncOptions = appConfig_.network().incrementalSync();
+  if (incrementalSyncOptions.enabled()) {
+    syncStore_ = std::make_unique<SyncStore>(
+        appConfig_.credentials().serverUrl().host());
+    auto const errorCode = syncStore_->load(incrementalSyncOptions.filePath());
+    if (errorCode) {
+      LOG_DEBUG("No synced timesheets loaded from {}: {}",
+                incrementalSyncOptions.filePath(), errorCode.message());
+    }
+  }
+
+  if (appConfig_.credentials().authMode() != AuthMode::Basic) {
+    authSession_ = std::make_unique<AuthSession>();
+  }
 }
 
 void Engine::start() {
@@ -59,15 +241,49 @@ void Engine::start() {
       boost::asio::post(*ioContext_,
                         [this]() { engineEventHandler_.onEngineStarted(); });
 
-      auto const timeSheetsOrError = loadTimesheets();
+      // Stages are connected by bounded channels. Loading is suspended while
+      // the next stages are behind, so only a few users' data is kept in
+      // memory.
+      boost::fibers::buffered_channel<UserTimeSheet> timeSheets{
+          kPipelineCapacity};
+      boost::fibers::buffered_channel<LabeledTimeSheet> labeledTimeSheets{
+          kPipelineCapacity};
+      ExcelReportWriter reportWriter;
+      std::error_code loadErrorCode;
+      Expected<std::size_t> timeSheetsCountOrError{0U};
+      waitAll(
+          [&]() {
+            try {
+              loadErrorCode = loadTimesheets(timeSheets);
+            } catch (std::exception const& e) {
+              LOG_ERROR("Got exception while loading timesheets: {}",
+                        e.what());
+              loadErrorCode = GeneralError::InternalError;
+            }
+            // Loading might have failed before the last user
+            timeSheets.close();
+            saveTlsSessions();
+            saveDnsCache();
+            saveSyncStore();
+          },
+          [&]() { labelTimesheets(timeSheets, labeledTimeSheets); },
+          [&]() {
+            timeSheetsCountOrError =
+                writeTimesheets(labeledTimeSheets, reportWriter);
+          });
 
-      if (!timeSheetsOrError) {
-        LOG_ERROR("Failed to load timesheets: {}",
-                  timeSheetsOrError.error().message());
+      if (loadErrorCode) {
+        LOG_ERROR("Failed to load timesheets: {}", loadErrorCode.message());
+        return;
+      }
+      if (!timeSheetsCountOrError) {
+        LOG_ERROR("Failed to generate report: {}",
+                  timeSheetsCountOrError.error().message());
         return;
       }
 
-      generateTimesheetsXSLTReport(timeSheetsOrError.value());
+      saveReport(reportWriter, timeSheetsCountOrError.value());
+      logCpuWorkerPoolStats();
 
     } catch (std::exception const& e) {
       LOG_ERROR("Got exception in main fiber: {}", e.what());
@@ -84,28 +300,51 @@ void Engine::stop() {
                     [this]() { engineEventHandler_.onEngineStopped(); });
 }
 
-auto Engine::loadTimesheets() -> Expected<TimeSheets> {
-  namespace http = boost::beast::http;
-  auto& yield = boost::fibers::asio::this_yield();
+/**
+ * State of the single run of loadTimesheets which is shared by the requests
+ * of all threads.
+ */
+struct Engine::LoadState {
+  LoadState(JsonParser parser, BodyBufferOptions const* bufferOptions,
+            boost::gregorian::date_period const& period)
+      : jsonParser(parser),
+        bodyBufferOptions(bufferOptions),
+        reportPeriod(period) {}
 
-  auto makeHttpRequest = [&options = appConfig_.options(),
-                          &credentials =
-                              appConfig_.credentials()](auto const& userName) {
-    auto const requestStr = fmt::format(
-        "/rest/timesheet-gadget/1.0/"
-        "raw-timesheet.json?targetUser={}&startDate={}&endDate={}",
-        userName, boost::gregorian::to_iso_extended_string(options.dateStart()),
-        boost::gregorian::to_iso_extended_string(options.dateEnd()));
-    auto const kHTTPVersion = 10;
-    http::request<http::empty_body> request{http::verb::get, requestStr,
-                                            kHTTPVersion};
-
-    request.set(
-        http::field::authorization,
-        "Basic " + base64Encode(fmt::format("{}:{}", credentials.userName(),
-                                            credentials.password())));
-    return request;
-  };
+  JsonParser const jsonParser;
+
+  BodyBufferOptions const* const bodyBufferOptions;
+
+  boost::gregorian::date_period const reportPeriod;
+
+  std::unique_ptr<ChunkSizeController> chunkSizeController;
+
+  // Body sizes of the successful responses: as received and decoded
+  std::atomic<std::size_t> receivedBodySize{0U};
+  std::atomic<std::size_t> decodedBodySize{0U};
+
+  RequestTimingStats requestTimingStats;
+  std::vector<std::string> userTimingLines;
+  std::mutex userTimingLinesMutex;
+
+  // Responses which are served from the response cache: after revalidation
+  // and without it
+  std::atomic<std::size_t> notModifiedCount{0U};
+  std::atomic<std::size_t> cachedCount{0U};
+
+  // Users whose stored timesheet has been updated rather than loaded anew
+  std::atomic<std::size_t> syncedUsersCount{0U};
+
+  // Timesheets of the group members which are not taken by the users yet
+  std::unordered_map<std::string, UserTimeSheet> batchedTimeSheets;
+  std::mutex batchedTimeSheetsMutex;
+  std::atomic<std::size_t> batchedUsersCount{0U};
+};
+
+auto Engine::loadTimesheets(
+    boost::fibers::buffered_channel<UserTimeSheet>& timeSheets)
+    -> std::error_code {
+  auto& yield = boost::fibers::asio::this_yield();
 
   LOG_INFO(
       "Query timesheets for all users for time period: {} - {}",
@@ -113,9 +352,12 @@ auto Engine::loadTimesheets() -> Expected<TimeSheets> {
           appConfig_.options().dateStart()),
       boost::gregorian::to_iso_extended_string(appConfig_.options().dateEnd()));
 
+  auto const& serverUrl = appConfig_.credentials().serverUrl();
   auto dnsLookupResultsOrError =
-      dnsLookup(*ioContext_, appConfig_.credentials().serverUrl().host(),
-                appConfig_.credentials().serverUrl().scheme(), yield);
+      dnsCache_ ? dnsCache_->lookup(*ioContext_, serverUrl.host(),
+                                    serverUrl.scheme(), yield)
+                : dnsLookup(*ioContext_, serverUrl.host(), serverUrl.scheme(),
+                            yield);
   if (!dnsLookupResultsOrError) {
     LOG_ERROR("Failed to make dns lookup for url {}://{}. Error: {}",
               appConfig_.credentials().serverUrl().scheme(),
@@ -124,64 +366,1192 @@ auto Engine::loadTimesheets() -> Expected<TimeSheets> {
     return dnsLookupResultsOrError.error();
   }
 
-  TimeSheets timeSheets;
-  timeSheets.reserve(appConfig_.options().users().size());
-
-  // It has to be shared ptr otherwise there will be the crash. Due to
-  // cooperative mode outer function will exit (and barrier will be destroyed)
-  // before last sub-fiber will exit
-  auto barrier = std::make_shared<boost::fibers::barrier>(
-      appConfig_.options().users().size() + 1);
-  for (auto const& user : appConfig_.options().users()) {
-    LOG_INFO("Requesting data for the user {}", user);
-    boost::fibers::fiber([barrier, &makeHttpRequest, &dnsLookupResultsOrError,
-                          &user, &yield, &timeSheets, this]() {
-      auto const guard = ScopeGuard{[&]() {
-        LOG_DEBUG("Request fiber has finished");
-        barrier->wait();
-      }};
-      auto request = makeHttpRequest(user);
-
-      auto const responseOrError =
-          httpGet(*ioContext_, *sslContext_, dnsLookupResultsOrError.value(),
-                  request, std::chrono::seconds(10), yield);
-      if (!responseOrError) {
-        LOG_ERROR("Failed to get data for user {}. Error: {}", user,
-                  responseOrError.error().message());
-        return;
+  auto threadsCount = appConfig_.network().threads();
+  if (threadsCount == 0U) {
+    threadsCount = std::max(1U, std::thread::hardware_concurrency());
+  }
+  // Each thread needs at least one connection and one request slot
+  auto const& connectionPoolOptions = appConfig_.network().connectionPool();
+  auto const maxThreadsCount =
+      std::min(connectionPoolOptions.maxSize(),
+               appConfig_.network().maxParallelRequests());
+  if (threadsCount > maxThreadsCount) {
+    LOG_INFO("Use {} thread(s) instead of {} to keep the request limits",
+             maxThreadsCount, threadsCount);
+    threadsCount = maxThreadsCount;
+  }
+  LOG_DEBUG("Use {} thread(s) for requests", threadsCount);
+  FiberThreadPool threadPool{ioContext_, threadsCount};
+
+  // Connections are bound to io_context, so each thread has own pool. Limits
+  // are split between the threads to keep the configured totals.
+  std::vector<std::size_t> maxParallelRequests;
+  std::vector<std::unique_ptr<IoThread>> ioThreads;
+  for (std::size_t index = 0U; index < threadPool.size(); ++index) {
+    maxParallelRequests.push_back(
+        perThreadShare(appConfig_.network().maxParallelRequests(),
+                       threadsCount, index));
+    ConnectionPoolOptions const threadConnectionPoolOptions{
+        perThreadShare(connectionPoolOptions.maxSize(), threadsCount, index),
+        connectionPoolOptions.idleTimeout(),
+        connectionPoolOptions.connectAttemptDelay()};
+    auto ioThread = std::make_unique<IoThread>();
+    ioThread->connectionPool = std::make_unique<ConnectionPool>(
+        threadPool.ioContext(index), *sslContext_, tlsSessionCache_.get(),
+        dnsCache_.get(), appConfig_.credentials().serverUrl().host(),
+        dnsLookupResultsOrError.value(), threadConnectionPoolOptions);
+    ioThreads.push_back(std::move(ioThread));
+  }
+
+  // Shared by all threads, so the budget is not split between them
+  if (appConfig_.network().rateLimit().enabled()) {
+    rateLimiter_ =
+        std::make_unique<RateLimiter>(appConfig_.network().rateLimit());
+  }
+
+  if (appConfig_.network().circuitBreaker().enabled()) {
+    circuitBreaker_ =
+        std::make_unique<CircuitBreaker>(appConfig_.network().circuitBreaker());
+  }
+
+  auto const& adaptiveConcurrencyOptions =
+      appConfig_.network().adaptiveConcurrency();
+  if (adaptiveConcurrencyOptions.enabled()) {
+    concurrencyLimiter_ = std::make_unique<ConcurrencyLimiter>(
+        adaptiveConcurrencyOptions, appConfig_.network().maxParallelRequests());
+  }
+
+  if (appConfig_.network().hedging().enabled()) {
+    hedgingPolicy_ =
+        std::make_unique<HedgingPolicy>(appConfig_.network().hedging());
+  }
+
+  // Requests which wait for their turn see the opened circuit at once and
+  // fail fast instead of being sent to the server which looks down
+  if (circuitBreaker_) {
+    circuitBreaker_->setOpenHandler([this, &ioThreads]() {
+      if (concurrencyLimiter_) {
+        concurrencyLimiter_->wakeUp();
       }
-      if (responseOrError.value().result() != http::status::ok) {
-        LOG_ERROR("Request has failed with result {}",
-                  magic_enum::enum_integer(responseOrError.value().result()));
+      if (rateLimiter_) {
+        rateLimiter_->wakeUp();
+      }
+      for (auto const& ioThread : ioThreads) {
+        ioThread->connectionPool->wakeUp();
+      }
+    });
+  }
+  auto const openHandlerGuard = ScopeGuard{[this]() {
+    if (circuitBreaker_) {
+      circuitBreaker_->setOpenHandler({});
+    }
+  }};
+
+  auto jsonParser = appConfig_.options().jsonParser();
+  if (!isJsonParserAvailable(jsonParser)) {
+    LOG_WARN("simdjson parser is not built in. Fall back to nlohmann parser");
+    jsonParser = JsonParser::Nlohmann;
+  }
+  LoadState state{jsonParser, &appConfig_.network().bodyBuffer(),
+                  boost::gregorian::date_period{
+                      appConfig_.options().dateStart(),
+                      appConfig_.options().dateEnd() +
+                          boost::gregorian::days(1)}};
+  if (appConfig_.network().dateRangeChunking().enabled()) {
+    state.chunkSizeController = std::make_unique<ChunkSizeController>(
+        appConfig_.network().dateRangeChunking());
+  }
+
+  // Timesheets of the group members are requested by a single request per
+  // group and split by the author. Users who are absent in the responses are
+  // requested one by one as usual.
+  auto const& batchFetchOptions = appConfig_.network().batchFetch();
+  auto const isGadgetSource =
+      appConfig_.options().dataSource() == DataSource::TimesheetGadget;
+  if (batchFetchOptions.enabled() && !isGadgetSource) {
+    LOG_WARN("Batched fetch is supported by timesheet gadget only, ignored");
+  }
+  auto const isBatchFetch = batchFetchOptions.enabled() && isGadgetSource &&
+                            !batchFetchOptions.groups().empty();
+  if (isBatchFetch && syncStore_) {
+    LOG_INFO(
+        "Groups are requested for the whole report period, incremental sync "
+        "applies to the users requested one by one");
+  }
+  if (isBatchFetch) {
+    auto const& groups = batchFetchOptions.groups();
+    std::atomic<std::size_t> nextGroup{0U};
+    threadPool.runOnEachThread([&](std::size_t threadIndex) {
+      auto& ioThread = *ioThreads[threadIndex];
+      auto const parallelRequests = maxParallelRequests[threadIndex];
+      runParallel(std::min(parallelRequests, groups.size()), [&]() {
+        for (auto index = nextGroup.fetch_add(1U); index < groups.size();
+             index = nextGroup.fetch_add(1U)) {
+          fetchGroupTimeSheet(ioThread, state, groups[index]);
+        }
+      });
+    });
+  }
+
+  // Timesheet of each user is passed further as soon as it is loaded. Channel
+  // is closed after the last user.
+  auto const& users = appConfig_.options().users();
+  nchannel<UserTimeSheet> timeSheetsProducer{timeSheets, users.size()};
+
+  // Users are taken from the common queue by the workers of all threads, so
+  // thread which is done with its users helps the others. Worker is
+  // suspended while the next stages are behind.
+  std::atomic<std::size_t> nextUser{0U};
+  threadPool.runOnEachThread([&](std::size_t threadIndex) {
+    auto& ioThread = *ioThreads[threadIndex];
+    auto const parallelRequests = maxParallelRequests[threadIndex];
+    runParallel(std::min(parallelRequests, users.size()), [&]() {
+      for (auto index = nextUser.fetch_add(1U); index < users.size();
+           index = nextUser.fetch_add(1U)) {
+        RequestTiming userTiming;
+        std::size_t requestsCount = 0U;
+        auto userTimeSheet = takeBatchedTimeSheet(state, users[index]);
+        if (userTimeSheet) {
+          LOG_INFO("Got data for the user {} from the group", users[index]);
+          if (syncStore_) {
+            // Group is requested for the whole report period
+            auto const today = boost::gregorian::day_clock::local_day();
+            syncStore_->put(users[index],
+                            SyncedTimeSheet{state.reportPeriod, today, today,
+                                            userTimeSheet.value()});
+          }
+        } else {
+          userTimeSheet =
+              syncUserTimeSheet(ioThread, state, users[index],
+                                userTiming, parallelRequests, requestsCount);
+        }
+        {
+          std::lock_guard<std::mutex> lock(state.userTimingLinesMutex);
+          state.userTimingLines.push_back(
+              toJsonLine(users[index], requestsCount, userTiming));
+        }
+        if (userTimeSheet) {
+          timeSheetsProducer.push(std::move(userTimeSheet.value()));
+        } else {
+          timeSheetsProducer.skip();
+        }
+      }
+    });
+  });
+
+  LOG_INFO("All request have been finished.");
+  if (syncStore_) {
+    LOG_INFO("Incremental sync: {} of {} users updated since the last sync",
+             state.syncedUsersCount.load(), users.size());
+  }
+  if (isBatchFetch) {
+    LOG_INFO("Batched fetch: {} of {} users loaded by {} group requests",
+             state.batchedUsersCount.load(), users.size(),
+             batchFetchOptions.groups().size());
+  }
+
+  // Each thread writes only its own entry
+  std::vector<ConnectionPool::Stats> threadPoolStats(threadPool.size());
+  threadPool.runOnEachThread([&](std::size_t threadIndex) {
+    auto& ioThread = *ioThreads[threadIndex];
+    // Losers of the hedged requests still might use the pool
+    ioThread.backgroundAttempts.join();
+    ioThread.connectionPool->shutdown(std::chrono::seconds(10),
+                                      boost::fibers::asio::this_yield());
+    threadPoolStats[threadIndex] = ioThread.connectionPool->stats();
+  });
+  ConnectionPool::Stats poolStats;
+  std::string ioThreadsRequests;
+  for (auto const& stats : threadPoolStats) {
+    poolStats.created += stats.created;
+    poolStats.reused += stats.reused;
+    poolStats.evicted += stats.evicted;
+    if (!ioThreadsRequests.empty()) {
+      ioThreadsRequests += ", ";
+    }
+    ioThreadsRequests += std::to_string(stats.created + stats.reused);
+  }
+  LOG_INFO("Connections: {} created, {} reused, {} evicted", poolStats.created,
+           poolStats.reused, poolStats.evicted);
+  LOG_INFO("IO threads: {} thread(s), requests per thread: {}",
+           threadPool.size(), ioThreadsRequests);
+  if (dnsCache_) {
+    // Refreshing fibers use io_context of the thread pool
+    dnsCache_->waitRefreshes();
+  }
+  if (responseCache_) {
+    responseCache_->evict();
+  }
+  logLoadStats(state);
+  saveTimings(state.userTimingLines, state.requestTimingStats);
+
+  return {};
+}
+
+auto Engine::makeHttpRequest(std::string const& target) const -> HttpRequest {
+  namespace http = boost::beast::http;
+  auto const& credentials = appConfig_.credentials();
+  auto const kHTTPVersion = 11;
+  HttpRequest request{http::verb::get, target, kHTTPVersion};
+  auto const& serverUrl = credentials.serverUrl();
+  request.set(http::field::host,
+              serverUrl.port() ? fmt::format("{}:{}", serverUrl.host(),
+                                             serverUrl.port().value())
+                               : serverUrl.host());
+  request.keep_alive(true);
+  // Timesheet JSON is verbose and compresses well
+  request.set(http::field::accept_encoding, "gzip, deflate");
+
+  // Otherwise the session cookies are set by fetch
+  if (credentials.authMode() == AuthMode::Basic) {
+    setAuthorization(request, credentials);
+  }
+  return request;
+}
+
+auto Engine::loadCachedTimeSheet(LoadState const& state,
+                                 std::string const& target,
+                                 CachedResponse const& cachedResponse,
+                                 RequestTiming& timing)
+    -> std::optional<UserTimeSheet> {
+  auto const parseCachedBody = [&cachedResponse,
+                                &state]() -> Expected<UserTimeSheet> {
+    CachedBodyReader reader{cachedResponse};
+    ChunkSource const source = [&reader]() { return reader.nextChunk(); };
+    auto decoderOrError =
+        ContentDecoder::create(cachedResponse.contentEncoding, source);
+    if (!decoderOrError) {
+      return decoderOrError.error();
+    }
+    auto& decoder = decoderOrError.value();
+    auto userTimeSheetOrError = createUserTimeSheetFromJson(
+        [&decoder]() { return decoder.nextChunk(); }, state.jsonParser,
+        state.bodyBufferOptions);
+    if (decoder.error()) {
+      return decoder.error();
+    }
+    return userTimeSheetOrError;
+  };
+
+  auto const startedAt = RequestTiming::Clock::now();
+  auto userTimeSheetOrError = cpuWorkerPool_->submit(parseCachedBody).get();
+  timing.addSince(RequestPhase::Parse, startedAt);
+  if (!userTimeSheetOrError) {
+    LOG_ERROR("Failed to load cached data for {}. Error: {}", target,
+              userTimeSheetOrError.error().message());
+    return std::nullopt;
+  }
+  return std::move(userTimeSheetOrError.value());
+}
+
+auto Engine::fetchGadgetTimeSheet(IoThread& ioThread, LoadState& state,
+                                  std::string const& target,
+                                  boost::gregorian::date_period const& period,
+                                  RequestTiming& userTiming)
+    -> std::optional<UserTimeSheet> {
+  namespace http = boost::beast::http;
+  auto request = makeHttpRequest(fmt::format(
+      "/rest/timesheet-gadget/1.0/"
+      "raw-timesheet.json?{}&startDate={}&endDate={}",
+      target, boost::gregorian::to_iso_extended_string(period.begin()),
+      boost::gregorian::to_iso_extended_string(period.last())));
+
+  auto const cacheKey = fmt::format(
+      "{} {} {} {}", appConfig_.credentials().serverUrl().host(), target,
+      boost::gregorian::to_iso_extended_string(period.begin()),
+      boost::gregorian::to_iso_extended_string(period.last()));
+  auto const& responseCacheOptions = appConfig_.network().responseCache();
+  // Worklogs of the past are not expected to change, if so configured
+  auto const isTrusted =
+      responseCacheOptions.trustClosedRanges() &&
+      period.last() < boost::gregorian::day_clock::local_day();
+  std::optional<CachedResponse> cachedResponse;
+  if (responseCache_) {
+    cachedResponse = responseCache_->find(cacheKey);
+  }
+  if (cachedResponse && isTrusted) {
+    RequestTiming timing;
+    auto userTimeSheet =
+        loadCachedTimeSheet(state, target, *cachedResponse, timing);
+    state.requestTimingStats.add(timing);
+    userTiming.merge(timing);
+    if (userTimeSheet) {
+      ++state.cachedCount;
+      return userTimeSheet;
+    }
+    cachedResponse.reset();
+  }
+  if (cachedResponse) {
+    if (!cachedResponse->etag.empty()) {
+      request.set(http::field::if_none_match, cachedResponse->etag);
+    }
+    if (!cachedResponse->lastModified.empty()) {
+      request.set(http::field::if_modified_since, cachedResponse->lastModified);
+    }
+  }
+
+  // Timesheet is decoded and parsed while body is being received. Each
+  // attempt parses into own result, only result of the returned response
+  // is kept.
+  struct ParsedBody {
+    std::optional<UserTimeSheet> userTimeSheet;
+    std::pair<std::size_t, std::size_t> bodySize;
+    std::chrono::nanoseconds parseDuration{0};
+  };
+  ParsedBody parsedBody;
+  auto const makeBodyHandler = [&parsedBody, &cacheKey, isTrusted,
+                                jsonParser = state.jsonParser,
+                                bodyBufferOptions = state.bodyBufferOptions,
+                                this]() {
+    auto const attemptBody = std::make_shared<ParsedBody>();
+    auto parseTimeSheet =
+        [attemptBody, cacheKey, isTrusted, jsonParser, bodyBufferOptions,
+         this](HttpResponse const& response,
+               ChunkSource const& nextChunk) -> std::error_code {
+      if (response.result() != http::status::ok) {
+        return {};
+      }
+      auto const contentEncodingField = response[http::field::content_encoding];
+      std::string const contentEncoding{contentEncodingField.data(),
+                                        contentEncodingField.size()};
+      auto const etagField = response[http::field::etag];
+      std::string const etag{etagField.data(), etagField.size()};
+      auto const lastModifiedField = response[http::field::last_modified];
+      std::string const lastModified{lastModifiedField.data(),
+                                     lastModifiedField.size()};
+      // Response without validators can be used only if it is trusted
+      std::unique_ptr<CachedBodyWriter> cacheWriter;
+      if (responseCache_ &&
+          (!etag.empty() || !lastModified.empty() || isTrusted)) {
+        auto cacheWriterOrError = responseCache_->store(
+            cacheKey, contentEncoding, etag, lastModified);
+        if (cacheWriterOrError) {
+          cacheWriter = std::move(cacheWriterOrError.value());
+        }
+      }
+      // Decoding and parsing are done by CPU worker. Fiber only receives the
+      // body, so the other fibers keep on servicing their sockets.
+      return cpuWorkerPool_->runBuffered(
+          nextChunk, [&](ChunkSource const& source) -> std::error_code {
+            auto const startedAt = RequestTiming::Clock::now();
+            auto isBodyEnded = false;
+            ChunkSource const cachingSource = [&source, &isBodyEnded,
+                                               &cacheWriter]() {
+              auto const chunk = source();
+              isBodyEnded = chunk.empty();
+              if (cacheWriter) {
+                cacheWriter->write(chunk);
+              }
+              return chunk;
+            };
+            auto decoderOrError =
+                ContentDecoder::create(contentEncoding, cachingSource);
+            if (!decoderOrError) {
+              return decoderOrError.error();
+            }
+            auto& decoder = decoderOrError.value();
+            auto userTimeSheetOrError = createUserTimeSheetFromJson(
+                [&decoder]() { return decoder.nextChunk(); }, jsonParser,
+                bodyBufferOptions);
+            if (decoder.error()) {
+              return decoder.error();
+            }
+            if (!userTimeSheetOrError) {
+              return userTimeSheetOrError.error();
+            }
+            if (decoder.isEncoded()) {
+              LOG_DEBUG("Decoded body: {} bytes received, {} bytes decoded",
+                        decoder.encodedSize(), decoder.decodedSize());
+            }
+            attemptBody->userTimeSheet =
+                std::move(userTimeSheetOrError.value());
+            attemptBody->bodySize = {decoder.encodedSize(),
+                                     decoder.decodedSize()};
+            attemptBody->parseDuration =
+                RequestTiming::Clock::now() - startedAt;
+            if (cacheWriter) {
+              // Parser might stop before the end of the body
+              while (!isBodyEnded) {
+                cachingSource();
+              }
+              auto const errorCode = cacheWriter->commit();
+              if (errorCode) {
+                LOG_WARN("Failed to cache response: {}", errorCode.message());
+              }
+            }
+            return {};
+          });
+    };
+    auto commit = [attemptBody, &parsedBody]() {
+      parsedBody = std::move(*attemptBody);
+    };
+    return AttemptBodyHandler{std::move(parseTimeSheet), std::move(commit)};
+  };
+
+  RequestTiming timing;
+  auto const responseOrError =
+      fetch(ioThread, request, makeBodyHandler, timing);
+  auto& userTimeSheet = parsedBody.userTimeSheet;
+  auto const& bodySize = parsedBody.bodySize;
+  if (userTimeSheet) {
+    timing.add(RequestPhase::Parse, parsedBody.parseDuration);
+  }
+  if (responseOrError && cachedResponse &&
+      responseOrError.value().result() == http::status::not_modified) {
+    userTimeSheet = loadCachedTimeSheet(state, target, *cachedResponse, timing);
+    if (userTimeSheet) {
+      ++state.notModifiedCount;
+    }
+    state.requestTimingStats.add(timing);
+    userTiming.merge(timing);
+    return userTimeSheet;
+  }
+  state.requestTimingStats.add(timing);
+  userTiming.merge(timing);
+  if (!responseOrError) {
+    LOG_ERROR("Failed to get data for {}. Error: {}", target,
+              responseOrError.error().message());
+    return std::nullopt;
+  }
+  if (responseOrError.value().result() != http::status::ok) {
+    LOG_ERROR("Request has failed with result {}",
+              magic_enum::enum_integer(responseOrError.value().result()));
+    return std::nullopt;
+  }
+  assert(userTimeSheet);
+
+  state.receivedBodySize += bodySize.first;
+  state.decodedBodySize += bodySize.second;
+  if (state.chunkSizeController) {
+    state.chunkSizeController->onResponse(
+        static_cast<std::size_t>(period.length().days()), bodySize.second);
+  }
+  return userTimeSheet;
+}
+
+template <typename ParsePage>
+auto Engine::fetchPage(IoThread& ioThread, LoadState& state,
+                       std::string const& target, RequestTiming& userTiming,
+                       ParsePage const& parsePage)
+    -> std::optional<
+        std::decay_t<decltype(parsePage(std::string_view{}).value())>> {
+  namespace http = boost::beast::http;
+  using Page = std::decay_t<decltype(parsePage(std::string_view{}).value())>;
+  struct ParsedBody {
+    std::optional<Page> page;
+    std::pair<std::size_t, std::size_t> bodySize;
+    std::chrono::nanoseconds parseDuration{0};
+  };
+  ParsedBody parsedBody;
+  auto const makeBodyHandler = [&parsedBody, &parsePage, this]() {
+    auto const attemptBody = std::make_shared<ParsedBody>();
+    // Copy of the parser is kept since cancelled attempt might be finished
+    // in the background
+    auto readPage = [attemptBody, parsePage, this](
+                        HttpResponse const& response,
+                        ChunkSource const& nextChunk) -> std::error_code {
+      if (response.result() != http::status::ok) {
+        return {};
+      }
+      auto const contentEncodingField = response[http::field::content_encoding];
+      std::string const contentEncoding{contentEncodingField.data(),
+                                        contentEncodingField.size()};
+      return cpuWorkerPool_->runBuffered(
+          nextChunk, [&](ChunkSource const& source) -> std::error_code {
+            auto decoderOrError =
+                ContentDecoder::create(contentEncoding, source);
+            if (!decoderOrError) {
+              return decoderOrError.error();
+            }
+            auto& decoder = decoderOrError.value();
+            // Page is parsed as a whole, decoded body over the budget is
+            // spilled to the file
+            auto const& bodyBuffer = appConfig_.network().bodyBuffer();
+            SpillBuffer body{bodyBuffer.memoryBudget(),
+                             bodyBuffer.spillDirectory(), 0U};
+            auto const errorCode =
+                body.append([&decoder]() { return decoder.nextChunk(); });
+            if (decoder.error()) {
+              return decoder.error();
+            }
+            if (errorCode) {
+              return errorCode;
+            }
+            auto const bodyViewOrError = body.view();
+            if (!bodyViewOrError) {
+              return bodyViewOrError.error();
+            }
+            auto const startedAt = RequestTiming::Clock::now();
+            auto pageOrError = parsePage(bodyViewOrError.value());
+            if (!pageOrError) {
+              return pageOrError.error();
+            }
+            attemptBody->page = std::move(pageOrError.value());
+            attemptBody->bodySize = {decoder.encodedSize(),
+                                     decoder.decodedSize()};
+            attemptBody->parseDuration =
+                RequestTiming::Clock::now() - startedAt;
+            return {};
+          });
+    };
+    auto commit = [attemptBody, &parsedBody]() {
+      parsedBody = std::move(*attemptBody);
+    };
+    return AttemptBodyHandler{std::move(readPage), std::move(commit)};
+  };
+
+  RequestTiming timing;
+  auto const responseOrError =
+      fetch(ioThread, makeHttpRequest(target), makeBodyHandler, timing);
+  auto& page = parsedBody.page;
+  auto const& bodySize = parsedBody.bodySize;
+  if (page) {
+    timing.add(RequestPhase::Parse, parsedBody.parseDuration);
+  }
+  state.requestTimingStats.add(timing);
+  userTiming.merge(timing);
+  if (!responseOrError) {
+    LOG_ERROR("Failed to get {}. Error: {}", target,
+              responseOrError.error().message());
+    return std::optional<Page>{};
+  }
+  if (responseOrError.value().result() != http::status::ok) {
+    LOG_ERROR("Request has failed with result {}",
+              magic_enum::enum_integer(responseOrError.value().result()));
+    return std::optional<Page>{};
+  }
+  assert(page);
+
+  state.receivedBodySize += bodySize.first;
+  state.decodedBodySize += bodySize.second;
+  return page;
+}
+
+auto Engine::fetchRestTimeSheet(IoThread& ioThread, LoadState& state,
+                                std::string const& user,
+                                boost::gregorian::date_period const& period,
+                                RequestTiming& userTiming,
+                                std::size_t parallelRequests)
+    -> std::optional<UserTimeSheet> {
+  auto const fetchSearchPage = [&](std::size_t startAt) {
+    return fetchPage(
+        ioThread, state,
+        makeWorklogSearchTarget(user, period, startAt, kSearchPageSize),
+        userTiming, [](std::string_view json) {
+          return parseSearchPage(json);
+        });
+  };
+  auto const fetchWorklogPage = [&](std::string const& issueKey,
+                                    std::size_t startAt) {
+    return fetchPage(
+        ioThread, state,
+        makeIssueWorklogTarget(issueKey, startAt, kWorklogPageSize),
+        userTiming, [user, period](std::string_view json) {
+          return parseWorklogPage(json, user, period);
+        });
+  };
+
+  auto firstSearchPage = fetchSearchPage(0U);
+  if (!firstSearchPage) {
+    return std::nullopt;
+  }
+  std::vector<std::pair<std::size_t, std::vector<IssueRef>>> searchPages;
+  searchPages.emplace_back(0U, std::move(firstSearchPage->items));
+  auto isFailed = false;
+  forEachParallel(
+      nextPageStarts(firstSearchPage->maxResults, firstSearchPage->total),
+      parallelRequests, [&](std::size_t startAt) {
+        if (isFailed) {
+          return;
+        }
+        auto searchPage = fetchSearchPage(startAt);
+        if (!searchPage) {
+          isFailed = true;
+          return;
+        }
+        searchPages.emplace_back(startAt, std::move(searchPage->items));
+      });
+  if (isFailed) {
+    return std::nullopt;
+  }
+  std::sort(
+      searchPages.begin(), searchPages.end(),
+      [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+  std::vector<IssueRef> issues;
+  for (auto& searchPage : searchPages) {
+    std::move(searchPage.second.begin(), searchPage.second.end(),
+              std::back_inserter(issues));
+  }
+
+  // Workers are fibers of the same thread
+  std::unordered_map<std::string, std::vector<Entry>> entriesByKey;
+  forEachParallel(issues, parallelRequests, [&](IssueRef const& issue) {
+    if (isFailed) {
+      return;
+    }
+    auto& entries = entriesByKey[issue.key];
+    std::size_t startAt = 0U;
+    for (;;) {
+      auto worklogPage = fetchWorklogPage(issue.key, startAt);
+      if (!worklogPage) {
+        isFailed = true;
         return;
       }
-      auto userTimeSheetOrError =
-          createUserTimeSheetFromJson(responseOrError.value().body());
-      if (!userTimeSheetOrError) {
-        LOG_ERROR("Failed to parse timesheet for user {}. Error: {}", user,
-                  responseOrError.error().message());
+      std::move(worklogPage->items.begin(), worklogPage->items.end(),
+                std::back_inserter(entries));
+      startAt += worklogPage->maxResults;
+      if (worklogPage->maxResults == 0U || startAt >= worklogPage->total) {
         return;
       }
+    }
+  });
+  if (isFailed) {
+    return std::nullopt;
+  }
+
+  std::vector<Worklog> worklog;
+  for (auto& issue : issues) {
+    auto& entries = entriesByKey[issue.key];
+    if (!entries.empty()) {
+      worklog.emplace_back(std::move(issue.key), std::move(issue.summary),
+                           std::move(entries));
+    }
+  }
+  LOG_DEBUG("Found {} issues with worklog of the user {}", worklog.size(),
+            user);
+  return UserTimeSheet{std::move(worklog)};
+}
+
+auto Engine::fetchTimeSheet(IoThread& ioThread, LoadState& state,
+                            std::string const& user,
+                            boost::gregorian::date_period const& period,
+                            RequestTiming& userTiming,
+                            std::size_t parallelRequests)
+    -> std::optional<UserTimeSheet> {
+  if (appConfig_.options().dataSource() == DataSource::RestApi) {
+    return fetchRestTimeSheet(ioThread, state, user, period, userTiming,
+                              parallelRequests);
+  }
+  return fetchGadgetTimeSheet(ioThread, state,
+                              fmt::format("targetUser={}", user), period,
+                              userTiming);
+}
 
-      timeSheets.emplace_back(std::move(userTimeSheetOrError.value()));
+auto Engine::loadUserTimeSheet(IoThread& ioThread, LoadState& state,
+                               std::string const& user,
+                               boost::gregorian::date_period const& period,
+                               RequestTiming& userTiming,
+                               std::size_t parallelRequests,
+                               std::size_t& requestsCount)
+    -> std::optional<UserTimeSheet> {
+  LOG_INFO("Requesting data for the user {}", user);
 
+  if (!state.chunkSizeController) {
+    ++requestsCount;
+    auto userTimeSheet = fetchTimeSheet(ioThread, state, user, period,
+                                        userTiming, parallelRequests);
+    if (userTimeSheet) {
       LOG_INFO("Got data for the user {}", user);
-    }).detach();
+    }
+    return userTimeSheet;
   }
 
-  barrier->wait();
-  LOG_INFO("All request have been finished.");
-  return timeSheets;
+  // Sub-ranges are taken by the workers one by one, so each of them gets
+  // the length which is actual at the moment. Overall count of requests in
+  // flight is still bounded by the connection pool and the concurrency
+  // limiter. Workers are fibers of the same thread.
+  DateRangeSplitter splitter{period};
+  std::vector<std::pair<boost::gregorian::date, UserTimeSheet>> parts;
+  auto isFailed = false;
+  runParallel(parallelRequests, [&]() {
+    while (!isFailed) {
+      auto const subPeriod = splitter.next(state.chunkSizeController->days());
+      if (!subPeriod) {
+        return;
+      }
+      ++requestsCount;
+      auto userTimeSheet =
+          fetchTimeSheet(ioThread, state, user, subPeriod.value(), userTiming,
+                         parallelRequests);
+      if (!userTimeSheet) {
+        isFailed = true;
+        return;
+      }
+      parts.emplace_back(subPeriod->begin(), std::move(userTimeSheet.value()));
+    }
+  });
+  if (isFailed) {
+    return std::nullopt;
+  }
+
+  std::sort(
+      parts.begin(), parts.end(),
+      [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+  std::vector<UserTimeSheet> userTimeSheets;
+  userTimeSheets.reserve(parts.size());
+  for (auto& part : parts) {
+    userTimeSheets.push_back(std::move(part.second));
+  }
+  LOG_INFO("Got data for the user {} in {} requests", user, parts.size());
+  return mergeUserTimeSheets(std::move(userTimeSheets));
+}
+
+auto Engine::syncUserTimeSheet(IoThread& ioThread, LoadState& state,
+                               std::string const& user,
+                               RequestTiming& userTiming,
+                               std::size_t parallelRequests,
+                               std::size_t& requestsCount)
+    -> std::optional<UserTimeSheet> {
+  if (!syncStore_) {
+    return loadUserTimeSheet(ioThread, state, user, state.reportPeriod,
+                             userTiming, parallelRequests, requestsCount);
+  }
+
+  auto const& incrementalSyncOptions = appConfig_.network().incrementalSync();
+  auto const today = boost::gregorian::day_clock::local_day();
+  auto const syncedTimeSheet = syncStore_->find(user);
+  std::optional<boost::gregorian::date_period> syncPeriod;
+  if (syncedTimeSheet &&
+      !isFullResyncDue(syncedTimeSheet.value(),
+                       incrementalSyncOptions.fullResyncInterval(), today)) {
+    syncPeriod =
+        incrementalSyncPeriod(state.reportPeriod, syncedTimeSheet.value(),
+                              incrementalSyncOptions.overlap());
+  }
+  auto userTimeSheet =
+      loadUserTimeSheet(ioThread, state, user,
+                        syncPeriod.value_or(state.reportPeriod), userTiming,
+                        parallelRequests, requestsCount);
+  if (!userTimeSheet) {
+    return std::nullopt;
+  }
+  if (syncPeriod) {
+    LOG_DEBUG("Synced data for the user {} since {}", user,
+              boost::gregorian::to_iso_extended_string(syncPeriod->begin()));
+    userTimeSheet = mergeSyncedTimeSheet(
+        syncedTimeSheet->timeSheet, state.reportPeriod.begin(),
+        syncPeriod->begin(), std::move(userTimeSheet.value()));
+    ++state.syncedUsersCount;
+  }
+  // Incremental sync keeps the day of the last full one
+  auto const fullySyncedOn =
+      syncPeriod ? syncedTimeSheet->fullySyncedOn : today;
+  syncStore_->put(user, SyncedTimeSheet{state.reportPeriod, today,
+                                        fullySyncedOn, userTimeSheet.value()});
+  return userTimeSheet;
 }
 
-void Engine::generateTimesheetsXSLTReport(TimeSheets const& timeSheets) {
-  LOG_INFO("Generating report");
-  if (timeSheets.empty()) {
+void Engine::fetchGroupTimeSheet(IoThread& ioThread, LoadState& state,
+                                 std::string const& group) {
+  LOG_INFO("Requesting data for the group {}", group);
+  RequestTiming groupTiming;
+  auto groupTimeSheet = fetchGadgetTimeSheet(
+      ioThread, state, fmt::format("targetGroup={}", group),
+      state.reportPeriod, groupTiming);
+  if (!groupTimeSheet) {
+    LOG_WARN("Users of the group {} will be requested one by one", group);
+    return;
+  }
+  auto userTimeSheets = splitUserTimeSheet(groupTimeSheet.value());
+  LOG_INFO("Got data for the group {}: {} users", group,
+           userTimeSheets.size());
+  std::lock_guard<std::mutex> lock(state.batchedTimeSheetsMutex);
+  for (auto& [user, userTimeSheet] : userTimeSheets) {
+    auto const it = state.batchedTimeSheets.find(user);
+    if (it == state.batchedTimeSheets.end()) {
+      state.batchedTimeSheets.emplace(user, std::move(userTimeSheet));
+      continue;
+    }
+    // User is a member of several groups
+    std::vector<UserTimeSheet> parts;
+    parts.push_back(std::move(it->second));
+    parts.push_back(std::move(userTimeSheet));
+    it->second = mergeUserTimeSheets(std::move(parts));
+  }
+}
+
+auto Engine::takeBatchedTimeSheet(LoadState& state, std::string const& user)
+    -> std::optional<UserTimeSheet> {
+  std::lock_guard<std::mutex> lock(state.batchedTimeSheetsMutex);
+  auto const it = state.batchedTimeSheets.find(user);
+  if (it == state.batchedTimeSheets.end()) {
+    return std::nullopt;
+  }
+  auto userTimeSheet = std::move(it->second);
+  state.batchedTimeSheets.erase(it);
+  ++state.batchedUsersCount;
+  return userTimeSheet;
+}
+
+void Engine::logLoadStats(LoadState const& state) const {
+  LOG_INFO("Response bodies: {} bytes received, {} bytes decoded",
+           state.receivedBodySize.load(), state.decodedBodySize.load());
+  if (dnsCache_) {
+    auto const dnsStats = dnsCache_->stats();
+    LOG_INFO("DNS cache: {} hits ({} stale), {} misses, {} refreshed",
+             dnsStats.hits, dnsStats.staleHits, dnsStats.misses,
+             dnsStats.refreshes);
+  }
+  if (circuitBreaker_) {
+    auto const circuitBreakerStats = circuitBreaker_->stats();
+    LOG_INFO(
+        "Circuit breaker: opened {} times, {} requests rejected, {} aborted "
+        "before sending",
+        circuitBreakerStats.trips, circuitBreakerStats.rejected,
+        circuitBreakerStats.aborted);
+  }
+  if (rateLimiter_) {
+    auto const rateLimitStats = rateLimiter_->stats();
+    LOG_INFO(
+        "Rate limit: {} of {} requests delayed, {} ms waited in total, {} "
+        "waits cancelled",
+        rateLimitStats.delayed, rateLimitStats.requests,
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            rateLimitStats.waitTime)
+            .count(),
+        rateLimitStats.cancelled);
+  }
+  if (concurrencyLimiter_) {
+    LOG_INFO("Concurrency limit trajectory: {}",
+             concurrencyLimiter_->trajectoryToString());
+  }
+  if (hedgingPolicy_) {
+    auto const hedgingStats = hedgingPolicy_->stats();
+    LOG_INFO("Hedged requests: {} of {}, {} answered first",
+             hedgingStats.hedges, hedgingStats.requests,
+             hedgingStats.hedgeWins);
+  }
+  if (authSession_) {
+    LOG_INFO("Sessions opened: {}", authSession_->loginsCount());
+  }
+  if (tlsSessionCache_) {
+    auto const tlsStats = tlsSessionCache_->stats();
+    LOG_INFO("TLS handshakes: {} resumed, {} full", tlsStats.resumed,
+             tlsStats.full);
+  }
+  if (responseCache_) {
+    auto const cacheStats = responseCache_->stats();
+    LOG_INFO(
+        "Response cache: {} not modified, {} served without revalidation, {} "
+        "stored, {} evicted",
+        state.notModifiedCount.load(), state.cachedCount.load(),
+        cacheStats.stored, cacheStats.evicted);
+  }
+}
+
+auto Engine::fetch(IoThread& ioThread, HttpRequest const& request,
+                   BodyHandlerFactory const& makeBodyHandler,
+                   RequestTiming& timing) -> Expected<HttpResponse> {
+  if (!authSession_) {
+    return fetchWithRetries(ioThread, request, makeBodyHandler, timing);
+  }
+
+  namespace http = boost::beast::http;
+  auto const login = [&]() {
+    HttpRequest loginRequest{http::verb::get, kAuthSessionTarget,
+                             request.version()};
+    loginRequest.set(http::field::host, request[http::field::host]);
+    loginRequest.keep_alive(true);
+    setAuthorization(loginRequest, appConfig_.credentials());
+    return fetchWithRetries(ioThread, loginRequest, {}, timing);
+  };
+
+  // Rejected session is renewed once per request
+  for (auto isRenewed = false;; isRenewed = true) {
+    auto ticket = authSession_->ticket();
+    if (ticket.cookie.empty()) {
+      auto const errorCode = authSession_->renew(ticket.generation, login);
+      if (errorCode) {
+        return errorCode;
+      }
+      ticket = authSession_->ticket();
+    }
+
+    auto authorizedRequest = request;
+    authorizedRequest.set(http::field::cookie, ticket.cookie);
+    auto responseOrError = fetchWithRetries(ioThread, authorizedRequest,
+                                            makeBodyHandler, timing);
+    if (isRenewed || !responseOrError ||
+        responseOrError.value().result() != http::status::unauthorized) {
+      return responseOrError;
+    }
+
+    LOG_INFO("Session has been rejected, opening the new one");
+    auto const errorCode = authSession_->renew(ticket.generation, login);
+    if (errorCode) {
+      return errorCode;
+    }
+  }
+}
+
+auto Engine::fetchWithRetries(IoThread& ioThread, HttpRequest const& request,
+                              BodyHandlerFactory const& makeBodyHandler,
+                              RequestTiming& timing) -> Expected<HttpResponse> {
+  auto const startedAt = std::chrono::steady_clock::now();
+  auto const fetchAllowed =
+      [&](CircuitBreaker::Permit permit,
+          std::chrono::nanoseconds timeout) -> Expected<HttpResponse> {
+    // Request which is waiting for its turn is not sent once the circuit is
+    // opened
+    std::function<bool()> isCircuitOpened;
+    if (circuitBreaker_) {
+      isCircuitOpened = [this, permit]() {
+        return !circuitBreaker_->isAllowed(permit);
+      };
+    }
+    // Result is reported even if the request throws, otherwise the probe
+    // would be considered in flight forever. Exception counts as failure.
+    auto isFailure = true;
+    auto isAborted = false;
+    auto const guard = ScopeGuard{[&]() {
+      if (!circuitBreaker_) {
+        return;
+      }
+      if (isAborted) {
+        circuitBreaker_->onAborted();
+        return;
+      }
+      circuitBreaker_->onResult(permit, isFailure,
+                                CircuitBreaker::Clock::now());
+    }};
+    auto responseOrError = fetchOnce(ioThread, request, makeBodyHandler,
+                                     timeout, isCircuitOpened, timing);
+    if (!responseOrError &&
+        responseOrError.error() ==
+            toStd(boost::asio::error::operation_aborted) &&
+        isCircuitOpened && isCircuitOpened()) {
+      isAborted = true;
+      return GeneralError::CircuitOpen;
+    }
+    // Failures which are worth repeating are the ones which tell about the
+    // server health
+    isFailure = isRetryable(responseOrError);
+    return responseOrError;
+  };
+
+  for (auto attempt = 0U;; ++attempt) {
+    auto const permit =
+        circuitBreaker_ ? circuitBreaker_->allow(CircuitBreaker::Clock::now())
+                        : CircuitBreaker::Permit::Request;
+    if (permit == CircuitBreaker::Permit::Rejected) {
+      return GeneralError::CircuitOpen;
+    }
+    auto const timeout = retryPolicy_.attemptTimeout(
+        std::chrono::steady_clock::now() - startedAt);
+    auto responseOrError = fetchAllowed(permit, timeout);
+    auto const delay = retryPolicy_.nextDelay(
+        attempt, responseOrError, std::chrono::steady_clock::now() - startedAt);
+    if (!delay) {
+      return responseOrError;
+    }
+    // Not repeated while the server looks down
+    if (circuitBreaker_ &&
+        circuitBreaker_->state() == CircuitBreaker::State::Open) {
+      return responseOrError;
+    }
+
+    LOG_WARN("Attempt {} of {} for {} has failed: {}. Retry in {} ms",
+             attempt + 1U, retryPolicy_.maxAttempts(),
+             std::string_view(request.target().data(), request.target().size()),
+             describeFailure(responseOrError), delay.value().count());
+    boost::this_fiber::sleep_for(delay.value());
+  }
+}
+
+auto Engine::fetchOnce(IoThread& ioThread, HttpRequest const& request,
+                       BodyHandlerFactory const& makeBodyHandler,
+                       std::chrono::nanoseconds timeout,
+                       std::function<bool()> const& isCancelled,
+                       RequestTiming& timing) -> Expected<HttpResponse> {
+  auto& yield = boost::fibers::asio::this_yield();
+  auto const get =
+      [&](RequestTiming& attemptTiming) -> Expected<HttpResponse> {
+    if (hedgingPolicy_) {
+      return hedgedHttpGet(*ioThread.connectionPool,
+                           ioThread.backgroundAttempts, request, timeout,
+                           *hedgingPolicy_, yield, makeBodyHandler,
+                           &attemptTiming, rateLimiter_.get(), isCancelled);
+    }
+    auto const bodyHandler =
+        makeBodyHandler ? makeBodyHandler() : AttemptBodyHandler{};
+    RequestCancellation cancellation;
+    cancellation.cancelIf(isCancelled);
+    auto responseOrError =
+        httpGet(*ioThread.connectionPool, request, timeout, yield,
+                bodyHandler.handleBody, &cancellation, &attemptTiming,
+                rateLimiter_.get());
+    if (responseOrError && bodyHandler.commit) {
+      bodyHandler.commit();
+    }
+    return responseOrError;
+  };
+
+  if (!concurrencyLimiter_) {
+    return get(timing);
+  }
+
+  if (!concurrencyLimiter_->acquire(isCancelled)) {
+    return toStd(boost::asio::error::operation_aborted);
+  }
+  // Slot is returned even if the request throws (e.g. from the body handler).
+  // Requests which got no headers are sampled with the whole elapsed time.
+  auto const startedAt = RequestTiming::Clock::now();
+  RequestTiming attemptTiming;
+  auto outcome = RequestOutcome::Failure;
+  auto const guard = ScopeGuard{[&]() {
+    concurrencyLimiter_->release(timeToFirstByte(attemptTiming)
+                                     .value_or(RequestTiming::Clock::now() -
+                                               startedAt),
+                                 outcome);
+    timing.merge(attemptTiming);
+  }};
+  auto responseOrError = get(attemptTiming);
+  outcome = classifyOutcome(responseOrError);
+  return responseOrError;
+}
+
+void Engine::saveTlsSessions() {
+  if (!tlsSessionCache_) {
+    return;
+  }
+  auto const& filePath = appConfig_.network().tlsSessionCache().filePath();
+  if (filePath.empty()) {
+    return;
+  }
+  auto const errorCode = tlsSessionCache_->save(filePath);
+  if (errorCode) {
+    LOG_WARN("Failed to save TLS sessions to {}: {}", filePath,
+             errorCode.message());
+  }
+}
+
+void Engine::saveSyncStore() {
+  if (!syncStore_) {
+    return;
+  }
+  auto const& filePath = appConfig_.network().incrementalSync().filePath();
+  auto const errorCode = syncStore_->save(filePath);
+  if (errorCode) {
+    LOG_WARN("Failed to save synced timesheets to {}: {}", filePath,
+             errorCode.message());
+  }
+}
+
+void Engine::saveDnsCache() {
+  if (!dnsCache_) {
+    return;
+  }
+  auto const& filePath = appConfig_.network().dnsCache().filePath();
+  if (filePath.empty()) {
+    return;
+  }
+  auto const errorCode = dnsCache_->save(filePath);
+  if (errorCode) {
+    LOG_WARN("Failed to save DNS cache to {}: {}", filePath,
+             errorCode.message());
+  }
+}
+
+void Engine::saveTimings(std::vector<std::string> const& userTimingLines,
+                         RequestTimingStats const& requestTimingStats) {
+  auto const phaseTimingLines = requestTimingStats.toJsonLines();
+  for (auto const& line : phaseTimingLines) {
+    LOG_INFO("Request timing: {}", line);
+  }
+
+  auto const& filePath = appConfig_.network().timingFilePath();
+  if (filePath.empty()) {
+    return;
+  }
+  std::ofstream file(filePath, std::ios::trunc);
+  for (auto const& line : userTimingLines) {
+    file << line << '\n';
+  }
+  for (auto const& line : phaseTimingLines) {
+    file << line << '\n';
+  }
+  if (!file) {
+    LOG_WARN("Failed to save timings to {}", filePath);
+  }
+}
+
+void Engine::labelTimesheets(
+    boost::fibers::buffered_channel<UserTimeSheet>& timeSheets,
+    boost::fibers::buffered_channel<LabeledTimeSheet>& labeledTimeSheets) {
+  auto const guard = ScopeGuard{[&]() { labeledTimeSheets.close(); }};
+  for (UserTimeSheet userTimeSheet;
+       timeSheets.pop(userTimeSheet) ==
+       boost::fibers::channel_op_status::success;) {
+    auto labeledTimeSheet =
+        cpuWorkerPool_
+            ->submit([&userTimeSheet, &options = appConfig_.options()]() {
+              return labelTimeSheet(std::move(userTimeSheet), options);
+            })
+            .get();
+    labeledTimeSheets.push(std::move(labeledTimeSheet));
+  }
+}
+
+auto Engine::writeTimesheets(
+    boost::fibers::buffered_channel<LabeledTimeSheet>& labeledTimeSheets,
+    ExcelReportWriter& reportWriter) -> Expected<std::size_t> {
+  std::size_t timeSheetsCount = 0U;
+  auto isFailed = false;
+  // Channel is drained even after failure, otherwise previous stages would
+  // wait forever
+  for (LabeledTimeSheet labeledTimeSheet;
+       labeledTimeSheets.pop(labeledTimeSheet) ==
+       boost::fibers::channel_op_status::success;) {
+    ++timeSheetsCount;
+    if (isFailed) {
+      continue;
+    }
+    try {
+      cpuWorkerPool_
+          ->submit([&reportWriter, &labeledTimeSheet]() {
+            reportWriter.add(labeledTimeSheet);
+          })
+          .get();
+    } catch (std::exception const& e) {
+      LOG_ERROR("Got exception while adding timesheet to the report: {}",
+                e.what());
+      isFailed = true;
+    }
+    // Worksheet is filled, parsed timesheet is not needed anymore
+    labeledTimeSheet = LabeledTimeSheet{};
+  }
+  if (isFailed) {
+    return GeneralError::InternalError;
+  }
+  return timeSheetsCount;
+}
+
+void Engine::saveReport(ExcelReportWriter& reportWriter,
+                        std::size_t timeSheetsCount) {
+  LOG_INFO("Saving report");
+  if (timeSheetsCount == 0U) {
     LOG_INFO("Timesheets are empty. Skip report generation.");
     return;
   }
-  createReportExcel(timeSheets, appConfig_.options());
-  LOG_INFO("Report has been saved");
+  cpuWorkerPool_->submit([&reportWriter]() { reportWriter.save(); }).get();
+  LOG_INFO("Report with {} worksheet(s) has been saved",
+           reportWriter.worksheetsCount());
+}
+
+void Engine::logCpuWorkerPoolStats() const {
+  if (cpuWorkerPool_->size() == 0U) {
+    return;
+  }
+  auto const stats = cpuWorkerPool_->stats();
+  auto const toMSec = [](std::chrono::nanoseconds duration) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(duration)
+        .count();
+  };
+  LOG_INFO(
+      "CPU workers: {} tasks, max queue depth {}, {} ms in queue, {} ms busy "
+      "on {} thread(s), max queued body chunks {} bytes",
+      stats.tasks, stats.maxQueueDepth, toMSec(stats.queueTime),
+      toMSec(stats.busyTime), cpuWorkerPool_->size(), stats.maxBufferedSize);
 }
 
 }  // namespace jwlrep
\ No newline at end of file
@@ -5,11 +5,33 @@
 #pragma once
 
 #include <jwlrep/AppConfig.h>
+#include <jwlrep/AuthSession.h>
+#include <jwlrep/CircuitBreaker.h>
+#include <jwlrep/ConcurrencyLimiter.h>
+#include <jwlrep/ConnectionPool.h>
+#include <jwlrep/CpuWorkerPool.h>
+#include <jwlrep/DnsCache.h>
+#include <jwlrep/ExcelReport.h>
 #include <jwlrep/IEngineEventHandler.h>
+#include <jwlrep/NetUtil.h>
+#include <jwlrep/RateLimiter.h>
+#include <jwlrep/RequestHedging.h>
+#include <jwlrep/RequestTiming.h>
+#include <jwlrep/ResponseCache.h>
+#include <jwlrep/RetryPolicy.h>
+#include <jwlrep/SyncStore.h>
+#include <jwlrep/TlsSessionCache.h>
 #include <jwlrep/Worklog.h>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/beast/ssl.hpp>
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/fiber/buffered_channel.hpp>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace jwlrep {
 
@@ -37,17 +59,218 @@ class Engine final {
   void stop();
 
  private:
-  auto loadTimesheets() -> Expected<TimeSheets>;
+  /**
+   * Fetch and parse timesheets of all users. Each one is pushed to the
+   * channel as soon as it is loaded, channel is closed after the last user.
+   */
+  auto loadTimesheets(
+      boost::fibers::buffered_channel<UserTimeSheet>& timeSheets)
+      -> std::error_code;
+
+  struct LoadState;
+
+  /**
+   * Requests of the IO thread share its connection pool. Losers of their
+   * hedged requests are joined before the pool is shut down.
+   */
+  struct IoThread {
+    std::unique_ptr<ConnectionPool> connectionPool;
+
+    BackgroundAttempts backgroundAttempts;
+  };
+
+  /**
+   * GET request of the Jira resource with the common headers.
+   */
+  [[nodiscard]] auto makeHttpRequest(std::string const& target) const
+      -> HttpRequest;
+
+  /**
+   * Parse timesheet stored in the response cache by CPU worker.
+   */
+  auto loadCachedTimeSheet(LoadState const& state, std::string const& target,
+                           CachedResponse const& cachedResponse,
+                           RequestTiming& timing)
+      -> std::optional<UserTimeSheet>;
+
+  /**
+   * Timesheet of the user or the group which is given by the query, e.g.
+   * targetUser=name. Response cache is used if enabled.
+   */
+  auto fetchGadgetTimeSheet(IoThread& ioThread, LoadState& state,
+                            std::string const& target,
+                            boost::gregorian::date_period const& period,
+                            RequestTiming& userTiming)
+      -> std::optional<UserTimeSheet>;
+
+  /**
+   * Page of the REST API response. Body is decoded and parsed as a whole by
+   * CPU worker.
+   */
+  template <typename ParsePage>
+  auto fetchPage(IoThread& ioThread, LoadState& state,
+                 std::string const& target, RequestTiming& userTiming,
+                 ParsePage const& parsePage)
+      -> std::optional<
+          std::decay_t<decltype(parsePage(std::string_view{}).value())>>;
+
+  /**
+   * Issues with the worklog of the user are found by JQL search, then
+   * worklog of each issue is requested. Pages of the search and worklog of
+   * the different issues are requested in parallel.
+   */
+  auto fetchRestTimeSheet(IoThread& ioThread, LoadState& state,
+                          std::string const& user,
+                          boost::gregorian::date_period const& period,
+                          RequestTiming& userTiming,
+                          std::size_t parallelRequests)
+      -> std::optional<UserTimeSheet>;
+
+  /**
+   * Timesheet of the user from the configured data source.
+   */
+  auto fetchTimeSheet(IoThread& ioThread, LoadState& state,
+                      std::string const& user,
+                      boost::gregorian::date_period const& period,
+                      RequestTiming& userTiming, std::size_t parallelRequests)
+      -> std::optional<UserTimeSheet>;
+
+  /**
+   * Timesheet of the user for the period. Period is split into sub-ranges if
+   * date range chunking is enabled. Parallel requests is the share of the
+   * thread which runs the worker.
+   */
+  auto loadUserTimeSheet(IoThread& ioThread, LoadState& state,
+                         std::string const& user,
+                         boost::gregorian::date_period const& period,
+                         RequestTiming& userTiming,
+                         std::size_t parallelRequests,
+                         std::size_t& requestsCount)
+      -> std::optional<UserTimeSheet>;
 
-  void generateTimesheetsXSLTReport(TimeSheets const& timeSheets);
+  /**
+   * Timesheet of the user for the report period. With incremental sync only
+   * the days since the last sync are requested. Entries of the earlier days
+   * are taken from the store.
+   */
+  auto syncUserTimeSheet(IoThread& ioThread, LoadState& state,
+                         std::string const& user, RequestTiming& userTiming,
+                         std::size_t parallelRequests,
+                         std::size_t& requestsCount)
+      -> std::optional<UserTimeSheet>;
+
+  /**
+   * Request timesheet of the group and keep timesheets of its members for
+   * takeBatchedTimeSheet. Failure is logged only, members are requested one
+   * by one then.
+   */
+  void fetchGroupTimeSheet(IoThread& ioThread, LoadState& state,
+                           std::string const& group);
+
+  /**
+   * Batched timesheet of the user, if any. Each of them is taken once.
+   */
+  auto takeBatchedTimeSheet(LoadState& state, std::string const& user)
+      -> std::optional<UserTimeSheet>;
+
+  void logLoadStats(LoadState const& state) const;
+
+  /**
+   * Calculate labels of the timesheets until input channel is closed. Closes
+   * output channel when done.
+   */
+  void labelTimesheets(
+      boost::fibers::buffered_channel<UserTimeSheet>& timeSheets,
+      boost::fibers::buffered_channel<LabeledTimeSheet>& labeledTimeSheets);
+
+  /**
+   * Add timesheets to the report until channel is closed. Returns count of
+   * received timesheets.
+   */
+  auto writeTimesheets(
+      boost::fibers::buffered_channel<LabeledTimeSheet>& labeledTimeSheets,
+      ExcelReportWriter& reportWriter) -> Expected<std::size_t>;
+
+  /**
+   * Make request to Jira using connection pool of the calling thread. With
+   * session authentication the request carries the session cookies. Session
+   * is opened by the first request and renewed once it is rejected. Each
+   * attempt handles the body by own handler, only handler of the returned
+   * response is committed.
+   */
+  auto fetch(IoThread& ioThread, HttpRequest const& request,
+             BodyHandlerFactory const& makeBodyHandler, RequestTiming& timing)
+      -> Expected<HttpResponse>;
+
+  /**
+   * Failed request is repeated according to the retry policy. Durations of
+   * the phases of all attempts are added to the timing. Request fails at
+   * once while the circuit is open, the one which is still waiting for its
+   * turn fails once the circuit is opened.
+   */
+  auto fetchWithRetries(IoThread& ioThread, HttpRequest const& request,
+                        BodyHandlerFactory const& makeBodyHandler,
+                        RequestTiming& timing) -> Expected<HttpResponse>;
+
+  /**
+   * Make single attempt under the rate limit and the adaptive concurrency
+   * limit (if enabled). Slow attempt is hedged (if enabled). Condition (if
+   * given) cancels the attempt which is still waiting for its turn or for the
+   * connection, it is checked again right before the request is sent.
+   */
+  auto fetchOnce(IoThread& ioThread, HttpRequest const& request,
+                 BodyHandlerFactory const& makeBodyHandler,
+                 std::chrono::nanoseconds timeout,
+                 std::function<bool()> const& isCancelled,
+                 RequestTiming& timing) -> Expected<HttpResponse>;
+
+  void saveReport(ExcelReportWriter& reportWriter,
+                  std::size_t timeSheetsCount);
+
+  void saveTlsSessions();
+
+  void saveDnsCache();
+
+  void saveSyncStore();
+
+  /**
+   * Write timings of the users and distributions of the phase durations to
+   * the timing file (if configured). Distributions are logged as well.
+   */
+  void saveTimings(std::vector<std::string> const& userTimingLines,
+                   RequestTimingStats const& requestTimingStats);
+
+  void logCpuWorkerPoolStats() const;
 
   std::shared_ptr<boost::asio::io_context> ioContext_;
 
   std::unique_ptr<boost::asio::ssl::context> sslContext_;
 
+  std::unique_ptr<TlsSessionCache> tlsSessionCache_;
+
+  std::unique_ptr<DnsCache> dnsCache_;
+
+  std::unique_ptr<ResponseCache> responseCache_;
+
+  std::unique_ptr<SyncStore> syncStore_;
+
+  std::unique_ptr<AuthSession> authSession_;
+
+  std::unique_ptr<CpuWorkerPool> cpuWorkerPool_;
+
+  std::unique_ptr<RateLimiter> rateLimiter_;
+
+  std::unique_ptr<CircuitBreaker> circuitBreaker_;
+
+  std::unique_ptr<ConcurrencyLimiter> concurrencyLimiter_;
+
+  std::unique_ptr<HedgingPolicy> hedgingPolicy_;
+
   IEngineEventHandler& engineEventHandler_;
 
   AppConfig const& appConfig_;
+
+  RetryPolicy retryPolicy_;
 };
 
 }  // namespace jwlrep
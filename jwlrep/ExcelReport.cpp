@@ -8,6 +8,7 @@
 #include <jwlrep/Worklog.h>
 
 #include <boost/algorithm/string.hpp>
+#include <cassert>
 #include <xlnt/xlnt.hpp>
 
 namespace {
@@ -84,9 +85,11 @@ void addWorklogSummaryToWorksheet(xlnt::worksheet &worksheet,
 
 void addWorklogToWorksheet(xlnt::worksheet &worksheet,
                            std::vector<jwlrep::Worklog> const &worklog,
-                           jwlrep::Options const &options) {
+                           std::vector<std::string> const &labels) {
   std::uint32_t rowIndex = kHeaderRow + 1U;
-  for (auto const &issue : worklog) {
+  for (std::size_t issueIndex = 0U; issueIndex < worklog.size();
+       ++issueIndex) {
+    auto const &issue = worklog[issueIndex];
     for (auto const &entry : issue.entries()) {
       worksheet.cell(xlnt::cell_reference(kColumnIndexKey, rowIndex))
           .value(issue.key());
@@ -100,7 +103,7 @@ void addWorklogToWorksheet(xlnt::worksheet &worksheet,
       worksheet.cell(xlnt::cell_reference(kColumnIndexSpent, rowIndex))
           .value(entry.timeSpent().count() / kMSecsPerHour);
       worksheet.cell(xlnt::cell_reference(kColumnIndexLabel, rowIndex))
-          .value(calculateLabel(issue.summary(), options));
+          .value(labels[issueIndex]);
       worksheet.cell(xlnt::cell_reference(kColumnIndexProject, rowIndex))
           .formula(fmt::format("=IF(F{0}=\"SOP\",E{0},0)", rowIndex));
       worksheet.cell(xlnt::cell_reference(kColumnIndexCommon, rowIndex))
@@ -113,35 +116,68 @@ void addWorklogToWorksheet(xlnt::worksheet &worksheet,
   addWorklogSummaryToWorksheet(worksheet, worklog, rowIndex);
 }
 
-void addTimeSheetsToReport(xlnt::workbook &workbook,
-                           jwlrep::TimeSheets const &timeSheets,
-                           jwlrep::Options const &options) {
-  for (auto const &userTimeSheetRef : timeSheets) {
-    if (userTimeSheetRef.worklog().empty() ||
-        userTimeSheetRef.worklog()[0].entries().empty()) {
-      LOG_INFO("No data to save to the report");
-      continue;
-    }
+}  // namespace
+
+namespace jwlrep {
 
-    auto worksheet = workbook.create_sheet();
-    worksheet.title(userTimeSheetRef.worklog()[0].entries()[0].author());
+LabeledTimeSheet::LabeledTimeSheet(UserTimeSheet &&userTimeSheet,
+                                   std::vector<std::string> &&labels)
+    : userTimeSheet_(std::move(userTimeSheet)), labels_(std::move(labels)) {
+  assert(labels_.size() == userTimeSheet_.worklog().size());
+}
 
-    addHeadingToReport(worksheet);
-    addWorklogToWorksheet(worksheet, userTimeSheetRef.worklog(), options);
+auto LabeledTimeSheet::userTimeSheet() const -> UserTimeSheet const & {
+  return userTimeSheet_;
+}
+
+auto LabeledTimeSheet::labels() const -> std::vector<std::string> const & {
+  return labels_;
+}
+
+auto labelTimeSheet(UserTimeSheet &&userTimeSheet, Options const &options)
+    -> LabeledTimeSheet {
+  std::vector<std::string> labels;
+  labels.reserve(userTimeSheet.worklog().size());
+  for (auto const &issue : userTimeSheet.worklog()) {
+    labels.push_back(calculateLabel(issue.summary(), options));
   }
+  return LabeledTimeSheet{std::move(userTimeSheet), std::move(labels)};
 }
 
-}  // namespace
+ExcelReportWriter::ExcelReportWriter()
+    : workbook_(std::make_unique<xlnt::workbook>()) {
+  workbook_->active_sheet().title("Summary");
+}
 
-namespace jwlrep {
+ExcelReportWriter::~ExcelReportWriter() = default;
 
-void createReportExcel(TimeSheets const &timeSheets, Options const &options) {
-  xlnt::workbook workbook;
-  workbook.active_sheet().title("Summary");
+void ExcelReportWriter::add(LabeledTimeSheet const &labeledTimeSheet) {
+  auto const &worklog = labeledTimeSheet.userTimeSheet().worklog();
+  if (worklog.empty() || worklog[0].entries().empty()) {
+    LOG_INFO("No data to save to the report");
+    return;
+  }
+
+  auto worksheet = workbook_->create_sheet();
+  worksheet.title(worklog[0].entries()[0].author());
+
+  addHeadingToReport(worksheet);
+  addWorklogToWorksheet(worksheet, worklog, labeledTimeSheet.labels());
+  ++worksheetsCount_;
+}
+
+auto ExcelReportWriter::worksheetsCount() const -> std::size_t {
+  return worksheetsCount_;
+}
 
-  addTimeSheetsToReport(workbook, timeSheets, options);
+void ExcelReportWriter::save() { workbook_->save("report.xlsx"); }
 
-  workbook.save("report.xlsx");
+void createReportExcel(TimeSheets const &timeSheets, Options const &options) {
+  ExcelReportWriter reportWriter;
+  for (auto userTimeSheet : timeSheets) {
+    reportWriter.add(labelTimeSheet(std::move(userTimeSheet), options));
+  }
+  reportWriter.save();
 }
 
 auto calculateLabel(std::string const &summary, Options const &options)
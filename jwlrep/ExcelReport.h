@@ -6,10 +6,79 @@
 
 #include <jwlrep/Worklog.h>
 
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xlnt {
+class workbook;
+}  // namespace xlnt
+
 namespace jwlrep {
 
 class Options;
 
+/**
+ * Timesheet of the user with the labels of its worklog issues.
+ */
+class LabeledTimeSheet {
+ public:
+  /**
+   * Empty timesheet. Required to pass it over the channel.
+   */
+  LabeledTimeSheet() = default;
+
+  LabeledTimeSheet(UserTimeSheet&& userTimeSheet,
+                   std::vector<std::string>&& labels);
+
+  [[nodiscard]] auto userTimeSheet() const -> UserTimeSheet const&;
+
+  /**
+   * Label of each issue of the worklog in the same order.
+   */
+  [[nodiscard]] auto labels() const -> std::vector<std::string> const&;
+
+ private:
+  UserTimeSheet userTimeSheet_;
+
+  std::vector<std::string> labels_;
+};
+
+auto labelTimeSheet(UserTimeSheet&& userTimeSheet, Options const& options)
+    -> LabeledTimeSheet;
+
+/**
+ * Report which is filled one user at a time, so timesheet might be released
+ * as soon as it is added.
+ */
+class ExcelReportWriter final {
+ public:
+  ExcelReportWriter();
+
+  ~ExcelReportWriter();
+
+  ExcelReportWriter(ExcelReportWriter const&) = delete;
+  auto operator=(ExcelReportWriter const&) -> ExcelReportWriter& = delete;
+
+  /**
+   * Add worksheet of the user. User without worklog entries is skipped.
+   */
+  void add(LabeledTimeSheet const& labeledTimeSheet);
+
+  [[nodiscard]] auto worksheetsCount() const -> std::size_t;
+
+  /**
+   * Save report to report.xlsx.
+   */
+  void save();
+
+ private:
+  std::unique_ptr<xlnt::workbook> workbook_;
+
+  std::size_t worksheetsCount_{0U};
+};
+
 void createReportExcel(TimeSheets const& timeSheets, Options const& options);
 
 auto calculateLabel(std::string const& summary, jwlrep::Options const& options)
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/FiberThreadPool.h>
+#include <jwlrep/Logger.h>
+
+#include <boost/asio/post.hpp>
+#include <boost/fiber/all.hpp>
+#include <boost/fiber/asio/round_robin.hpp>
+#include <cassert>
+
+namespace jwlrep {
+
+void useAsioFiberScheduler(
+    std::shared_ptr<boost::asio::io_context> const& ioContext) {
+  boost::fibers::use_scheduling_algorithm<boost::fibers::asio::round_robin>(
+      ioContext);
+}
+
+FiberThreadPool::FiberThreadPool(
+    std::shared_ptr<boost::asio::io_context> ioContext,
+    std::size_t threadsCount) {
+  assert(ioContext);
+  assert(threadsCount > 0U);
+  ioContexts_.push_back(std::move(ioContext));
+  for (std::size_t index = 1U; index < threadsCount; ++index) {
+    auto threadIoContext = std::make_shared<boost::asio::io_context>();
+    ioContexts_.push_back(threadIoContext);
+    threads_.emplace_back([threadIoContext, index]() {
+      LOG_DEBUG("Started worker thread {}", index);
+      useAsioFiberScheduler(threadIoContext);
+      threadIoContext->run();
+      LOG_DEBUG("Finished worker thread {}", index);
+    });
+  }
+}
+
+FiberThreadPool::~FiberThreadPool() {
+  for (std::size_t index = 1U; index < ioContexts_.size(); ++index) {
+    ioContexts_[index]->stop();
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+auto FiberThreadPool::size() const -> std::size_t {
+  return ioContexts_.size();
+}
+
+auto FiberThreadPool::ioContext(std::size_t threadIndex) const
+    -> boost::asio::io_context& {
+  return *ioContexts_.at(threadIndex);
+}
+
+void FiberThreadPool::runOnEachThread(
+    std::function<void(std::size_t)> const& function) {
+  // Barrier is shared for the same reason as in forEachParallel. Fiber
+  // barrier may be waited by the fibers of different threads.
+  auto barrier = std::make_shared<boost::fibers::barrier>(size() + 1U);
+  for (std::size_t index = 0U; index < size(); ++index) {
+    auto launch = [&function, barrier, index]() {
+      boost::fibers::fiber([&function, barrier, index]() {
+        function(index);
+        barrier->wait();
+      }).detach();
+    };
+    if (index == 0U) {
+      launch();
+    } else {
+      // Fiber has to be created by the thread which runs it
+      boost::asio::post(*ioContexts_[index], launch);
+    }
+  }
+  barrier->wait();
+}
+
+}  // namespace jwlrep
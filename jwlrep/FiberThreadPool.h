@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace jwlrep {
+
+/**
+ * Install fiber scheduler which runs fibers of the calling thread together
+ * with the handlers of the io_context.
+ */
+void useAsioFiberScheduler(
+    std::shared_ptr<boost::asio::io_context> const& ioContext);
+
+/**
+ * Set of threads each running own io_context with fiber scheduler installed.
+ * Calling thread is the first one in the set: it has to run its io_context
+ * with the scheduler installed by useAsioFiberScheduler.
+ *
+ * Fibers are never moved between threads: asio objects are bound to their
+ * io_context and are not thread safe. Work is shared between the threads by
+ * the functions themselves, e.g. by taking items from the common queue.
+ */
+class FiberThreadPool final {
+ public:
+  FiberThreadPool(std::shared_ptr<boost::asio::io_context> ioContext,
+                  std::size_t threadsCount);
+
+  FiberThreadPool(FiberThreadPool const&) = delete;
+  auto operator=(FiberThreadPool const&) -> FiberThreadPool& = delete;
+
+  /**
+   * Stop io_contexts of the started threads and join them.
+   */
+  ~FiberThreadPool();
+
+  [[nodiscard]] auto size() const -> std::size_t;
+
+  /**
+   * Io context of the thread. Index 0 is the calling thread.
+   */
+  [[nodiscard]] auto ioContext(std::size_t threadIndex) const
+      -> boost::asio::io_context&;
+
+  /**
+   * Call function in the fiber on each thread with the index of the thread.
+   * Blocks calling fiber until all of them are finished.
+   */
+  void runOnEachThread(std::function<void(std::size_t)> const& function);
+
+ private:
+  std::vector<std::shared_ptr<boost::asio::io_context>> ioContexts_;
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace jwlrep
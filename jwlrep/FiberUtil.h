@@ -4,59 +4,137 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <boost/fiber/all.hpp>
 #include <cassert>
+#include <iterator>
+#include <memory>
 
 namespace jwlrep {
 
 namespace detail {
 
+inline void waitAllImpl(
+    std::shared_ptr<boost::fibers::barrier> const& /*barrier*/) {}
+
 template <typename Fn, typename... Fns>
-void waitAllImpl(boost::fibers::barrier& barrier, Fn&& function,
-                 Fns&&... functions) {
-  boost::fibers::fiber(std::bind(
-                           [](boost::fibers::barrier& barrier,
-                              typename std::decay<Fn>::type& function) mutable {
-                             function();
-                             barrier.wait();
-                           },
-                           barrier, std::forward<Fn>(function)))
-      .detach();
+void waitAllImpl(std::shared_ptr<boost::fibers::barrier> const& barrier,
+                 Fn&& function, Fns&&... functions) {
+  boost::fibers::fiber([&function, barrier]() {
+    function();
+    barrier->wait();
+  }).detach();
   waitAllImpl(barrier, std::forward<Fns>(functions)...);
 }
 
 }  // namespace detail
 
+/**
+ * Call each function in its own fiber. Blocks calling fiber until all of them
+ * are finished.
+ */
 template <typename... Fns>
 void waitAll(Fns&&... functions) {
   std::size_t const count(sizeof...(functions));
-  boost::fibers::barrier barrier{count + 1};
-  waitAllImpl(&barrier, std::forward<Fns>(functions)...);
-  barrier.wait();
+  // Barrier is shared for the same reason as in forEachParallel
+  auto barrier = std::make_shared<boost::fibers::barrier>(count + 1U);
+  detail::waitAllImpl(barrier, std::forward<Fns>(functions)...);
+  barrier->wait();
+}
+
+/**
+ * Call function in concurrency fibers. Blocks calling fiber until all of them
+ * are finished.
+ */
+template <typename Fn>
+void runParallel(std::size_t concurrency, Fn&& function) {
+  if (concurrency == 0U) {
+    return;
+  }
+  // Barrier is shared for the same reason as in forEachParallel
+  auto barrier = std::make_shared<boost::fibers::barrier>(concurrency + 1U);
+  for (std::size_t worker = 0U; worker < concurrency; ++worker) {
+    boost::fibers::fiber([&function, barrier]() {
+      function();
+      barrier->wait();
+    }).detach();
+  }
+  barrier->wait();
+}
+
+/**
+ * Call function for each item. Items are processed by at most concurrency
+ * fibers which take the next item as soon as they are done with the previous
+ * one. Blocks calling fiber until all items are processed.
+ */
+template <typename Items, typename Fn>
+void forEachParallel(Items const& items, std::size_t concurrency,
+                     Fn&& function) {
+  auto const itemsCount = std::size(items);
+  auto const workersCount = std::min(concurrency, itemsCount);
+  if (workersCount == 0U) {
+    return;
+  }
+
+  // It has to be shared ptr otherwise there will be the crash. Due to
+  // cooperative mode outer function will exit (and barrier will be destroyed)
+  // before last sub-fiber will exit
+  auto nextIndex = std::make_shared<std::atomic<std::size_t>>(0U);
+  auto barrier = std::make_shared<boost::fibers::barrier>(workersCount + 1U);
+  for (std::size_t worker = 0U; worker < workersCount; ++worker) {
+    boost::fibers::fiber([&items, &function, itemsCount, nextIndex, barrier]() {
+      for (auto index = nextIndex->fetch_add(1U); index < itemsCount;
+           index = nextIndex->fetch_add(1U)) {
+        function(*std::next(std::begin(items), index));
+      }
+      barrier->wait();
+    }).detach();
+  }
+  barrier->wait();
 }
 
+/**
+ * Producer side of the channel which expects known count of values. Channel
+ * is closed as soon as all of them are pushed or skipped, so consumer knows
+ * that there is nothing more to wait. Might be shared by the fibers of
+ * different threads.
+ */
 template <typename T>
 class nchannel {
  public:
   nchannel(boost::fibers::buffered_channel<T>& channel, std::size_t limit)
-      : channel_(channel), limit_(limit) {
+      : channel_(&channel), limit_(limit) {
     assert(channel_);
-    if (limit_ == 0) {
-      channel_.close();
+    if (limit == 0U) {
+      channel_->close();
     }
   }
 
+  /**
+   * Suspend the fiber while channel is full.
+   */
   auto push(T&& value) -> boost::fibers::channel_op_status {
-    auto const ok = channel_->push(std::forward<T>(value));
-    if (ok == boost::fibers::channel_op_status::success && --limit_ == 0) {
-      channel_.close();
-    }
-    return ok;
+    auto const status = channel_->push(std::move(value));
+    countDown();
+    return status;
   }
 
+  /**
+   * Account value which is not going to be pushed (e.g. failed to load).
+   */
+  void skip() { countDown(); }
+
  private:
-  boost::fibers::buffered_channel<T>& channel_;
-  std::size_t limit_;
+  void countDown() {
+    if (limit_.fetch_sub(1U) == 1U) {
+      channel_->close();
+    }
+  }
+
+  boost::fibers::buffered_channel<T>* channel_;
+
+  std::atomic<std::size_t> limit_;
 };
 
 }  // namespace jwlrep
\ No newline at end of file
@@ -21,7 +21,9 @@ enum class GeneralError {
   Interrupted,
   SystemError,
   NetworkError,
-  WrongArg
+  WrongArg,
+  AuthenticationFailed,
+  CircuitOpen
 };
 
 namespace detail {
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/JiraRestApi.h>
+#include <jwlrep/Logger.h>
+
+#include <charconv>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <optional>
+
+namespace {
+
+/**
+ * Percent-encoding of the query component value (RFC 3986).
+ */
+auto encodeQueryValue(std::string_view value) -> std::string {
+  std::string result;
+  result.reserve(value.size());
+  for (auto const symbol : value) {
+    auto const isUnreserved =
+        (symbol >= 'a' && symbol <= 'z') || (symbol >= 'A' && symbol <= 'Z') ||
+        (symbol >= '0' && symbol <= '9') || symbol == '-' || symbol == '.' ||
+        symbol == '_' || symbol == '~';
+    if (isUnreserved) {
+      result += symbol;
+    } else {
+      result += fmt::format("%{:02X}", static_cast<unsigned char>(symbol));
+    }
+  }
+  return result;
+}
+
+/**
+ * Quoted JQL string literal.
+ */
+auto quoteJql(std::string_view value) -> std::string {
+  std::string result{"\""};
+  for (auto const symbol : value) {
+    if (symbol == '"' || symbol == '\\') {
+      result += '\\';
+    }
+    result += symbol;
+  }
+  result += '"';
+  return result;
+}
+
+template <typename Item>
+void readPageCounters(nlohmann::json const& json,
+                      jwlrep::RestPage<Item>& page) {
+  page.startAt = json.value("startAt", std::size_t{0U});
+  page.maxResults = json.at("maxResults").get<std::size_t>();
+  page.total = json.at("total").get<std::size_t>();
+}
+
+auto parseId(std::string const& idStr) -> std::optional<std::uint64_t> {
+  std::uint64_t id = 0U;
+  auto const* const end = idStr.data() + idStr.size();
+  auto const [ptr, errorCode] = std::from_chars(idStr.data(), end, id);
+  if (errorCode != std::errc{} || ptr != end) {
+    return std::nullopt;
+  }
+  return id;
+}
+
+}  // namespace
+
+namespace jwlrep {
+
+auto makeWorklogSearchTarget(std::string_view user,
+                             boost::gregorian::date_period const& period,
+                             std::size_t startAt, std::size_t maxResults)
+    -> std::string {
+  auto const jql = fmt::format(
+      "worklogAuthor = {} AND worklogDate >= \"{}\" AND worklogDate <= \"{}\" "
+      "ORDER BY key ASC",
+      quoteJql(user), boost::gregorian::to_iso_extended_string(period.begin()),
+      boost::gregorian::to_iso_extended_string(period.last()));
+  return fmt::format(
+      "/rest/api/2/search?jql={}&fields=summary&startAt={}&maxResults={}",
+      encodeQueryValue(jql), startAt, maxResults);
+}
+
+auto makeIssueWorklogTarget(std::string_view issueKey, std::size_t startAt,
+                            std::size_t maxResults) -> std::string {
+  return fmt::format("/rest/api/2/issue/{}/worklog?startAt={}&maxResults={}",
+                     encodeQueryValue(issueKey), startAt, maxResults);
+}
+
+auto parseSearchPage(std::string_view json) -> Expected<RestPage<IssueRef>> {
+  try {
+    auto const document = nlohmann::json::parse(json.begin(), json.end());
+    RestPage<IssueRef> page;
+    readPageCounters(document, page);
+    for (auto const& issue : document.at("issues")) {
+      page.items.push_back(
+          {issue.at("key").get<std::string>(),
+           issue.at("fields").at("summary").get<std::string>()});
+    }
+    return page;
+  } catch (nlohmann::json::exception const& e) {
+    LOG_ERROR("Failed to parse search result: {}", e.what());
+    return make_error_code(std::errc::invalid_argument);
+  }
+}
+
+auto parseWorklogPage(std::string_view json, std::string_view user,
+                      boost::gregorian::date_period const& period)
+    -> Expected<RestPage<Entry>> {
+  try {
+    auto const document = nlohmann::json::parse(json.begin(), json.end());
+    RestPage<Entry> page;
+    readPageCounters(document, page);
+    for (auto const& worklog : document.at("worklogs")) {
+      // Server accounts are identified by name, key is kept for renamed ones
+      auto const& author = worklog.at("author");
+      if (author.value("name", "") != user && author.value("key", "") != user) {
+        continue;
+      }
+      // Date of the start in the timezone of the author:
+      // 2020-11-04T12:00:00.000+0000
+      auto const started = worklog.at("started").get<std::string>();
+      auto const startedDate =
+          boost::gregorian::from_simple_string(started.substr(0U, 10U));
+      if (!period.contains(startedDate)) {
+        continue;
+      }
+      page.items.emplace_back(
+          std::chrono::seconds{
+              worklog.at("timeSpentSeconds").get<std::int64_t>()},
+          std::string{user}, startedDate,
+          parseId(worklog.value("id", std::string{})));
+    }
+    return page;
+  } catch (std::exception const& e) {
+    // Date parser throws its own exceptions
+    LOG_ERROR("Failed to parse worklog: {}", e.what());
+    return make_error_code(std::errc::invalid_argument);
+  }
+}
+
+auto nextPageStarts(std::size_t maxResults, std::size_t total)
+    -> std::vector<std::size_t> {
+  std::vector<std::size_t> starts;
+  if (maxResults == 0U) {
+    return starts;
+  }
+  for (auto startAt = maxResults; startAt < total; startAt += maxResults) {
+    starts.push_back(startAt);
+  }
+  return starts;
+}
+
+}  // namespace jwlrep
@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/Outcome.h>
+#include <jwlrep/Worklog.h>
+
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jwlrep {
+
+/**
+ * Issue found by the worklog search.
+ */
+struct IssueRef {
+  std::string key;
+
+  std::string summary;
+};
+
+/**
+ * Page of the paginated response. Server might return less than requested
+ * per page, so maxResults is the actual page size.
+ */
+template <typename Item>
+struct RestPage {
+  std::size_t startAt{0U};
+
+  std::size_t maxResults{0U};
+
+  std::size_t total{0U};
+
+  std::vector<Item> items;
+};
+
+/**
+ * Target of /rest/api/2/search for the issues with the worklog of the user
+ * in the period. Only summary field is requested. Issues are ordered by key,
+ * so the pages might be requested in parallel.
+ */
+auto makeWorklogSearchTarget(std::string_view user,
+                             boost::gregorian::date_period const& period,
+                             std::size_t startAt, std::size_t maxResults)
+    -> std::string;
+
+/**
+ * Target of /rest/api/2/issue/{key}/worklog.
+ */
+auto makeIssueWorklogTarget(std::string_view issueKey, std::size_t startAt,
+                            std::size_t maxResults) -> std::string;
+
+auto parseSearchPage(std::string_view json) -> Expected<RestPage<IssueRef>>;
+
+/**
+ * Only entries of the user which are started in the period are kept, while
+ * the page counters describe all worklog of the issue.
+ */
+auto parseWorklogPage(std::string_view json, std::string_view user,
+                      boost::gregorian::date_period const& period)
+    -> Expected<RestPage<Entry>>;
+
+/**
+ * Start positions of the pages which follow the first one.
+ */
+auto nextPageStarts(std::size_t maxResults, std::size_t total)
+    -> std::vector<std::size_t>;
+
+}  // namespace jwlrep
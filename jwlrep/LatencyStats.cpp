@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/LatencyStats.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace jwlrep {
+
+LatencyStats::LatencyStats(std::size_t windowSize) : windowSize_(windowSize) {
+  samples_.reserve(windowSize_);
+}
+
+void LatencyStats::add(std::chrono::nanoseconds latency) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (windowSize_ == 0U || samples_.size() < windowSize_) {
+    samples_.push_back(latency);
+  } else {
+    // Window is a ring, the oldest sample is replaced
+    samples_[count_ % windowSize_] = latency;
+  }
+  ++count_;
+}
+
+auto LatencyStats::count() const -> std::size_t {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_;
+}
+
+auto LatencyStats::percentile(double rank) const
+    -> std::optional<std::chrono::nanoseconds> {
+  std::vector<std::chrono::nanoseconds> samples;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples = samples_;
+  }
+  if (samples.empty()) {
+    return std::nullopt;
+  }
+
+  auto const position = static_cast<std::size_t>(
+      std::ceil(std::clamp(rank, 0.0, 1.0) * samples.size()));
+  auto const index = position == 0U ? 0U : position - 1U;
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
+
+}  // namespace jwlrep
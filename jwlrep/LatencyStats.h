@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace jwlrep {
+
+/**
+ * Collects latencies of the completed requests and calculates percentiles.
+ * Thread-safe.
+ */
+class LatencyStats final {
+ public:
+  /**
+   * Keep all samples.
+   */
+  LatencyStats() = default;
+
+  /**
+   * Keep only the latest samples, so memory and cost of the percentile are
+   * bounded by the window size whatever the count of requests.
+   */
+  explicit LatencyStats(std::size_t windowSize);
+
+  void add(std::chrono::nanoseconds latency);
+
+  /**
+   * Count of all added samples, including the ones out of the window.
+   */
+  [[nodiscard]] auto count() const -> std::size_t;
+
+  /**
+   * Nearest-rank percentile. Rank is in range [0, 1]. Nothing if there are no
+   * samples.
+   */
+  [[nodiscard]] auto percentile(double rank) const
+      -> std::optional<std::chrono::nanoseconds>;
+
+ private:
+  mutable std::mutex mutex_;
+
+  std::size_t const windowSize_{0U};
+
+  std::vector<std::chrono::nanoseconds> samples_;
+
+  std::size_t count_{0U};
+};
+
+}  // namespace jwlrep
@@ -5,16 +5,36 @@
 #include <jwlrep/ErrorCodeUtil.h>
 #include <jwlrep/Logger.h>
 #include <jwlrep/NetUtil.h>
+#include <jwlrep/ScopeGuard.h>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/beast.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/fiber/asio/yield.hpp>
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <system_error>
 
 namespace jwlrep {
 
+namespace {
+
+void addTiming(RequestTiming* timing, RequestPhase phase,
+               RequestTiming::Clock::time_point startedAt) {
+  if (timing != nullptr) {
+    timing->addSince(phase, startedAt);
+  }
+}
+
+}  // namespace
+
 auto dnsLookup(boost::asio::io_context& ioContext, std::string_view const host,
                std::string_view const service,
                boost::fibers::asio::yield_t& yield)
@@ -31,58 +51,261 @@ auto dnsLookup(boost::asio::io_context& ioContext, std::string_view const host,
   return dnsLookupResults;
 }
 
-auto httpGet(
-    boost::asio::io_context& ioContext, boost::asio::ssl::context& sslContext,
-    boost::asio::ip::tcp::resolver::results_type const& address,
-    boost::beast::http::request<boost::beast::http::empty_body> const& request,
-    std::chrono::nanoseconds const timeout, boost::fibers::asio::yield_t& yield)
-    -> Expected<boost::beast::http::response<boost::beast::http::string_body>> {
-  namespace http = boost::beast::http;
-  namespace beast = boost::beast;
-  namespace net = boost::asio;
-  namespace ssl = boost::asio::ssl;
+auto interleaveAddressFamilies(
+    boost::asio::ip::tcp::resolver::results_type const& endpoints,
+    std::optional<boost::asio::ip::tcp> const& preferredProtocol)
+    -> std::vector<boost::asio::ip::tcp::endpoint> {
+  if (endpoints.empty()) {
+    return {};
+  }
+  auto const firstProtocol =
+      preferredProtocol.value_or(endpoints.begin()->endpoint().protocol());
+  std::vector<boost::asio::ip::tcp::endpoint> first;
+  std::vector<boost::asio::ip::tcp::endpoint> second;
+  for (auto const& result : endpoints) {
+    auto const& endpoint = result.endpoint();
+    (endpoint.protocol() == firstProtocol ? first : second)
+        .push_back(endpoint);
+  }
 
-  beast::error_code errorCode;
-  beast::ssl_stream<beast::tcp_stream> stream(ioContext, sslContext);
+  std::vector<boost::asio::ip::tcp::endpoint> interleaved;
+  interleaved.reserve(first.size() + second.size());
+  for (std::size_t index = 0U;
+       index < std::max(first.size(), second.size()); ++index) {
+    if (index < first.size()) {
+      interleaved.push_back(first[index]);
+    }
+    if (index < second.size()) {
+      interleaved.push_back(second[index]);
+    }
+  }
+  return interleaved;
+}
 
-  beast::get_lowest_layer(stream).expires_after(timeout);
+auto connectFirst(boost::asio::io_context& ioContext,
+                  std::vector<boost::asio::ip::tcp::endpoint> const& endpoints,
+                  std::chrono::milliseconds const attemptDelay,
+                  std::chrono::nanoseconds const timeout,
+                  RequestCancellation* cancellation)
+    -> Expected<boost::asio::ip::tcp::socket> {
+  using Clock = std::chrono::steady_clock;
+  using Socket = boost::asio::ip::tcp::socket;
 
-  beast::get_lowest_layer(stream).async_connect(address, yield[errorCode]);
-  if (errorCode) {
-    LOG_ERROR("Failed to connet. Error: {}", errorCode.message());
-    return toStd(errorCode);
+  // Attempts are made by the fibers of the calling thread. State is shared
+  // with them without extra locking except waiting for their results.
+  boost::fibers::mutex mutex;
+  boost::fibers::condition_variable attemptFinished;
+  std::vector<std::unique_ptr<Socket>> sockets;
+  std::vector<boost::fibers::fiber> attempts;
+  std::optional<std::size_t> winner;
+  std::size_t finishedCount = 0U;
+  boost::system::error_code lastErrorCode = boost::asio::error::not_found;
+
+  sockets.reserve(endpoints.size());
+  attempts.reserve(endpoints.size());
+  auto const isCancelled = [cancellation]() {
+    return cancellation != nullptr && cancellation->isCancelled();
+  };
+  auto const isDone = [&]() {
+    return winner.has_value() || finishedCount == attempts.size() ||
+           isCancelled();
+  };
+  if (cancellation != nullptr) {
+    cancellation->attach(
+        [&attemptFinished]() { attemptFinished.notify_all(); });
   }
+  auto const detachGuard = ScopeGuard{[cancellation]() {
+    if (cancellation != nullptr) {
+      cancellation->attach({});
+    }
+  }};
+  auto const deadline = Clock::now() + timeout;
 
-  beast::get_lowest_layer(stream).expires_after(timeout);
-  stream.async_handshake(ssl::stream_base::client, yield[errorCode]);
-  if (errorCode) {
-    LOG_ERROR("Failed to make handshake. Error: {}", errorCode.message());
-    return toStd(errorCode);
+  std::unique_lock<boost::fibers::mutex> lock(mutex);
+  for (std::size_t index = 0U;
+       index < endpoints.size() && !winner && !isCancelled(); ++index) {
+    if (Clock::now() >= deadline) {
+      break;
+    }
+    sockets.push_back(std::make_unique<Socket>(ioContext));
+    attempts.emplace_back([&, index, socket = sockets.back().get()]() {
+      boost::system::error_code errorCode;
+      socket->async_connect(endpoints[index],
+                            boost::fibers::asio::this_yield()[errorCode]);
+      std::unique_lock<boost::fibers::mutex> lock(mutex);
+      ++finishedCount;
+      if (errorCode) {
+        LOG_DEBUG("Failed to connect to {}. Error: {}",
+                  endpoints[index].address().to_string(),
+                  errorCode.message());
+        lastErrorCode = errorCode;
+      } else if (!winner && !isCancelled()) {
+        winner = index;
+      }
+      attemptFinished.notify_all();
+    });
+
+    auto nextAttemptAt = deadline;
+    if (attemptDelay.count() > 0) {
+      nextAttemptAt = std::min(deadline, Clock::now() + attemptDelay);
+    }
+    attemptFinished.wait_until(lock, nextAttemptAt, isDone);
+  }
+  if (!attemptFinished.wait_until(lock, deadline, isDone)) {
+    lastErrorCode = boost::beast::error::timeout;
+  }
+  if (isCancelled()) {
+    winner.reset();
+    lastErrorCode = boost::asio::error::operation_aborted;
   }
 
-  beast::get_lowest_layer(stream).expires_after(timeout);
-  http::async_write(stream, request, yield[errorCode]);
-  if (errorCode) {
-    LOG_ERROR("Failed to write. Error: {}", errorCode.message());
-    return toStd(errorCode);
+  // Cancel the losers and the attempts which are left after the timeout
+  for (std::size_t index = 0U; index < sockets.size(); ++index) {
+    if (index != winner) {
+      boost::system::error_code errorCode;
+      sockets[index]->close(errorCode);
+    }
+  }
+  lock.unlock();
+  for (auto& attempt : attempts) {
+    attempt.join();
   }
 
-  beast::flat_buffer buffer;
-  http::response<http::string_body> response;
-  http::async_read(stream, buffer, response, yield[errorCode]);
-  if (errorCode) {
-    LOG_ERROR("Failed to read. Error: {}", errorCode.message());
-    return toStd(errorCode);
+  if (!winner) {
+    return toStd(lastErrorCode);
   }
+  return std::move(*sockets[winner.value()]);
+}
+
+auto httpGet(ConnectionPool& connectionPool, HttpRequest const& request,
+             std::chrono::nanoseconds const timeout,
+             boost::fibers::asio::yield_t& yield,
+             BodyHandler const& bodyHandler, RequestCancellation* cancellation,
+             RequestTiming* timing, RateLimiter* rateLimiter)
+    -> Expected<HttpResponse> {
+  namespace http = boost::beast::http;
+  namespace beast = boost::beast;
 
-  beast::get_lowest_layer(stream).expires_after(timeout);
-  stream.async_shutdown(yield[errorCode]);
-  if (errorCode && errorCode != net::error::eof) {
-    LOG_ERROR("Failed to shutdown. Error: {}", errorCode.message());
+  std::optional<std::chrono::steady_clock::time_point> deadline;
+  for (auto isFirstAttempt = true;; isFirstAttempt = false) {
+    // Token is taken before the connection, so the idle connection is not
+    // held while waiting. Cancelled wait ends early and returns the token.
+    if (rateLimiter != nullptr && !rateLimiter->acquire(cancellation)) {
+      return toStd(boost::asio::error::operation_aborted);
+    }
+    // Waiting for the pooled connection is not counted, so requests queued
+    // behind the busy connections don't time out while the server is fine
+    auto remaining = timeout;
+    if (deadline) {
+      remaining = std::max(
+          std::chrono::nanoseconds::zero(),
+          std::chrono::nanoseconds{deadline.value() -
+                                   std::chrono::steady_clock::now()});
+    }
+    auto leaseOrError =
+        connectionPool.acquire(remaining, yield, timing, cancellation);
+    if (!leaseOrError) {
+      return leaseOrError.error();
+    }
+    auto& lease = leaseOrError.value();
+    auto& stream = lease.stream();
+    // Single deadline bounds the attempt from taking the connection, so the
+    // server which trickles the body can't extend it. Repeat on the fresh
+    // connection shares it.
+    if (!deadline) {
+      deadline = lease.takenAt() + timeout;
+    }
+
+    if (cancellation != nullptr) {
+      if (cancellation->isCancelled()) {
+        lease.keepAlive();
+        return toStd(boost::asio::error::operation_aborted);
+      }
+      cancellation->attach(
+          [&stream]() { beast::get_lowest_layer(stream).cancel(); });
+    }
+    auto const detachGuard = ScopeGuard{[cancellation]() {
+      if (cancellation != nullptr) {
+        cancellation->attach({});
+      }
+    }};
+
+    beast::error_code errorCode;
+    auto const writeStartedAt = RequestTiming::Clock::now();
+    beast::get_lowest_layer(stream).expires_at(deadline.value());
+    http::async_write(stream, request, yield[errorCode]);
+    addTiming(timing, RequestPhase::Write, writeStartedAt);
+
+    http::response_parser<http::buffer_body> parser;
+    // Body is not accumulated, so there is no reason to limit it. Explicit
+    // max is used since boost::none is mishandled by some Beast versions.
+    parser.body_limit(std::numeric_limits<std::uint64_t>::max());
+    if (!errorCode) {
+      auto const readStartedAt = RequestTiming::Clock::now();
+      beast::get_lowest_layer(stream).expires_at(deadline.value());
+      http::async_read_header(stream, lease.buffer(), parser,
+                              yield[errorCode]);
+      addTiming(timing, RequestPhase::FirstByte, readStartedAt);
+    }
+
+    if (!errorCode) {
+      HttpResponse const response{parser.get().base()};
+      auto const bodyStartedAt = RequestTiming::Clock::now();
+      auto& bodyBuffer = lease.bodyBuffer();
+      auto const nextChunk = [&]() -> std::string_view {
+        while (!parser.is_done() && !errorCode) {
+          auto& body = parser.get().body();
+          body.data = bodyBuffer.data();
+          body.size = bodyBuffer.size();
+          beast::get_lowest_layer(stream).expires_at(deadline.value());
+          http::async_read(stream, lease.buffer(), parser, yield[errorCode]);
+          if (errorCode == http::error::need_buffer) {
+            errorCode = {};
+          }
+          auto const chunkSize = bodyBuffer.size() - parser.get().body().size;
+          if (chunkSize > 0U) {
+            return {bodyBuffer.data(), chunkSize};
+          }
+        }
+        return {};
+      };
+
+      auto const bodyHandlerError = bodyHandler
+                                        ? bodyHandler(response, nextChunk)
+                                        : std::error_code{};
+      // Drain the rest of the body to keep connection reusable
+      while (!nextChunk().empty()) {
+      }
+      addTiming(timing, RequestPhase::Body, bodyStartedAt);
+
+      if (!errorCode) {
+        if (parser.keep_alive()) {
+          lease.keepAlive();
+        }
+        if (bodyHandlerError) {
+          return bodyHandlerError;
+        }
+        return response;
+      }
+    }
+
+    // Server might close idle keep-alive connection right after the health
+    // check. Repeat once on the fresh connection in this case.
+    if (lease.isReused() && isFirstAttempt && !parser.got_some() &&
+        errorCode != beast::error::timeout &&
+        errorCode != boost::asio::error::operation_aborted) {
+      LOG_DEBUG("Reused connection has failed. Reconnecting. Error: {}",
+                errorCode.message());
+      continue;
+    }
+
+    if (cancellation != nullptr && cancellation->isCancelled()) {
+      LOG_DEBUG("Request has been cancelled");
+    } else {
+      LOG_ERROR("Failed to make request. Error: {}", errorCode.message());
+    }
     return toStd(errorCode);
   }
-
-  return response;
 }
 
 }  // namespace jwlrep
\ No newline at end of file
@@ -4,27 +4,108 @@
 
 #pragma once
 
+#include <jwlrep/ChunkSource.h>
+#include <jwlrep/ConnectionPool.h>
 #include <jwlrep/Logger.h>
 #include <jwlrep/Outcome.h>
+#include <jwlrep/RateLimiter.h>
+#include <jwlrep/RequestCancellation.h>
+#include <jwlrep/RequestTiming.h>
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/ssl.hpp>
 #include <boost/fiber/asio/yield.hpp>
+#include <chrono>
+#include <functional>
+#include <optional>
 #include <string_view>
+#include <system_error>
+#include <vector>
 
 namespace jwlrep {
 
+using HttpRequest = boost::beast::http::request<boost::beast::http::empty_body>;
+
+/**
+ * Status and headers of the response. Body is handed to BodyHandler.
+ */
+using HttpResponse =
+    boost::beast::http::response<boost::beast::http::empty_body>;
+
+/**
+ * Consumer of the response body. Called once headers are received and pulls
+ * body chunks from the source. Unconsumed part of the body is discarded.
+ */
+using BodyHandler = std::function<std::error_code(
+    HttpResponse const& response, ChunkSource const& nextChunk)>;
+
+/**
+ * Body handler of the single attempt of the request. Handler keeps result of
+ * its attempt aside, commit publishes it. Commit is called only for the
+ * attempt whose response is returned, so concurrent or repeated attempts
+ * don't mix their results.
+ */
+struct AttemptBodyHandler {
+  BodyHandler handleBody;
+
+  std::function<void()> commit;
+};
+
+/**
+ * Creates body handler for each attempt of the request.
+ */
+using BodyHandlerFactory = std::function<AttemptBodyHandler()>;
+
 Expected<boost::asio::ip::tcp::resolver::results_type> dnsLookup(
     boost::asio::io_context& ioContext, std::string_view const host,
     std::string_view const service, boost::fibers::asio::yield_t& yield);
 
-Expected<boost::beast::http::response<boost::beast::http::string_body>> httpGet(
-    boost::asio::io_context& ioContext, boost::asio::ssl::context& sslContext,
-    boost::asio::ip::tcp::resolver::results_type const& address,
-    boost::beast::http::request<boost::beast::http::empty_body> const& request,
-    std::chrono::nanoseconds const timeout,
-    boost::fibers::asio::yield_t& yield);
+/**
+ * Order endpoints for the connection attempts (RFC 8305): address families
+ * alternate starting with the preferred one. Order within the family is kept.
+ * Without preference family of the first endpoint goes first.
+ */
+auto interleaveAddressFamilies(
+    boost::asio::ip::tcp::resolver::results_type const& endpoints,
+    std::optional<boost::asio::ip::tcp> const& preferredProtocol)
+    -> std::vector<boost::asio::ip::tcp::endpoint>;
+
+/**
+ * Connect to the endpoint which answers first. Next endpoint is tried once
+ * the previous attempt has failed or has not succeeded in attemptDelay.
+ * Attempts which are in progress are kept running, so slow or blackholed
+ * address doesn't block the others. Error of the last failed attempt is
+ * returned if none has succeeded. Suspends the calling fiber, attempts are
+ * made by the fibers of the calling thread. Cancellation (if given) closes
+ * all attempts.
+ */
+auto connectFirst(boost::asio::io_context& ioContext,
+                  std::vector<boost::asio::ip::tcp::endpoint> const& endpoints,
+                  std::chrono::milliseconds attemptDelay,
+                  std::chrono::nanoseconds timeout,
+                  RequestCancellation* cancellation = nullptr)
+    -> Expected<boost::asio::ip::tcp::socket>;
+
+/**
+ * Make GET request over keep-alive connection taken from the pool. Connection
+ * is returned to the pool if server allows to keep it alive. Body is read in
+ * chunks into the connection's body buffer and handed to the body handler
+ * without being accumulated. Error of the body handler is returned if
+ * transfer itself has succeeded. Timeout bounds the whole exchange from
+ * taking the connection till the end of the body. Waiting for the busy
+ * pooled connections is not limited by it. Durations of the request
+ * phases are added to the timing (if given). Token of the rate limiter (if
+ * given) is taken for each request sent, including the repeated one.
+ * Cancellation ends the wait for the token.
+ */
+auto httpGet(ConnectionPool& connectionPool, HttpRequest const& request,
+             std::chrono::nanoseconds const timeout,
+             boost::fibers::asio::yield_t& yield,
+             BodyHandler const& bodyHandler,
+             RequestCancellation* cancellation = nullptr,
+             RequestTiming* timing = nullptr,
+             RateLimiter* rateLimiter = nullptr) -> Expected<HttpResponse>;
 
 }  // namespace jwlrep
\ No newline at end of file
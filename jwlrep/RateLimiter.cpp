@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/RateLimiter.h>
+#include <jwlrep/RequestCancellation.h>
+#include <jwlrep/ScopeGuard.h>
+
+#include <algorithm>
+#include <boost/fiber/condition_variable.hpp>
+#include <mutex>
+
+namespace jwlrep {
+
+RateLimiter::RateLimiter(RateLimitOptions const& options,
+                         Clock::time_point now)
+    : requestsPerSec_(options.requestsPerSec()),
+      burst_(static_cast<double>(options.burst())),
+      tokens_(burst_),
+      refilledAt_(now) {}
+
+auto RateLimiter::acquire(RequestCancellation* cancellation) -> bool {
+  auto const isCancelled = [cancellation]() {
+    return cancellation != nullptr && cancellation->isCancelled();
+  };
+  if (isCancelled()) {
+    return false;
+  }
+  auto const startedAt = Clock::now();
+  auto const delay = reserve(startedAt);
+  if (delay <= std::chrono::nanoseconds::zero()) {
+    return true;
+  }
+
+  // Cancelled fiber is woken up, so it doesn't outlive the request
+  if (cancellation != nullptr) {
+    cancellation->attach([this]() { wakeUp(); });
+  }
+  auto const detachGuard = ScopeGuard{[cancellation]() {
+    if (cancellation != nullptr) {
+      cancellation->attach({});
+    }
+  }};
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  auto const isWaitCancelled =
+      wokenUp_.wait_until(lock, startedAt + delay, isCancelled);
+  stats_.waitTime += Clock::now() - startedAt;
+  if (!isWaitCancelled) {
+    return true;
+  }
+  tokens_ = std::min(burst_, tokens_ + 1.0);
+  ++stats_.cancelled;
+  return false;
+}
+
+void RateLimiter::wakeUp() {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  wokenUp_.notify_all();
+}
+
+auto RateLimiter::reserve(Clock::time_point now) -> std::chrono::nanoseconds {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  if (now > refilledAt_) {
+    std::chrono::duration<double> const elapsed = now - refilledAt_;
+    tokens_ = std::min(burst_, tokens_ + elapsed.count() * requestsPerSec_);
+    refilledAt_ = now;
+  }
+  tokens_ -= 1.0;
+  ++stats_.requests;
+  if (tokens_ >= 0.0) {
+    return std::chrono::nanoseconds::zero();
+  }
+
+  ++stats_.delayed;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(-tokens_ / requestsPerSec_));
+}
+
+auto RateLimiter::stats() const -> Stats {
+  std::unique_lock<boost::fibers::mutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace jwlrep
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <chrono>
+#include <cstddef>
+
+namespace jwlrep {
+
+class RateLimitOptions;
+
+class RequestCancellation;
+
+/**
+ * Token bucket which keeps the rate of the requests of all threads under the
+ * limit. Bucket is refilled continuously and holds at most burst tokens.
+ * Token is reserved immediately, even if the bucket is empty, so waiting
+ * fibers are served in the order of arrival.
+ */
+class RateLimiter final {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Stats {
+    std::size_t requests{0U};
+
+    /**
+     * Requests which have waited for the token.
+     */
+    std::size_t delayed{0U};
+
+    /**
+     * Time spent by all fibers waiting for the tokens.
+     */
+    std::chrono::nanoseconds waitTime{0};
+
+    /**
+     * Waits which have been cancelled. Their tokens are returned.
+     */
+    std::size_t cancelled{0U};
+  };
+
+  explicit RateLimiter(RateLimitOptions const& options,
+                       Clock::time_point now = Clock::now());
+
+  RateLimiter(RateLimiter const&) = delete;
+  auto operator=(RateLimiter const&) -> RateLimiter& = delete;
+
+  /**
+   * Suspend the fiber until the token is available. Thread is not blocked.
+   * Cancellation (if given) ends the wait early and returns the reserved
+   * token. False is returned if the request has been cancelled.
+   */
+  auto acquire(RequestCancellation* cancellation = nullptr) -> bool;
+
+  /**
+   * Wake up the waiting fibers, so they check their cancellation.
+   */
+  void wakeUp();
+
+  /**
+   * Take the token and tell how long to wait till it is available.
+   */
+  auto reserve(Clock::time_point now) -> std::chrono::nanoseconds;
+
+  [[nodiscard]] auto stats() const -> Stats;
+
+ private:
+  mutable boost::fibers::mutex mutex_;
+
+  boost::fibers::condition_variable wokenUp_;
+
+  double const requestsPerSec_;
+
+  double const burst_;
+
+  /**
+   * Goes below zero when the tokens are reserved by the waiting fibers.
+   */
+  double tokens_;
+
+  Clock::time_point refilledAt_;
+
+  Stats stats_;
+};
+
+}  // namespace jwlrep
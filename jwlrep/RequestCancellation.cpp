@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/RequestCancellation.h>
+
+#include <utility>
+
+namespace jwlrep {
+
+void RequestCancellation::cancel() {
+  cancelled_ = true;
+  if (abort_) {
+    abort_();
+  }
+}
+
+auto RequestCancellation::isCancelled() const -> bool {
+  return cancelled_ || (condition_ && condition_());
+}
+
+void RequestCancellation::attach(std::function<void()> abort) {
+  abort_ = std::move(abort);
+}
+
+void RequestCancellation::cancelIf(std::function<bool()> condition) {
+  condition_ = std::move(condition);
+}
+
+}  // namespace jwlrep
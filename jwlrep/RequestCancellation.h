@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <functional>
+
+namespace jwlrep {
+
+/**
+ * Allows to abort request from another fiber of the same thread. Each step of
+ * the request (waiting for the pooled connection, connect, handshake,
+ * exchange) attaches action which aborts it, and checks the flag before the
+ * next step. Connection of the aborted request is closed.
+ */
+class RequestCancellation final {
+ public:
+  void cancel();
+
+  [[nodiscard]] auto isCancelled() const -> bool;
+
+  /**
+   * Action which aborts the step in progress. Empty if none.
+   */
+  void attach(std::function<void()> abort);
+
+  /**
+   * Request is cancelled as well once the condition is met (e.g. circuit is
+   * opened). Condition is checked along with the flag. Steps which wait are
+   * not notified, the one who changes the condition has to wake them up.
+   */
+  void cancelIf(std::function<bool()> condition);
+
+ private:
+  std::function<void()> abort_;
+
+  std::function<bool()> condition_;
+
+  bool cancelled_{false};
+};
+
+}  // namespace jwlrep
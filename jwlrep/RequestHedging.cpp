@@ -0,0 +1,252 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/Logger.h>
+#include <jwlrep/RequestHedging.h>
+
+#include <algorithm>
+#include <array>
+#include <boost/fiber/condition_variable.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/mutex.hpp>
+#include <memory>
+#include <utility>
+
+namespace {
+
+/**
+ * Latencies of the recent requests which define the hedge delay. Delay
+ * follows the current server latency, and it is cheap to calculate for each
+ * request.
+ */
+auto const kLatencyWindowSize = std::size_t{512U};
+
+auto const kPrimary = std::size_t{0U};
+auto const kHedge = std::size_t{1U};
+
+/**
+ * State of the hedged request which is shared with its attempts. Attempt which
+ * has lost is finished in the background, so the state outlives the call.
+ * Each attempt uses only own fiber, cancellation, timing and body handler.
+ */
+struct HedgedRequest {
+  explicit HedgedRequest(jwlrep::HttpRequest httpRequest)
+      : request(std::move(httpRequest)) {}
+
+  jwlrep::HttpRequest const request;
+
+  boost::fibers::mutex mutex;
+
+  boost::fibers::condition_variable completed;
+
+  std::optional<jwlrep::Expected<jwlrep::HttpResponse>> result;
+
+  std::size_t winner{kPrimary};
+
+  std::size_t runningCount{0U};
+
+  std::array<boost::fibers::fiber, 2U> attempts;
+
+  /**
+   * Attempt is done with the connection pool.
+   */
+  std::array<bool, 2U> isFinished{};
+
+  std::array<jwlrep::RequestCancellation, 2U> cancellations;
+
+  std::array<jwlrep::RequestTiming, 2U> timings;
+
+  std::array<jwlrep::AttemptBodyHandler, 2U> bodyHandlers;
+};
+
+}  // namespace
+
+namespace jwlrep {
+
+HedgingPolicy::HedgingPolicy(HedgingOptions const& options)
+    : options_(options),
+      latencyStats_(std::max(kLatencyWindowSize, options_.minSamples())) {}
+
+auto HedgingPolicy::hedgeDelay() const
+    -> std::optional<std::chrono::nanoseconds> {
+  if (latencyStats_.count() < options_.minSamples()) {
+    return std::nullopt;
+  }
+  return latencyStats_.percentile(options_.percentile());
+}
+
+void HedgingPolicy::onRequest() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.requests;
+}
+
+auto HedgingPolicy::tryHedge() -> bool {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto const budget =
+      options_.maxHedgeRatio() * static_cast<double>(stats_.requests);
+  if (static_cast<double>(stats_.hedges + 1U) > budget) {
+    return false;
+  }
+  ++stats_.hedges;
+  return true;
+}
+
+void HedgingPolicy::onCompleted(std::chrono::nanoseconds latency,
+                                bool hedgeWon) {
+  latencyStats_.add(latency);
+  if (hedgeWon) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.hedgeWins;
+  }
+}
+
+auto HedgingPolicy::stats() const -> Stats {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+BackgroundAttempts::~BackgroundAttempts() { join(); }
+
+void BackgroundAttempts::add(boost::fibers::fiber attempt,
+                             std::shared_ptr<bool const> isFinished) {
+  // Finished attempts don't touch the pool, so they are detached instead of
+  // keeping their stacks till the end
+  auto const firstRunning = std::partition(
+      attempts_.begin(), attempts_.end(),
+      [](Attempt const& entry) { return *entry.isFinished; });
+  for (auto it = attempts_.begin(); it != firstRunning; ++it) {
+    it->fiber.detach();
+  }
+  attempts_.erase(attempts_.begin(), firstRunning);
+  attempts_.push_back(Attempt{std::move(attempt), std::move(isFinished)});
+}
+
+void BackgroundAttempts::join() {
+  // Attempts might be added while the calling fiber is suspended
+  while (!attempts_.empty()) {
+    auto attempts = std::move(attempts_);
+    attempts_.clear();
+    for (auto& entry : attempts) {
+      entry.fiber.join();
+    }
+  }
+}
+
+auto BackgroundAttempts::size() const -> std::size_t {
+  return attempts_.size();
+}
+
+auto hedgedHttpGet(ConnectionPool& connectionPool,
+                   BackgroundAttempts& backgroundAttempts,
+                   HttpRequest const& request,
+                   std::chrono::nanoseconds timeout,
+                   HedgingPolicy& hedgingPolicy,
+                   boost::fibers::asio::yield_t& yield,
+                   BodyHandlerFactory const& makeBodyHandler,
+                   RequestTiming* timing, RateLimiter* rateLimiter,
+                   std::function<bool()> const& isCancelled)
+    -> Expected<HttpResponse> {
+  auto const hedgeDelay = hedgingPolicy.hedgeDelay();
+  hedgingPolicy.onRequest();
+  auto const startedAt = std::chrono::steady_clock::now();
+
+  if (!hedgeDelay) {
+    auto const bodyHandler =
+        makeBodyHandler ? makeBodyHandler() : AttemptBodyHandler{};
+    RequestCancellation cancellation;
+    cancellation.cancelIf(isCancelled);
+    auto responseOrError =
+        httpGet(connectionPool, request, timeout, yield,
+                bodyHandler.handleBody, &cancellation, timing, rateLimiter);
+    if (responseOrError) {
+      hedgingPolicy.onCompleted(std::chrono::steady_clock::now() - startedAt,
+                                false);
+      if (bodyHandler.commit) {
+        bodyHandler.commit();
+      }
+    }
+    return responseOrError;
+  }
+
+  auto const state = std::make_shared<HedgedRequest>(request);
+  // Must be called under the lock of the state
+  auto const launch = [&](std::size_t index) {
+    if (makeBodyHandler) {
+      state->bodyHandlers.at(index) = makeBodyHandler();
+    }
+    // Condition is copied since the loser might outlive the call
+    state->cancellations.at(index).cancelIf(isCancelled);
+    ++state->runningCount;
+    state->attempts.at(index) = boost::fibers::fiber([state, index,
+                                                      &connectionPool,
+                                                      timeout, rateLimiter]() {
+      auto responseOrError = httpGet(
+          connectionPool, state->request, timeout,
+          boost::fibers::asio::this_yield(),
+          state->bodyHandlers.at(index).handleBody,
+          &state->cancellations.at(index), &state->timings.at(index),
+          rateLimiter);
+      std::unique_lock<boost::fibers::mutex> lock(state->mutex);
+      --state->runningCount;
+      state->isFinished.at(index) = true;
+      if (state->result) {
+        return;
+      }
+      // Failure wins only if there is nobody else to wait for
+      if (responseOrError || state->runningCount == 0U) {
+        state->result = std::move(responseOrError);
+        state->winner = index;
+        state->completed.notify_all();
+      }
+    });
+  };
+
+  std::unique_lock<boost::fibers::mutex> lock(state->mutex);
+  launch(kPrimary);
+  auto const isCompleted = [&state]() { return state->result.has_value(); };
+  if (!state->completed.wait_for(lock, hedgeDelay.value(), isCompleted) &&
+      hedgingPolicy.tryHedge()) {
+    LOG_DEBUG(
+        "Request {} is slow. Sending duplicate",
+        std::string_view(request.target().data(), request.target().size()));
+    launch(kHedge);
+  }
+  state->completed.wait(lock, isCompleted);
+  auto const latency = std::chrono::steady_clock::now() - startedAt;
+  auto const winner = state->winner;
+  auto responseOrError = std::move(state->result.value());
+  lock.unlock();
+
+  // Loser is not waited for. Cancellation closes its connection or ends its
+  // wait for the rate limiter token, and it is finished in the background.
+  // Owner joins it before the connection pool is shut down.
+  for (auto index = kPrimary; index <= kHedge; ++index) {
+    auto& attempt = state->attempts.at(index);
+    if (!attempt.joinable()) {
+      continue;
+    }
+    if (index == winner) {
+      attempt.join();
+      continue;
+    }
+    state->cancellations.at(index).cancel();
+    backgroundAttempts.add(
+        std::move(attempt),
+        std::shared_ptr<bool const>{state, &state->isFinished.at(index)});
+  }
+
+  if (responseOrError) {
+    hedgingPolicy.onCompleted(latency, winner == kHedge);
+    auto const& commit = state->bodyHandlers.at(winner).commit;
+    if (commit) {
+      commit();
+    }
+  }
+  if (timing != nullptr) {
+    timing->merge(state->timings.at(winner));
+  }
+  return responseOrError;
+}
+
+}  // namespace jwlrep
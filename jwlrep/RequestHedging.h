@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/ConnectionPool.h>
+#include <jwlrep/LatencyStats.h>
+#include <jwlrep/NetUtil.h>
+#include <jwlrep/Outcome.h>
+#include <jwlrep/RequestTiming.h>
+
+#include <boost/fiber/asio/yield.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace jwlrep {
+
+/**
+ * Decides when duplicate of the slow request should be sent. Duplicate is
+ * sent when request is outstanding longer than the configured percentile of
+ * latencies of the completed requests. Count of duplicates is limited by the
+ * ratio to the count of requests.
+ */
+class HedgingPolicy final {
+ public:
+  struct Stats {
+    std::size_t requests{0U};
+
+    std::size_t hedges{0U};
+
+    /**
+     * Count of requests where duplicate has answered first.
+     */
+    std::size_t hedgeWins{0U};
+  };
+
+  explicit HedgingPolicy(HedgingOptions const& options);
+
+  /**
+   * Delay after which duplicate should be sent. Nothing until enough requests
+   * are completed.
+   */
+  [[nodiscard]] auto hedgeDelay() const
+      -> std::optional<std::chrono::nanoseconds>;
+
+  void onRequest();
+
+  /**
+   * Take permission to send duplicate. False if hedge budget is exhausted.
+   */
+  auto tryHedge() -> bool;
+
+  void onCompleted(std::chrono::nanoseconds latency, bool hedgeWon);
+
+  [[nodiscard]] auto stats() const -> Stats;
+
+ private:
+  HedgingOptions const options_;
+
+  LatencyStats latencyStats_;
+
+  mutable std::mutex mutex_;
+
+  Stats stats_;
+};
+
+/**
+ * Attempts of the hedged requests which have lost and are finished in the
+ * background. Owner joins them before the connection pool they use is shut
+ * down. Used by the fibers of the single thread.
+ */
+class BackgroundAttempts final {
+ public:
+  BackgroundAttempts() = default;
+
+  BackgroundAttempts(BackgroundAttempts const&) = delete;
+  auto operator=(BackgroundAttempts const&) -> BackgroundAttempts& = delete;
+
+  /**
+   * Join the attempts which are left.
+   */
+  ~BackgroundAttempts();
+
+  /**
+   * Keep the attempt until it is finished. Flag is set by the attempt once it
+   * doesn't use the connection pool anymore. Finished attempts are released
+   * on the next call.
+   */
+  void add(boost::fibers::fiber attempt,
+           std::shared_ptr<bool const> isFinished);
+
+  /**
+   * Suspend the calling fiber until all attempts are finished.
+   */
+  void join();
+
+  /**
+   * Count of the attempts which might be still running.
+   */
+  [[nodiscard]] auto size() const -> std::size_t;
+
+ private:
+  struct Attempt {
+    boost::fibers::fiber fiber;
+
+    std::shared_ptr<bool const> isFinished;
+  };
+
+  std::vector<Attempt> attempts_;
+};
+
+/**
+ * Make GET request and send its duplicate over another pooled connection if
+ * the first one is too slow. The first answer wins. The other request is
+ * cancelled and handed to the background attempts, so the call doesn't wait
+ * for it. Each request gets own body handler, only handler of the winner is
+ * committed. Timing of the winner is added to the timing (if given). Each
+ * sent request takes own token of the rate limiter (if given). Condition (if
+ * given) cancels both requests, see RequestCancellation::cancelIf.
+ */
+auto hedgedHttpGet(ConnectionPool& connectionPool,
+                   BackgroundAttempts& backgroundAttempts,
+                   HttpRequest const& request,
+                   std::chrono::nanoseconds timeout,
+                   HedgingPolicy& hedgingPolicy,
+                   boost::fibers::asio::yield_t& yield,
+                   BodyHandlerFactory const& makeBodyHandler,
+                   RequestTiming* timing = nullptr,
+                   RateLimiter* rateLimiter = nullptr,
+                   std::function<bool()> const& isCancelled = {})
+    -> Expected<HttpResponse>;
+
+}  // namespace jwlrep
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/RequestTiming.h>
+
+#include <cmath>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+auto const kPhaseNames = std::array<char const*, 7U>{
+    "dns", "connect", "tls", "write", "ttfb", "body", "parse"};
+
+/**
+ * Milliseconds with microseconds precision.
+ */
+auto toMilliseconds(std::chrono::nanoseconds duration) -> double {
+  auto const kMicrosecondsInMillisecond = 1000.0;
+  return std::round(
+             std::chrono::duration<double, std::milli>(duration).count() *
+             kMicrosecondsInMillisecond) /
+         kMicrosecondsInMillisecond;
+}
+
+}  // namespace
+
+namespace jwlrep {
+
+void RequestTiming::add(RequestPhase phase, std::chrono::nanoseconds duration) {
+  auto& total = durations_[static_cast<std::size_t>(phase)];
+  total = total.value_or(std::chrono::nanoseconds{0}) + duration;
+}
+
+void RequestTiming::addSince(RequestPhase phase, Clock::time_point startedAt) {
+  add(phase, Clock::now() - startedAt);
+}
+
+void RequestTiming::merge(RequestTiming const& other) {
+  for (std::size_t index = 0U; index < kPhasesCount; ++index) {
+    if (other.durations_[index]) {
+      add(static_cast<RequestPhase>(index), other.durations_[index].value());
+    }
+  }
+}
+
+auto RequestTiming::get(RequestPhase phase) const
+    -> std::optional<std::chrono::nanoseconds> {
+  return durations_[static_cast<std::size_t>(phase)];
+}
+
+void RequestTimingStats::add(RequestTiming const& timing) {
+  for (std::size_t index = 0U; index < RequestTiming::kPhasesCount; ++index) {
+    if (timing.durations_[index]) {
+      phases_[index].add(timing.durations_[index].value());
+    }
+  }
+}
+
+auto RequestTimingStats::toJsonLines() const -> std::vector<std::string> {
+  static_assert(kPhaseNames.size() == RequestTiming::kPhasesCount);
+  std::vector<std::string> lines;
+  for (std::size_t index = 0U; index < RequestTiming::kPhasesCount; ++index) {
+    auto const& stats = phases_[index];
+    if (stats.count() == 0U) {
+      continue;
+    }
+    nlohmann::json const json{
+        {"phase", kPhaseNames[index]},
+        {"count", stats.count()},
+        {"p50Ms", toMilliseconds(stats.percentile(0.5).value())},
+        {"p90Ms", toMilliseconds(stats.percentile(0.9).value())},
+        {"p99Ms", toMilliseconds(stats.percentile(0.99).value())},
+        {"maxMs", toMilliseconds(stats.percentile(1.0).value())}};
+    lines.push_back(json.dump());
+  }
+  return lines;
+}
+
+auto toJsonLine(std::string_view user, std::size_t requestsCount,
+                RequestTiming const& timing) -> std::string {
+  nlohmann::json json{{"user", std::string{user}}, {"requests", requestsCount}};
+  for (std::size_t index = 0U; index < kPhaseNames.size(); ++index) {
+    auto const duration = timing.get(static_cast<RequestPhase>(index));
+    if (duration) {
+      json[std::string{kPhaseNames[index]} + "Ms"] =
+          toMilliseconds(duration.value());
+    }
+  }
+  return json.dump();
+}
+
+}  // namespace jwlrep
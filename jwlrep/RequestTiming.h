@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/LatencyStats.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jwlrep {
+
+/**
+ * Phases of the request. DNS, connect and TLS handshake are passed only when
+ * the new connection is opened.
+ */
+enum class RequestPhase {
+  Dns,
+  Connect,
+  TlsHandshake,
+  Write,
+  /**
+   * From the end of the write till the response headers are received.
+   */
+  FirstByte,
+  Body,
+  /**
+   * Decoding, parsing, validation and construction of the timesheet. They
+   * are made in the single pass, so are not told apart. Time of waiting for
+   * the body chunks is excluded.
+   */
+  Parse
+};
+
+/**
+ * Durations of the phases of the single request. Durations of the repeated
+ * phase are summed, e.g. for the retries.
+ */
+class RequestTiming final {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  void add(RequestPhase phase, std::chrono::nanoseconds duration);
+
+  /**
+   * Add duration from startedAt till now.
+   */
+  void addSince(RequestPhase phase, Clock::time_point startedAt);
+
+  /**
+   * Sum durations of both timings.
+   */
+  void merge(RequestTiming const& other);
+
+  /**
+   * Nothing if the phase has not been passed.
+   */
+  [[nodiscard]] auto get(RequestPhase phase) const
+      -> std::optional<std::chrono::nanoseconds>;
+
+ private:
+  static constexpr std::size_t kPhasesCount =
+      static_cast<std::size_t>(RequestPhase::Parse) + 1U;
+
+  std::array<std::optional<std::chrono::nanoseconds>, kPhasesCount> durations_;
+
+  friend class RequestTimingStats;
+};
+
+/**
+ * Distribution of the phase durations over many requests. Thread-safe.
+ */
+class RequestTimingStats final {
+ public:
+  void add(RequestTiming const& timing);
+
+  /**
+   * JSON object for each passed phase: count, p50, p90, p99 and max in
+   * milliseconds.
+   */
+  [[nodiscard]] auto toJsonLines() const -> std::vector<std::string>;
+
+ private:
+  std::array<LatencyStats, RequestTiming::kPhasesCount> phases_;
+};
+
+/**
+ * JSON object with the durations of the passed phases in milliseconds.
+ * Timing of several requests is described by their summed durations.
+ */
+auto toJsonLine(std::string_view user, std::size_t requestsCount,
+                RequestTiming const& timing) -> std::string;
+
+}  // namespace jwlrep
@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/GeneralError.h>
+#include <jwlrep/Logger.h>
+#include <jwlrep/ResponseCache.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <algorithm>
+#include <cstdint>
+
+// Makes input of the deflate stream const
+#define ZLIB_CONST
+#include <zlib.h>
+
+namespace {
+
+auto const kChunkSize = 64U * 1024U;
+
+/**
+ * Window bits which make zlib to write gzip header.
+ */
+auto const kGzipWindowBits = MAX_WBITS + 16;
+
+auto const kDefaultMemLevel = 8;
+
+auto const kEntryFileExtension = ".entry";
+
+/**
+ * Extension of the entries which are being stored. Such files are skipped by
+ * the eviction.
+ */
+auto const kTempFileExtension = ".tmp";
+
+/**
+ * File names must be the same between runs, so std::hash is not suitable.
+ */
+auto fnv1aHash(std::string_view data) -> std::uint64_t {
+  auto hash = std::uint64_t{14695981039346656037ULL};
+  for (auto const symbol : data) {
+    hash ^= static_cast<unsigned char>(symbol);
+    hash *= std::uint64_t{1099511628211ULL};
+  }
+  return hash;
+}
+
+auto isIdentity(std::string_view contentEncoding) -> bool {
+  auto const encoding =
+      boost::algorithm::trim_copy(std::string(contentEncoding));
+  return encoding.empty() || boost::algorithm::iequals(encoding, "identity");
+}
+
+}  // namespace
+
+namespace jwlrep {
+
+CachedBodyReader::CachedBodyReader(CachedResponse const& cachedResponse)
+    : file_(cachedResponse.filePath, std::ios::binary),
+      buffer_(kChunkSize) {
+  file_.seekg(cachedResponse.bodyOffset);
+}
+
+auto CachedBodyReader::nextChunk() -> std::string_view {
+  if (!file_) {
+    return {};
+  }
+  file_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  return {buffer_.data(), static_cast<std::size_t>(file_.gcount())};
+}
+
+void CachedBodyWriter::StreamDeleter::operator()(z_stream_s* stream) const {
+  deflateEnd(stream);
+  delete stream;  // NOLINT
+}
+
+CachedBodyWriter::CachedBodyWriter(ResponseCache& cache,
+                                   std::filesystem::path filePath,
+                                   std::filesystem::path tempFilePath,
+                                   std::string_view key,
+                                   std::string_view contentEncoding,
+                                   std::string_view etag,
+                                   std::string_view lastModified)
+    : cache_(cache),
+      filePath_(std::move(filePath)),
+      tempFilePath_(std::move(tempFilePath)),
+      contentEncoding_(contentEncoding),
+      file_(tempFilePath_, std::ios::binary | std::ios::trunc) {
+  if (isIdentity(contentEncoding_)) {
+    contentEncoding_ = "gzip";
+    stream_.reset(new z_stream_s{});  // NOLINT
+    if (deflateInit2(stream_.get(), Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     kGzipWindowBits, kDefaultMemLevel,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      LOG_ERROR("Failed to init deflate stream");
+      file_.setstate(std::ios::failbit);
+      return;
+    }
+    buffer_.resize(kChunkSize);
+  }
+  // Validators are kept in front of the body
+  file_ << key << '\n'
+        << etag << '\n'
+        << lastModified << '\n'
+        << contentEncoding_ << '\n';
+}
+
+CachedBodyWriter::~CachedBodyWriter() {
+  if (isCommitted_) {
+    return;
+  }
+  file_.close();
+  std::error_code errorCode;
+  std::filesystem::remove(tempFilePath_, errorCode);
+}
+
+void CachedBodyWriter::write(std::string_view chunk) {
+  if (!file_) {
+    return;
+  }
+  if (stream_) {
+    deflateChunk(chunk, Z_NO_FLUSH);
+  } else {
+    file_.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+  }
+}
+
+auto CachedBodyWriter::commit() -> std::error_code {
+  if (stream_ && !deflateChunk({}, Z_FINISH)) {
+    return GeneralError::InternalError;
+  }
+  file_.close();
+  if (!file_) {
+    return GeneralError::SystemError;
+  }
+
+  std::error_code errorCode;
+  // Replaces the previous entry atomically
+  std::filesystem::rename(tempFilePath_, filePath_, errorCode);
+  if (errorCode) {
+    return errorCode;
+  }
+  isCommitted_ = true;
+  cache_.onStored();
+  return GeneralError::Success;
+}
+
+auto CachedBodyWriter::deflateChunk(std::string_view chunk, int flush)
+    -> bool {
+  // NOLINTNEXTLINE
+  stream_->next_in = reinterpret_cast<Bytef const*>(chunk.data());
+  stream_->avail_in = static_cast<uInt>(chunk.size());
+  auto result = Z_OK;
+  do {
+    // NOLINTNEXTLINE
+    stream_->next_out = reinterpret_cast<Bytef*>(buffer_.data());
+    stream_->avail_out = static_cast<uInt>(buffer_.size());
+    result = deflate(stream_.get(), flush);
+    if (result == Z_STREAM_ERROR) {
+      LOG_ERROR("Failed to compress cached body");
+      file_.setstate(std::ios::failbit);
+      return false;
+    }
+    file_.write(buffer_.data(), static_cast<std::streamsize>(
+                                    buffer_.size() - stream_->avail_out));
+  } while (stream_->avail_out == 0U ||
+           (flush == Z_FINISH && result != Z_STREAM_END));
+  return static_cast<bool>(file_);
+}
+
+auto ResponseCache::create(ResponseCacheOptions const& options)
+    -> Expected<std::unique_ptr<ResponseCache>> {
+  std::error_code errorCode;
+  std::filesystem::create_directories(options.directoryPath(), errorCode);
+  if (errorCode) {
+    LOG_ERROR("Failed to create response cache directory {}. Error: {}",
+              options.directoryPath(), errorCode.message());
+    return errorCode;
+  }
+  for (auto const& directoryEntry : std::filesystem::directory_iterator(
+           options.directoryPath(), errorCode)) {
+    if (directoryEntry.path().extension() != kTempFileExtension) {
+      continue;
+    }
+    std::error_code removeErrorCode;
+    if (std::filesystem::remove(directoryEntry.path(), removeErrorCode)) {
+      LOG_DEBUG("Removed stale temporary file {}",
+                directoryEntry.path().string());
+    }
+  }
+  return std::unique_ptr<ResponseCache>(
+      new ResponseCache(options.directoryPath(), options.maxSize()));
+}
+
+ResponseCache::ResponseCache(std::filesystem::path directoryPath,
+                             std::size_t maxSize)
+    : directoryPath_(std::move(directoryPath)), maxSize_(maxSize) {}
+
+auto ResponseCache::find(std::string const& key)
+    -> std::optional<CachedResponse> {
+  CachedResponse cachedResponse;
+  cachedResponse.filePath = entryFilePath(key);
+  std::ifstream file(cachedResponse.filePath, std::ios::binary);
+  if (!file) {
+    return std::nullopt;
+  }
+
+  std::string storedKey;
+  std::getline(file, storedKey);
+  std::getline(file, cachedResponse.etag);
+  std::getline(file, cachedResponse.lastModified);
+  std::getline(file, cachedResponse.contentEncoding);
+  if (!file || storedKey != key) {
+    return std::nullopt;
+  }
+  cachedResponse.bodyOffset = file.tellg();
+
+  std::error_code errorCode;
+  std::filesystem::last_write_time(
+      cachedResponse.filePath, std::filesystem::file_time_type::clock::now(),
+      errorCode);
+  return cachedResponse;
+}
+
+auto ResponseCache::store(std::string const& key,
+                          std::string_view contentEncoding,
+                          std::string_view etag, std::string_view lastModified)
+    -> Expected<std::unique_ptr<CachedBodyWriter>> {
+  auto filePath = entryFilePath(key);
+  // Same response might be stored by the hedged requests simultaneously
+  auto tempFilePath = filePath;
+  tempFilePath.replace_extension(
+      fmt::format(".{}{}", nextWriterId_++, kTempFileExtension));
+  auto writer = std::make_unique<CachedBodyWriter>(
+      *this, std::move(filePath), std::move(tempFilePath), key,
+      contentEncoding, etag, lastModified);
+  return writer;
+}
+
+void ResponseCache::evict() {
+  struct EntryFile {
+    std::filesystem::path path;
+
+    std::filesystem::file_time_type lastUsed;
+
+    std::uintmax_t size;
+  };
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<EntryFile> entryFiles;
+  std::uintmax_t totalSize = 0U;
+  std::error_code errorCode;
+  for (auto const& directoryEntry :
+       std::filesystem::directory_iterator(directoryPath_, errorCode)) {
+    if (directoryEntry.path().extension() != kEntryFileExtension) {
+      continue;
+    }
+    std::error_code entryErrorCode;
+    auto const size = directoryEntry.file_size(entryErrorCode);
+    auto const lastUsed = directoryEntry.last_write_time(entryErrorCode);
+    if (entryErrorCode) {
+      continue;
+    }
+    entryFiles.push_back({directoryEntry.path(), lastUsed, size});
+    totalSize += size;
+  }
+
+  std::sort(entryFiles.begin(), entryFiles.end(),
+            [](auto const& lhs, auto const& rhs) {
+              return lhs.lastUsed < rhs.lastUsed;
+            });
+  for (auto const& entryFile : entryFiles) {
+    if (totalSize <= maxSize_) {
+      break;
+    }
+    if (std::filesystem::remove(entryFile.path, errorCode)) {
+      totalSize -= entryFile.size;
+      ++stats_.evicted;
+    }
+  }
+}
+
+auto ResponseCache::stats() const -> Stats {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+auto ResponseCache::entryFilePath(std::string const& key) const
+    -> std::filesystem::path {
+  return directoryPath_ /
+         (fmt::format("{:016x}", fnv1aHash(key)) + kEntryFileExtension);
+}
+
+void ResponseCache::onStored() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.stored;
+}
+
+}  // namespace jwlrep
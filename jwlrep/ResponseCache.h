@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/Outcome.h>
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct z_stream_s;
+
+namespace jwlrep {
+
+class ResponseCache;
+class ResponseCacheOptions;
+
+/**
+ * Response found in the cache. Body is kept in the encoding it was received
+ * in, identity body is compressed with gzip.
+ */
+struct CachedResponse {
+  std::string etag;
+
+  std::string lastModified;
+
+  std::string contentEncoding;
+
+  std::filesystem::path filePath;
+
+  /**
+   * Position of the body in the file.
+   */
+  std::streamoff bodyOffset{0};
+};
+
+/**
+ * Reads the cached body by chunks. Empty chunk means end of the body or
+ * failure.
+ */
+class CachedBodyReader final {
+ public:
+  explicit CachedBodyReader(CachedResponse const& cachedResponse);
+
+  auto nextChunk() -> std::string_view;
+
+ private:
+  std::ifstream file_;
+
+  std::vector<char> buffer_;
+};
+
+/**
+ * Stores the validators and the chunks of the received body into the
+ * temporary file. Entry is replaced by the file only on commit, so failed
+ * transfer keeps the previous one. Use ResponseCache::store to create.
+ */
+class CachedBodyWriter final {
+ public:
+  CachedBodyWriter(ResponseCache& cache, std::filesystem::path filePath,
+                   std::filesystem::path tempFilePath, std::string_view key,
+                   std::string_view contentEncoding, std::string_view etag,
+                   std::string_view lastModified);
+
+  CachedBodyWriter(CachedBodyWriter const&) = delete;
+  auto operator=(CachedBodyWriter const&) -> CachedBodyWriter& = delete;
+
+  /**
+   * Remove the temporary file if entry has not been committed.
+   */
+  ~CachedBodyWriter();
+
+  void write(std::string_view chunk);
+
+  /**
+   * Make entry available. Body must be complete.
+   */
+  auto commit() -> std::error_code;
+
+ private:
+  struct StreamDeleter {
+    void operator()(z_stream_s* stream) const;
+  };
+
+  auto deflateChunk(std::string_view chunk, int flush) -> bool;
+
+  ResponseCache& cache_;
+
+  std::filesystem::path const filePath_;
+
+  std::filesystem::path const tempFilePath_;
+
+  std::string contentEncoding_;
+
+  std::ofstream file_;
+
+  /**
+   * Compressor of the identity body. Null if body is already encoded.
+   */
+  std::unique_ptr<z_stream_s, StreamDeleter> stream_;
+
+  std::vector<char> buffer_;
+
+  bool isCommitted_{false};
+};
+
+/**
+ * On-disk cache of the response bodies keyed by the request. Each entry is
+ * the file which keeps validators (ETag, Last-Modified) and the body. Least
+ * recently used entries are evicted when total size exceeds the limit.
+ * Thread-safe.
+ */
+class ResponseCache final {
+ public:
+  struct Stats {
+    std::size_t stored{0U};
+
+    std::size_t evicted{0U};
+  };
+
+  /**
+   * Directory is created if it doesn't exist. Temporary files left by the
+   * interrupted runs are removed.
+   */
+  static auto create(ResponseCacheOptions const& options)
+      -> Expected<std::unique_ptr<ResponseCache>>;
+
+  ResponseCache(ResponseCache const&) = delete;
+  auto operator=(ResponseCache const&) -> ResponseCache& = delete;
+
+  /**
+   * Found entry becomes the most recently used.
+   */
+  auto find(std::string const& key) -> std::optional<CachedResponse>;
+
+  /**
+   * Start storing the response body. Content encoding and validators are the
+   * ones of the received response.
+   */
+  auto store(std::string const& key, std::string_view contentEncoding,
+             std::string_view etag, std::string_view lastModified)
+      -> Expected<std::unique_ptr<CachedBodyWriter>>;
+
+  /**
+   * Remove least recently used entries until total size fits the limit.
+   * Entries which are being stored are not counted.
+   */
+  void evict();
+
+  [[nodiscard]] auto stats() const -> Stats;
+
+ private:
+  friend class CachedBodyWriter;
+
+  ResponseCache(std::filesystem::path directoryPath, std::size_t maxSize);
+
+  auto entryFilePath(std::string const& key) const -> std::filesystem::path;
+
+  void onStored();
+
+  std::filesystem::path const directoryPath_;
+
+  std::size_t const maxSize_;
+
+  /**
+   * Makes names of the temporary files unique.
+   */
+  std::atomic<std::size_t> nextWriterId_{0U};
+
+  mutable std::mutex mutex_;
+
+  Stats stats_;
+};
+
+}  // namespace jwlrep
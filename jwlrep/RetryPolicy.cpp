@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/RetryPolicy.h>
+
+#include <algorithm>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <charconv>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+/**
+ * Longer delay can't fit any sane total timeout, so the request is given up
+ * anyway. Cap keeps the conversion to milliseconds from overflowing.
+ */
+auto const kMaxRetryAfter = std::chrono::seconds{std::chrono::hours{24}};
+
+/**
+ * Parse HTTP date in the preferred IMF-fixdate format, e.g.
+ * "Wed, 21 Oct 2015 07:28:00 GMT". Time since epoch is returned since far
+ * dates don't fit the system clock.
+ */
+auto parseHttpDate(std::string_view value)
+    -> std::optional<std::chrono::milliseconds> {
+  std::tm tm{};
+  std::istringstream stream{std::string{value}};
+  stream.imbue(std::locale::classic());
+  stream >> std::get_time(&tm, "%a, %d %b %Y %H:%M:%S GMT");
+  if (stream.fail()) {
+    return std::nullopt;
+  }
+  try {
+    auto const sinceEpoch = boost::posix_time::ptime_from_tm(tm) -
+                            boost::posix_time::from_time_t(0);
+    return std::chrono::milliseconds{
+        std::chrono::seconds{sinceEpoch.total_seconds()}};
+  } catch (std::out_of_range const&) {
+    return std::nullopt;
+  }
+}
+
+}  // namespace
+
+namespace jwlrep {
+
+auto isRetryable(Expected<HttpResponse> const& responseOrError) -> bool {
+  namespace http = boost::beast::http;
+  if (!responseOrError) {
+    // Malformed body will not become valid on the next attempt
+    return responseOrError.error() != std::errc::invalid_argument;
+  }
+  switch (responseOrError.value().result()) {
+    case http::status::request_timeout:
+    case http::status::too_many_requests:
+    case http::status::internal_server_error:
+    case http::status::bad_gateway:
+    case http::status::service_unavailable:
+    case http::status::gateway_timeout:
+      return true;
+    default:
+      return false;
+  }
+}
+
+auto computeBackoff(std::size_t retry, std::chrono::milliseconds baseDelay,
+                    std::chrono::milliseconds maxDelay, double jitter)
+    -> std::chrono::milliseconds {
+  auto ceiling = baseDelay;
+  for (auto i = 0U; i < retry && ceiling < maxDelay; ++i) {
+    ceiling *= 2;
+  }
+  ceiling = std::min(ceiling, maxDelay);
+  return std::chrono::milliseconds{static_cast<std::chrono::milliseconds::rep>(
+      static_cast<double>(ceiling.count()) * std::clamp(jitter, 0.0, 1.0))};
+}
+
+auto parseRetryAfter(std::string_view value,
+                     std::chrono::system_clock::time_point now)
+    -> std::optional<std::chrono::milliseconds> {
+  unsigned long long seconds = 0U;
+  auto const* const end = value.data() + value.size();
+  auto const [ptr, errorCode] = std::from_chars(value.data(), end, seconds);
+  if (errorCode == std::errc::result_out_of_range && ptr == end) {
+    return kMaxRetryAfter;
+  }
+  if (errorCode == std::errc{} && ptr == end) {
+    auto const maxSeconds =
+        static_cast<unsigned long long>(kMaxRetryAfter.count());
+    return std::chrono::seconds{
+        static_cast<std::chrono::seconds::rep>(std::min(seconds, maxSeconds))};
+  }
+
+  auto const dateOrNothing = parseHttpDate(value);
+  if (!dateOrNothing) {
+    return std::nullopt;
+  }
+  return std::clamp(dateOrNothing.value() -
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                            now.time_since_epoch()),
+                    std::chrono::milliseconds::zero(),
+                    std::chrono::milliseconds{kMaxRetryAfter});
+}
+
+RetryPolicy::RetryPolicy(RetryOptions const& options)
+    : options_(options), randomEngine_(std::random_device{}()) {}
+
+auto RetryPolicy::attemptTimeout(std::chrono::nanoseconds elapsed) const
+    -> std::chrono::nanoseconds {
+  auto const remaining = options_.totalTimeout() - elapsed;
+  return std::max(std::chrono::nanoseconds::zero(),
+                  std::min<std::chrono::nanoseconds>(options_.attemptTimeout(),
+                                                     remaining));
+}
+
+auto RetryPolicy::nextDelay(std::size_t attempt,
+                            Expected<HttpResponse> const& responseOrError,
+                            std::chrono::nanoseconds elapsed)
+    -> std::optional<std::chrono::milliseconds> {
+  if (attempt + 1U >= options_.maxAttempts() || !isRetryable(responseOrError)) {
+    return std::nullopt;
+  }
+
+  double jitter = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(randomEngineMutex_);
+    jitter = std::uniform_real_distribution<double>{0.0, 1.0}(randomEngine_);
+  }
+  auto delay = computeBackoff(attempt, options_.baseDelay(),
+                              options_.maxDelay(), jitter);
+
+  // Server knows better when it is ready to serve again
+  if (responseOrError) {
+    auto const& response = responseOrError.value();
+    auto const retryAfter =
+        response.find(boost::beast::http::field::retry_after);
+    if (retryAfter != response.end()) {
+      auto const retryAfterDelay = parseRetryAfter(
+          std::string_view{retryAfter->value().data(),
+                           retryAfter->value().size()},
+          std::chrono::system_clock::now());
+      if (retryAfterDelay) {
+        delay = std::max(delay, retryAfterDelay.value());
+      }
+    }
+  }
+
+  // Give up if there is no time left for one more attempt
+  if (elapsed + delay >= options_.totalTimeout()) {
+    return std::nullopt;
+  }
+  return delay;
+}
+
+auto RetryPolicy::maxAttempts() const -> std::size_t {
+  return options_.maxAttempts();
+}
+
+}  // namespace jwlrep
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/NetUtil.h>
+#include <jwlrep/Outcome.h>
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string_view>
+
+namespace jwlrep {
+
+/**
+ * Check whether request might succeed if repeated: network errors and
+ * 408, 429, 500, 502, 503, 504 statuses. Malformed body is not retryable.
+ */
+auto isRetryable(Expected<HttpResponse> const& responseOrError) -> bool;
+
+/**
+ * Exponential backoff with full jitter: random delay in range
+ * [0, min(maxDelay, baseDelay * 2^retry)). Jitter is a random value in range
+ * [0, 1).
+ */
+auto computeBackoff(std::size_t retry, std::chrono::milliseconds baseDelay,
+                    std::chrono::milliseconds maxDelay, double jitter)
+    -> std::chrono::milliseconds;
+
+/**
+ * Parse value of the Retry-After header: either delay in seconds or HTTP date.
+ * Date in the past gives zero delay. Delay is capped at a day.
+ */
+auto parseRetryAfter(std::string_view value,
+                     std::chrono::system_clock::time_point now)
+    -> std::optional<std::chrono::milliseconds>;
+
+/**
+ * Decides whether and when failed request should be repeated.
+ */
+class RetryPolicy final {
+ public:
+  explicit RetryPolicy(RetryOptions const& options);
+
+  /**
+   * Timeout of the next attempt. Attempt is not allowed to outlive total
+   * timeout.
+   */
+  [[nodiscard]] auto attemptTimeout(std::chrono::nanoseconds elapsed) const
+      -> std::chrono::nanoseconds;
+
+  /**
+   * Delay before the next attempt or nothing if request should not be
+   * repeated. Attempt is zero based. Elapsed is the time since the first
+   * attempt has been started.
+   */
+  auto nextDelay(std::size_t attempt,
+                 Expected<HttpResponse> const& responseOrError,
+                 std::chrono::nanoseconds elapsed)
+      -> std::optional<std::chrono::milliseconds>;
+
+  [[nodiscard]] auto maxAttempts() const -> std::size_t;
+
+ private:
+  RetryOptions const options_;
+
+  std::mutex randomEngineMutex_;
+
+  std::mt19937 randomEngine_;
+};
+
+}  // namespace jwlrep
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/GeneralError.h>
+#include <jwlrep/Logger.h>
+#include <jwlrep/SpillBuffer.h>
+
+#include <boost/interprocess/exceptions.hpp>
+#include <random>
+#include <vector>
+
+namespace {
+
+/**
+ * Name which doesn't clash with the files of the other buffers and
+ * processes.
+ */
+auto makeSpillFileName() -> std::string {
+  thread_local std::mt19937_64 randomEngine{std::random_device{}()};
+  return fmt::format("jwlrep-body-{:016x}.tmp", randomEngine());
+}
+
+}  // namespace
+
+namespace jwlrep {
+
+SpillBuffer::SpillBuffer(std::size_t memoryBudget,
+                         std::filesystem::path directory, std::size_t padding)
+    : memoryBudget_(memoryBudget),
+      directory_(std::move(directory)),
+      padding_(padding) {}
+
+SpillBuffer::~SpillBuffer() {
+  if (filePath_.empty()) {
+    return;
+  }
+  // Mapping has to be released before the file is removed
+  region_ = boost::interprocess::mapped_region{};
+  mapping_ = boost::interprocess::file_mapping{};
+  file_.close();
+  std::error_code errorCode;
+  std::filesystem::remove(filePath_, errorCode);
+}
+
+auto SpillBuffer::append(std::string_view chunk) -> std::error_code {
+  size_ += chunk.size();
+  if (!isSpilled() && size_ > memoryBudget_) {
+    if (auto const errorCode = spill()) {
+      return errorCode;
+    }
+  }
+
+  if (!isSpilled()) {
+    memory_.append(chunk);
+    return GeneralError::Success;
+  }
+  file_.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+  return file_ ? GeneralError::Success : GeneralError::SystemError;
+}
+
+auto SpillBuffer::append(ChunkSource const& source) -> std::error_code {
+  for (auto chunk = source(); !chunk.empty(); chunk = source()) {
+    if (auto const errorCode = append(chunk)) {
+      return errorCode;
+    }
+  }
+  return GeneralError::Success;
+}
+
+auto SpillBuffer::view() -> Expected<std::string_view> {
+  if (!isSpilled()) {
+    memory_.resize(size_ + padding_, '\0');
+    return std::string_view{memory_.data(), size_};
+  }
+
+  if (file_.is_open()) {
+    std::vector<char> const padding(padding_, '\0');
+    file_.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    file_.close();
+    if (!file_) {
+      LOG_ERROR("Failed to write body to {}", filePath_.string());
+      return GeneralError::SystemError;
+    }
+    try {
+      mapping_ = boost::interprocess::file_mapping{
+          filePath_.string().c_str(), boost::interprocess::read_only};
+      region_ = boost::interprocess::mapped_region{
+          mapping_, boost::interprocess::read_only};
+    } catch (boost::interprocess::interprocess_exception const& e) {
+      LOG_ERROR("Failed to map {}: {}", filePath_.string(), e.what());
+      return GeneralError::SystemError;
+    }
+  }
+  return std::string_view{static_cast<char const*>(region_.get_address()),
+                          size_};
+}
+
+auto SpillBuffer::isSpilled() const -> bool { return !filePath_.empty(); }
+
+auto SpillBuffer::size() const -> std::size_t { return size_; }
+
+auto SpillBuffer::spill() -> std::error_code {
+  auto directory = directory_;
+  if (directory.empty()) {
+    std::error_code errorCode;
+    directory = std::filesystem::temp_directory_path(errorCode);
+  }
+  filePath_ = directory / makeSpillFileName();
+  file_.open(filePath_, std::ios::binary | std::ios::trunc);
+  file_.write(memory_.data(), static_cast<std::streamsize>(memory_.size()));
+  if (!file_) {
+    LOG_ERROR("Failed to spill body to {}", filePath_.string());
+    return GeneralError::SystemError;
+  }
+  LOG_DEBUG("Body exceeds {} bytes, spilled to {}", memoryBudget_,
+            filePath_.string());
+  std::string{}.swap(memory_);
+  return GeneralError::Success;
+}
+
+}  // namespace jwlrep
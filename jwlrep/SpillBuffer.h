@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/ChunkSource.h>
+#include <jwlrep/Outcome.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace jwlrep {
+
+/**
+ * Accumulates the document which is needed in a contiguous memory. Document
+ * is kept in memory while it fits the budget. Otherwise it is written to the
+ * temporary file, which is memory-mapped once complete, so the pages are
+ * loaded by the system on demand. File is removed with the buffer.
+ */
+class SpillBuffer final {
+ public:
+  /**
+   * Padding is the count of zero bytes after the end of the document which
+   * are readable as well. File is created in the temporary directory if the
+   * directory is empty.
+   */
+  SpillBuffer(std::size_t memoryBudget, std::filesystem::path directory,
+              std::size_t padding);
+
+  ~SpillBuffer();
+
+  SpillBuffer(SpillBuffer const&) = delete;
+  auto operator=(SpillBuffer const&) -> SpillBuffer& = delete;
+
+  auto append(std::string_view chunk) -> std::error_code;
+
+  /**
+   * Append chunks of the source till its end.
+   */
+  auto append(ChunkSource const& source) -> std::error_code;
+
+  /**
+   * Whole document. Nothing might be appended afterwards.
+   */
+  auto view() -> Expected<std::string_view>;
+
+  [[nodiscard]] auto isSpilled() const -> bool;
+
+  [[nodiscard]] auto size() const -> std::size_t;
+
+ private:
+  /**
+   * Move accumulated part of the document to the file.
+   */
+  auto spill() -> std::error_code;
+
+  std::size_t const memoryBudget_;
+
+  std::filesystem::path const directory_;
+
+  std::size_t const padding_;
+
+  std::string memory_;
+
+  std::size_t size_{0U};
+
+  std::filesystem::path filePath_;
+
+  std::ofstream file_;
+
+  boost::interprocess::file_mapping mapping_;
+
+  boost::interprocess::mapped_region region_;
+};
+
+}  // namespace jwlrep
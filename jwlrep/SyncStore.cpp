@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/GeneralError.h>
+#include <jwlrep/Logger.h>
+#include <jwlrep/SyncStore.h>
+
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace jwlrep {
+
+SyncStore::SyncStore(std::string serverHost)
+    : serverHost_(std::move(serverHost)) {}
+
+auto SyncStore::find(std::string const& user) const
+    -> std::optional<SyncedTimeSheet> {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto const it = timeSheets_.find(user);
+  if (it == timeSheets_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void SyncStore::put(std::string const& user, SyncedTimeSheet syncedTimeSheet) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  timeSheets_.insert_or_assign(user, std::move(syncedTimeSheet));
+}
+
+auto SyncStore::load(std::filesystem::path const& filePath) -> std::error_code {
+  std::ifstream file(filePath);
+  if (!file) {
+    return GeneralError::SystemError;
+  }
+
+  // Each line is JSON object with the timesheet of the single user
+  std::size_t loadedCount = 0U;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (std::string line; std::getline(file, line);) {
+    auto const json = nlohmann::json::parse(line, nullptr, false);
+    if (!json.is_object() || json.value("server", "") != serverHost_) {
+      continue;
+    }
+    try {
+      auto const user = json.at("user").get<std::string>();
+      boost::gregorian::date_period const period{
+          boost::gregorian::from_simple_string(
+              json.at("dateStart").get<std::string>()),
+          boost::gregorian::from_simple_string(
+              json.at("dateEnd").get<std::string>()) +
+              boost::gregorian::days(1)};
+      auto const syncedOn = boost::gregorian::from_simple_string(
+          json.at("syncedOn").get<std::string>());
+      // Timesheet stored without it is fully synced by the next run
+      boost::gregorian::date fullySyncedOn;
+      if (json.contains("fullySyncedOn")) {
+        fullySyncedOn = boost::gregorian::from_simple_string(
+            json.at("fullySyncedOn").get<std::string>());
+      }
+      auto timeSheetOrError =
+          createUserTimeSheetFromJson(json.at("timeSheet").dump());
+      if (!timeSheetOrError || period.is_null()) {
+        LOG_WARN("Skip malformed synced timesheet of {}", user);
+        continue;
+      }
+      timeSheets_.insert_or_assign(
+          user, SyncedTimeSheet{period, syncedOn, fullySyncedOn,
+                                std::move(timeSheetOrError.value())});
+      ++loadedCount;
+    } catch (std::exception const& e) {
+      LOG_WARN("Skip malformed synced timesheet: {}", e.what());
+    }
+  }
+
+  LOG_DEBUG("Loaded {} synced timesheets from {}", loadedCount,
+            filePath.string());
+  return GeneralError::Success;
+}
+
+auto SyncStore::save(std::filesystem::path const& filePath) const
+    -> std::error_code {
+  std::ofstream file(filePath, std::ios::trunc);
+  if (!file) {
+    return GeneralError::SystemError;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto const& [user, syncedTimeSheet] : timeSheets_) {
+    nlohmann::json json{
+        {"server", serverHost_},
+        {"user", user},
+        {"dateStart", boost::gregorian::to_iso_extended_string(
+                          syncedTimeSheet.period.begin())},
+        {"dateEnd", boost::gregorian::to_iso_extended_string(
+                        syncedTimeSheet.period.last())},
+        {"syncedOn",
+         boost::gregorian::to_iso_extended_string(syncedTimeSheet.syncedOn)},
+        {"timeSheet", nlohmann::json::parse(
+                          userTimeSheetToJson(syncedTimeSheet.timeSheet))}};
+    if (!syncedTimeSheet.fullySyncedOn.is_special()) {
+      json["fullySyncedOn"] = boost::gregorian::to_iso_extended_string(
+          syncedTimeSheet.fullySyncedOn);
+    }
+    file << json.dump() << '\n';
+  }
+
+  return file ? GeneralError::Success : GeneralError::SystemError;
+}
+
+auto incrementalSyncPeriod(boost::gregorian::date_period const& reportPeriod,
+                           SyncedTimeSheet const& syncedTimeSheet,
+                           boost::gregorian::days overlap)
+    -> std::optional<boost::gregorian::date_period> {
+  // At least the last day is requested, so the report is never built from
+  // the stored data only
+  auto const fetchedFrom =
+      std::clamp(syncedTimeSheet.syncedOn - overlap, reportPeriod.begin(),
+                 reportPeriod.last());
+  auto const& storedPeriod = syncedTimeSheet.period;
+  if (storedPeriod.begin() > reportPeriod.begin() ||
+      storedPeriod.end() < fetchedFrom) {
+    return std::nullopt;
+  }
+  return boost::gregorian::date_period{fetchedFrom, reportPeriod.end()};
+}
+
+auto isFullResyncDue(SyncedTimeSheet const& syncedTimeSheet,
+                     boost::gregorian::days fullResyncInterval,
+                     boost::gregorian::date today) -> bool {
+  return syncedTimeSheet.fullySyncedOn.is_special() ||
+         syncedTimeSheet.fullySyncedOn + fullResyncInterval <= today;
+}
+
+auto mergeSyncedTimeSheet(UserTimeSheet const& storedTimeSheet,
+                          boost::gregorian::date reportStart,
+                          boost::gregorian::date fetchedFrom,
+                          UserTimeSheet&& fetchedTimeSheet) -> UserTimeSheet {
+  std::vector<Worklog> storedWorklog;
+  for (auto const& worklog : storedTimeSheet.worklog()) {
+    std::vector<Entry> entries;
+    std::copy_if(worklog.entries().begin(), worklog.entries().end(),
+                 std::back_inserter(entries), [&](auto const& entry) {
+                   return reportStart <= entry.created() &&
+                          entry.created() < fetchedFrom;
+                 });
+    if (!entries.empty()) {
+      storedWorklog.emplace_back(worklog.key(), worklog.summary(),
+                                 std::move(entries));
+    }
+  }
+
+  std::vector<UserTimeSheet> parts;
+  parts.emplace_back(std::move(storedWorklog));
+  parts.push_back(std::move(fetchedTimeSheet));
+  return mergeUserTimeSheets(std::move(parts));
+}
+
+}  // namespace jwlrep
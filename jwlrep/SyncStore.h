@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/Worklog.h>
+
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+
+namespace jwlrep {
+
+/**
+ * Timesheet of the user fetched by the previous run.
+ */
+struct SyncedTimeSheet {
+  boost::gregorian::date_period period;
+
+  /**
+   * Day of the request. Worklog of the later days was not known yet.
+   */
+  boost::gregorian::date syncedOn;
+
+  /**
+   * Day of the last request of the whole report period. Not a date if
+   * unknown.
+   */
+  boost::gregorian::date fullySyncedOn;
+
+  UserTimeSheet timeSheet;
+};
+
+/**
+ * Timesheets of the users kept between the runs. Timesheets of the other
+ * server are ignored on load. Thread-safe.
+ */
+class SyncStore final {
+ public:
+  explicit SyncStore(std::string serverHost);
+
+  SyncStore(SyncStore const&) = delete;
+  auto operator=(SyncStore const&) -> SyncStore& = delete;
+
+  [[nodiscard]] auto find(std::string const& user) const
+      -> std::optional<SyncedTimeSheet>;
+
+  void put(std::string const& user, SyncedTimeSheet syncedTimeSheet);
+
+  auto load(std::filesystem::path const& filePath) -> std::error_code;
+
+  auto save(std::filesystem::path const& filePath) const -> std::error_code;
+
+ private:
+  std::string const serverHost_;
+
+  mutable std::mutex mutex_;
+
+  std::map<std::string, SyncedTimeSheet> timeSheets_;
+};
+
+/**
+ * Part of the report period which has to be requested if the stored
+ * timesheet is used: from the last sync minus overlap till the end. Nothing
+ * if stored timesheet doesn't cover the rest of the report period, so the
+ * whole period has to be requested.
+ */
+auto incrementalSyncPeriod(boost::gregorian::date_period const& reportPeriod,
+                           SyncedTimeSheet const& syncedTimeSheet,
+                           boost::gregorian::days overlap)
+    -> std::optional<boost::gregorian::date_period>;
+
+/**
+ * Whether the whole report period has to be requested again. Incremental
+ * sync requests only the trailing days, so the entries which were edited or
+ * deleted on the server before the overlap are corrected by the full sync
+ * only.
+ */
+auto isFullResyncDue(SyncedTimeSheet const& syncedTimeSheet,
+                     boost::gregorian::days fullResyncInterval,
+                     boost::gregorian::date today) -> bool;
+
+/**
+ * Stored entries created from the report start till the beginning of the
+ * fetched period combined with the fetched timesheet. Stored entries of the
+ * fetched period are replaced, so the deleted worklog is dropped.
+ */
+auto mergeSyncedTimeSheet(UserTimeSheet const& storedTimeSheet,
+                          boost::gregorian::date reportStart,
+                          boost::gregorian::date fetchedFrom,
+                          UserTimeSheet&& fetchedTimeSheet) -> UserTimeSheet;
+
+}  // namespace jwlrep
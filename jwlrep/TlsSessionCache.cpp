@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/Base64.h>
+#include <jwlrep/GeneralError.h>
+#include <jwlrep/Logger.h>
+#include <jwlrep/TlsSessionCache.h>
+
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <openssl/ssl.h>
+
+namespace {
+
+void freeSessionKey(void* /*parent*/, void* ptr, CRYPTO_EX_DATA* /*ad*/,
+                    int /*idx*/, long /*argl*/, void* /*argp*/) {
+  delete static_cast<std::string*>(ptr);  // NOLINT
+}
+
+/**
+ * Slot in SSL_CTX which points to the cache.
+ */
+auto cacheIndex() -> int {
+  static int const index =
+      SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  return index;
+}
+
+/**
+ * Slot in SSL which holds session key of the connection.
+ */
+auto sessionKeyIndex() -> int {
+  static int const index =
+      SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &freeSessionKey);
+  return index;
+}
+
+auto isUsable(SSL_SESSION const* session) -> bool {
+  auto const expiresAt = static_cast<std::time_t>(
+      SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session));
+  return SSL_SESSION_is_resumable(session) != 0 &&
+         expiresAt > std::time(nullptr);
+}
+
+}  // namespace
+
+namespace jwlrep {
+
+TlsSessionCache::TlsSessionCache(boost::asio::ssl::context& sslContext)
+    : sslContext_(sslContext) {
+  auto* const nativeContext = sslContext_.native_handle();
+  // Sessions are kept by this cache. OpenSSL internal store is useless on the
+  // client side since it is not looked up automatically.
+  SSL_CTX_set_session_cache_mode(
+      nativeContext, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_set_ex_data(nativeContext, cacheIndex(), this);
+  SSL_CTX_sess_set_new_cb(nativeContext, &TlsSessionCache::onNewSession);
+}
+
+TlsSessionCache::~TlsSessionCache() {
+  auto* const nativeContext = sslContext_.native_handle();
+  SSL_CTX_sess_set_new_cb(nativeContext, nullptr);
+  SSL_CTX_set_ex_data(nativeContext, cacheIndex(), nullptr);
+  for (auto& [key, session] : sessions_) {
+    SSL_SESSION_free(session);
+  }
+}
+
+void TlsSessionCache::prepare(SSL* ssl, std::string const& key) {
+  SSL_set_ex_data(ssl, sessionKeyIndex(),
+                  std::make_unique<std::string>(key).release());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto const it = sessions_.find(key);
+  if (it != sessions_.end() && isUsable(it->second)) {
+    SSL_set_session(ssl, it->second);
+  }
+}
+
+void TlsSessionCache::onHandshake(SSL* ssl) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (SSL_session_reused(ssl) != 0) {
+    ++stats_.resumed;
+  } else {
+    ++stats_.full;
+  }
+}
+
+auto TlsSessionCache::load(std::filesystem::path const& filePath)
+    -> std::error_code {
+  std::ifstream file(filePath);
+  if (!file) {
+    return GeneralError::SystemError;
+  }
+
+  std::string key;
+  std::string encodedSession;
+  std::size_t loadedCount = 0U;
+  while (file >> key >> encodedSession) {
+    auto const derOrError = base64Decode(encodedSession);
+    if (!derOrError) {
+      LOG_WARN("Skip malformed TLS session for {}", key);
+      continue;
+    }
+    auto const& der = derOrError.value();
+    // NOLINTNEXTLINE
+    auto const* derData = reinterpret_cast<unsigned char const*>(der.data());
+    auto* const session = d2i_SSL_SESSION(nullptr, &derData,
+                                          static_cast<long>(der.size()));
+    if (session == nullptr) {
+      LOG_WARN("Skip malformed TLS session for {}", key);
+      continue;
+    }
+    if (!isUsable(session)) {
+      SSL_SESSION_free(session);
+      continue;
+    }
+    store(key, session);
+    ++loadedCount;
+  }
+
+  LOG_DEBUG("Loaded {} TLS session(s) from {}", loadedCount,
+            filePath.string());
+  return GeneralError::Success;
+}
+
+auto TlsSessionCache::save(std::filesystem::path const& filePath) const
+    -> std::error_code {
+  std::ofstream file(filePath, std::ios::trunc);
+  if (!file) {
+    return GeneralError::SystemError;
+  }
+  // Sessions contain secrets which allow to decrypt the traffic.
+  std::error_code errorCode;
+  std::filesystem::permissions(filePath,
+                               std::filesystem::perms::owner_read |
+                                   std::filesystem::perms::owner_write,
+                               errorCode);
+  if (errorCode) {
+    LOG_WARN("Failed to restrict permissions of {}: {}", filePath.string(),
+             errorCode.message());
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto const& [key, session] : sessions_) {
+    if (!isUsable(session)) {
+      continue;
+    }
+    auto const derSize = i2d_SSL_SESSION(session, nullptr);
+    if (derSize <= 0) {
+      continue;
+    }
+    std::string der(static_cast<std::size_t>(derSize), '\0');
+    // NOLINTNEXTLINE
+    auto* derData = reinterpret_cast<unsigned char*>(der.data());
+    i2d_SSL_SESSION(session, &derData);
+    file << key << ' ' << base64Encode(der) << '\n';
+  }
+
+  return file ? GeneralError::Success : GeneralError::SystemError;
+}
+
+auto TlsSessionCache::stats() const -> Stats {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+auto TlsSessionCache::onNewSession(SSL* ssl, SSL_SESSION* session) -> int {
+  auto* const cache = static_cast<TlsSessionCache*>(
+      SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), cacheIndex()));
+  auto const* const key =
+      static_cast<std::string const*>(SSL_get_ex_data(ssl, sessionKeyIndex()));
+  if (cache == nullptr || key == nullptr) {
+    return 0;
+  }
+  cache->store(*key, session);
+  // Cache has taken the ownership of the session
+  return 1;
+}
+
+void TlsSessionCache::store(std::string const& key, SSL_SESSION* session) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& storedSession = sessions_[key];
+  if (storedSession != nullptr) {
+    SSL_SESSION_free(storedSession);
+  }
+  storedSession = session;
+}
+
+}  // namespace jwlrep
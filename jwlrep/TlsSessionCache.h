@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/Outcome.h>
+
+#include <boost/asio/ssl/context.hpp>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace jwlrep {
+
+/**
+ * Client side cache of TLS sessions keyed by "host:port". Allows to resume
+ * sessions (session ids or tickets, TLS 1.2 and TLS 1.3) instead of making
+ * full handshake for each new connection.
+ */
+class TlsSessionCache final {
+ public:
+  struct Stats {
+    std::size_t resumed{0U};
+
+    std::size_t full{0U};
+  };
+
+  /**
+   * Install the cache into the context. Context must outlive the cache.
+   */
+  explicit TlsSessionCache(boost::asio::ssl::context& sslContext);
+
+  TlsSessionCache(TlsSessionCache const&) = delete;
+  auto operator=(TlsSessionCache const&) -> TlsSessionCache& = delete;
+
+  ~TlsSessionCache();
+
+  /**
+   * Attach cached session (if any) to the connection. Must be called before
+   * handshake.
+   */
+  void prepare(SSL* ssl, std::string const& key);
+
+  /**
+   * Account result of the completed handshake.
+   */
+  void onHandshake(SSL* ssl);
+
+  /**
+   * Load sessions saved by the previous run. Expired sessions are skipped.
+   */
+  auto load(std::filesystem::path const& filePath) -> std::error_code;
+
+  auto save(std::filesystem::path const& filePath) const -> std::error_code;
+
+  [[nodiscard]] auto stats() const -> Stats;
+
+ private:
+  static auto onNewSession(SSL* ssl, SSL_SESSION* session) -> int;
+
+  void store(std::string const& key, SSL_SESSION* session);
+
+  boost::asio::ssl::context& sslContext_;
+
+  mutable std::mutex mutex_;
+
+  std::map<std::string, SSL_SESSION*> sessions_;
+
+  Stats stats_;
+};
+
+}  // namespace jwlrep
@@ -4,137 +4,554 @@
 
 #include <jwlrep/DateTimeUtil.h>
 #include <jwlrep/GeneralError.h>
-#include <jwlrep/JsonValidatorUtil.h>
 #include <jwlrep/Logger.h>
 #include <jwlrep/Worklog.h>
+#ifdef JWLREP_WITH_SIMDJSON
+#include <jwlrep/WorklogSimdjson.h>
+#endif
 
-#include <nlohmann/json-schema.hpp>
+#include <charconv>
+#include <cstdint>
+#include <iterator>
+#include <map>
 #include <nlohmann/json.hpp>
+#include <optional>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 
-namespace nlohmann {
-template <>
-struct adl_serializer<jwlrep::Entry> {
-  static auto from_json(json const& json) -> jwlrep::Entry {
-    return jwlrep::Entry{
-        std::chrono::seconds{json["timeSpent"].get<std::uint32_t>()},
-        json["author"].get<std::string>(),
-        jwlrep::dateTimeFromMSecSinceEpoch(
-            boost::posix_time::milliseconds(
-                json["created"].get<std::uint64_t>()))
-            .date()};
-    ;
+namespace {
+
+/**
+ * Some Jira versions report entry id as a string.
+ */
+auto parseId(std::string_view value) -> std::optional<std::uint64_t> {
+  std::uint64_t id = 0U;
+  auto const* const end = value.data() + value.size();
+  auto const [ptr, errorCode] = std::from_chars(value.data(), end, id);
+  if (errorCode != std::errc{} || ptr != end) {
+    return std::nullopt;
   }
-};
+  return id;
+}
+
+/**
+ * Input iterator over the characters of the chunks. Next chunk is requested
+ * when the current one is exhausted.
+ */
+class ChunkIterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = char;
+  using difference_type = std::ptrdiff_t;
+  using pointer = char const*;
+  using reference = char const&;
 
-template <>
-struct adl_serializer<jwlrep::Worklog> {
-  static auto from_json(json const& json) -> jwlrep::Worklog {
-    return jwlrep::Worklog{json["key"].get<std::string>(),
-                           json["summary"].get<std::string>(),
-                           json["entries"].get<std::vector<jwlrep::Entry>>()};
-    ;
+  ChunkIterator() = default;
+
+  explicit ChunkIterator(jwlrep::ChunkSource const& nextChunk)
+      : nextChunk_(&nextChunk) {
+    fetch();
+  }
+
+  auto operator*() const -> char const& { return chunk_.front(); }
+
+  auto operator++() -> ChunkIterator& {
+    chunk_.remove_prefix(1U);
+    if (chunk_.empty()) {
+      fetch();
+    }
+    return *this;
   }
-};
 
-template <>
-struct adl_serializer<jwlrep::UserTimeSheet> {
-  static auto from_json(json const& json) -> jwlrep::UserTimeSheet {
-    return jwlrep::UserTimeSheet{
-        json["worklog"].get<std::vector<jwlrep::Worklog>>()};
-    ;
+  auto operator==(ChunkIterator const& other) const -> bool {
+    return isEnd() == other.isEnd();
   }
+
+  auto operator!=(ChunkIterator const& other) const -> bool {
+    return !(*this == other);
+  }
+
+ private:
+  [[nodiscard]] auto isEnd() const -> bool { return nextChunk_ == nullptr; }
+
+  void fetch() {
+    chunk_ = (*nextChunk_)();
+    if (chunk_.empty()) {
+      nextChunk_ = nullptr;
+    }
+  }
+
+  jwlrep::ChunkSource const* nextChunk_{nullptr};
+
+  std::string_view chunk_;
 };
 
-}  // namespace nlohmann
+/**
+ * Builds UserTimeSheet directly from the parser events. Expected document:
+ * {"worklog": [{"key": "", "summary": "", "entries": [{"timeSpent": 0,
+ * "author": "", "created": 0, "id": 0}]}]}, id is optional. Unknown fields
+ * at any level are skipped without being stored.
+ */
+class UserTimeSheetSax final : public nlohmann::json_sax<nlohmann::json> {
+ public:
+  auto null() -> bool override { return onScalar(); }
 
-namespace {
+  auto boolean(bool /*value*/) -> bool override { return onScalar(); }
 
-auto isJsonValid(nlohmann::json const& json) -> bool {
-  auto const jsonSchema = R"(
-  {
-    "$schema": "http://json-schema.org/draft-07/schema#",
-    "type": "object",
-    "required": [
-      "worklog"
-    ],
-    "properties": {
-      "worklog": {
-        "type": "array",
-        "items": {
-          "type": "object",
-          "required": [
-            "key",
-            "summary",
-            "entries"
-          ],
-          "properties": {
-            "key": {
-              "type": "string"
-            },
-            "summary": {
-              "type": "string"
-            },
-            "entries": {
-              "type": "array",
-              "items": {
-                "type": "object",
-                "required": [
-                  "timeSpent",
-                  "author",
-                  "created"
-                ],
-                "properties": {
-                  "timeSpent": {
-                    "type": "number"
-                  },
-                  "author": {
-                    "type": "string"
-                  },
-                  "created": {
-                    "type": "number"
-                  }
-                }
-              }
-            }
-          }
+  auto number_integer(number_integer_t /*value*/) -> bool override {
+    // Only negative values are reported as integers
+    return onScalar();
+  }
+
+  auto number_unsigned(number_unsigned_t value) -> bool override {
+    if (isSkipping()) {
+      return onScalar();
+    }
+    if (level_ == Level::Entry && field_ == Field::TimeSpent) {
+      timeSpent_ = value;
+      return true;
+    }
+    if (level_ == Level::Entry && field_ == Field::Created) {
+      created_ = value;
+      return true;
+    }
+    if (level_ == Level::Entry && field_ == Field::Id) {
+      id_ = value;
+      return true;
+    }
+    return onScalar();
+  }
+
+  auto number_float(number_float_t value, string_t const& /*raw*/)
+      -> bool override {
+    if (!isSkipping() && value >= 0.0) {
+      return number_unsigned(static_cast<number_unsigned_t>(value));
+    }
+    return onScalar();
+  }
+
+  auto string(string_t& value) -> bool override {
+    if (isSkipping()) {
+      return onScalar();
+    }
+    if (level_ == Level::Worklog && field_ == Field::Key) {
+      key_ = std::move(value);
+      return true;
+    }
+    if (level_ == Level::Worklog && field_ == Field::Summary) {
+      summary_ = std::move(value);
+      return true;
+    }
+    if (level_ == Level::Entry && field_ == Field::Author) {
+      author_ = std::move(value);
+      return true;
+    }
+    if (level_ == Level::Entry && field_ == Field::Id) {
+      id_ = parseId(value);
+      return true;
+    }
+    return onScalar();
+  }
+
+  auto binary(binary_t& /*value*/) -> bool override { return onScalar(); }
+
+  auto start_object(std::size_t /*elements*/) -> bool override {
+    if (isSkipping() || isIdField()) {
+      skipNext_ = false;
+      ++skipDepth_;
+      return true;
+    }
+    switch (level_) {
+      case Level::Document:
+        level_ = Level::Root;
+        return true;
+      case Level::WorklogArray:
+        level_ = Level::Worklog;
+        key_.reset();
+        summary_.reset();
+        entries_.reset();
+        return true;
+      case Level::EntriesArray:
+        level_ = Level::Entry;
+        timeSpent_.reset();
+        author_.reset();
+        created_.reset();
+        id_.reset();
+        return true;
+      default:
+        return fail("unexpected object");
+    }
+  }
+
+  auto key(string_t& value) -> bool override {
+    if (skipDepth_ > 0U) {
+      return true;
+    }
+    field_ = toField(value);
+    skipNext_ = field_ == Field::Unknown;
+    return true;
+  }
+
+  auto end_object() -> bool override {
+    if (skipDepth_ > 0U) {
+      --skipDepth_;
+      return true;
+    }
+    switch (level_) {
+      case Level::Root:
+        level_ = Level::Done;
+        return worklog_ ? true : fail("missing worklog");
+      case Level::Worklog:
+        if (!key_ || !summary_ || !entries_) {
+          return fail("worklog misses key, summary or entries");
         }
-      }
+        worklog_->emplace_back(std::move(key_.value()),
+                               std::move(summary_.value()),
+                               std::move(entries_.value()));
+        level_ = Level::WorklogArray;
+        return true;
+      case Level::Entry:
+        if (!timeSpent_ || !author_ || !created_) {
+          return fail("entry misses timeSpent, author or created");
+        }
+        entries_->emplace_back(
+            std::chrono::seconds{timeSpent_.value()},
+            std::move(author_.value()),
+            jwlrep::dateTimeFromMSecSinceEpoch(
+                boost::posix_time::milliseconds(created_.value()))
+                .date(),
+            id_);
+        level_ = Level::EntriesArray;
+        return true;
+      default:
+        return fail("unexpected end of object");
     }
   }
-  )"_json;
 
-  static nlohmann::json_schema::json_validator const validator(
-      jsonSchema, nullptr, nlohmann::json_schema::default_string_format_check);
-  static jwlrep::JsonValidatorErrorHandler errorHandler;
-  validator.validate(json, errorHandler);
-  if (errorHandler) {
-    LOG_ERROR("Worklog validation has failed.");
+  auto start_array(std::size_t /*elements*/) -> bool override {
+    if (isSkipping() || isIdField()) {
+      skipNext_ = false;
+      ++skipDepth_;
+      return true;
+    }
+    if (level_ == Level::Root && field_ == Field::Worklog) {
+      level_ = Level::WorklogArray;
+      worklog_.emplace();
+      return true;
+    }
+    if (level_ == Level::Worklog && field_ == Field::Entries) {
+      level_ = Level::EntriesArray;
+      entries_.emplace();
+      return true;
+    }
+    return fail("unexpected array");
+  }
+
+  auto end_array() -> bool override {
+    if (skipDepth_ > 0U) {
+      --skipDepth_;
+      return true;
+    }
+    if (level_ == Level::WorklogArray) {
+      level_ = Level::Root;
+      return true;
+    }
+    if (level_ == Level::EntriesArray) {
+      level_ = Level::Worklog;
+      return true;
+    }
+    return fail("unexpected end of array");
+  }
+
+  auto parse_error(std::size_t position, std::string const& /*lastToken*/,
+                   nlohmann::detail::exception const& exception)
+      -> bool override {
+    return fail(fmt::format("{} at {}", exception.what(), position));
+  }
+
+  [[nodiscard]] auto error() const -> std::string const& { return error_; }
+
+  auto result() -> jwlrep::UserTimeSheet {
+    return jwlrep::UserTimeSheet{std::move(worklog_.value())};
+  }
+
+ private:
+  enum class Level {
+    Document,
+    Root,
+    WorklogArray,
+    Worklog,
+    EntriesArray,
+    Entry,
+    Done
+  };
+
+  enum class Field {
+    Unknown,
+    Worklog,
+    Key,
+    Summary,
+    Entries,
+    TimeSpent,
+    Author,
+    Created,
+    Id
+  };
+
+  [[nodiscard]] auto toField(std::string const& name) const -> Field {
+    switch (level_) {
+      case Level::Root:
+        return name == "worklog" ? Field::Worklog : Field::Unknown;
+      case Level::Worklog:
+        if (name == "key") {
+          return Field::Key;
+        }
+        if (name == "summary") {
+          return Field::Summary;
+        }
+        return name == "entries" ? Field::Entries : Field::Unknown;
+      case Level::Entry:
+        if (name == "timeSpent") {
+          return Field::TimeSpent;
+        }
+        if (name == "author") {
+          return Field::Author;
+        }
+        if (name == "id") {
+          return Field::Id;
+        }
+        return name == "created" ? Field::Created : Field::Unknown;
+      default:
+        return Field::Unknown;
+    }
+  }
+
+  [[nodiscard]] auto isSkipping() const -> bool {
+    return skipDepth_ > 0U || skipNext_;
+  }
+
+  [[nodiscard]] auto isIdField() const -> bool {
+    return level_ == Level::Entry && field_ == Field::Id;
+  }
+
+  /**
+   * Scalar is allowed only as a value of the skipped field.
+   */
+  auto onScalar() -> bool {
+    if (skipDepth_ > 0U) {
+      return true;
+    }
+    // Id is optional, value of unexpected type is ignored
+    if (isIdField()) {
+      return true;
+    }
+    if (skipNext_) {
+      skipNext_ = false;
+      return true;
+    }
+    return fail("unexpected value");
+  }
+
+  auto fail(std::string message) -> bool {
+    if (error_.empty()) {
+      error_ = std::move(message);
+    }
     return false;
   }
-  return true;
-}
+
+  Level level_{Level::Document};
+
+  Field field_{Field::Unknown};
+
+  /**
+   * Value of the unknown field is expected.
+   */
+  bool skipNext_{false};
+
+  /**
+   * Nesting level inside of the skipped value.
+   */
+  std::size_t skipDepth_{0U};
+
+  std::optional<std::vector<jwlrep::Worklog>> worklog_;
+
+  std::optional<std::string> key_;
+
+  std::optional<std::string> summary_;
+
+  std::optional<std::vector<jwlrep::Entry>> entries_;
+
+  std::optional<std::uint64_t> timeSpent_;
+
+  std::optional<std::string> author_;
+
+  std::optional<std::uint64_t> created_;
+
+  std::optional<std::uint64_t> id_;
+
+  std::string error_;
+};
 
 }  // namespace
 
 namespace jwlrep {
 using boost::gregorian::date;
 
-auto createUserTimeSheetFromJson(std::string const& userTimeSheetJsonStr)
+auto createUserTimeSheetFromJson(ChunkSource const& nextChunk)
     -> Expected<UserTimeSheet> {
-  auto const userTimeSheetJson =
-      nlohmann::json::parse(userTimeSheetJsonStr, nullptr, false, true);
-
-  if (userTimeSheetJson.is_discarded()) {
-    LOG_ERROR("Failed to parse worklog: json is not valid:\n{}",
-              userTimeSheetJsonStr);
+  UserTimeSheetSax sax;
+  auto const isParsed = nlohmann::json::sax_parse(
+      ChunkIterator{nextChunk}, ChunkIterator{}, &sax,
+      nlohmann::json::input_format_t::json, true, true);
+  if (!isParsed) {
+    LOG_ERROR("Failed to parse worklog: {}", sax.error());
     return make_error_code(std::errc::invalid_argument);
   }
+  return sax.result();
+}
 
-  if (!isJsonValid(userTimeSheetJson)) {
-    LOG_ERROR("Worklog json is not valid:\n{}", userTimeSheetJsonStr);
-    return make_error_code(std::errc::invalid_argument);
+auto createUserTimeSheetFromJson(ChunkSource const& nextChunk,
+                                 JsonParser jsonParser,
+                                 BodyBufferOptions const* bodyBufferOptions)
+    -> Expected<UserTimeSheet> {
+#ifdef JWLREP_WITH_SIMDJSON
+  if (jsonParser == JsonParser::Simdjson) {
+    return createUserTimeSheetFromJsonSimdjson(nextChunk, bodyBufferOptions);
   }
-  return userTimeSheetJson.get<UserTimeSheet>();
+#else
+  (void)jsonParser;
+  (void)bodyBufferOptions;
+#endif
+  return createUserTimeSheetFromJson(nextChunk);
+}
+
+auto isJsonParserAvailable(JsonParser jsonParser) -> bool {
+#ifdef JWLREP_WITH_SIMDJSON
+  return jsonParser == JsonParser::Nlohmann ||
+         jsonParser == JsonParser::Simdjson;
+#else
+  return jsonParser == JsonParser::Nlohmann;
+#endif
+}
+
+auto createUserTimeSheetFromJson(std::string_view userTimeSheetJsonStr)
+    -> Expected<UserTimeSheet> {
+  auto isConsumed = false;
+  return createUserTimeSheetFromJson([&]() {
+    if (isConsumed) {
+      return std::string_view{};
+    }
+    isConsumed = true;
+    return userTimeSheetJsonStr;
+  });
+}
+
+auto mergeUserTimeSheets(std::vector<UserTimeSheet>&& parts) -> UserTimeSheet {
+  if (parts.size() == 1U) {
+    return std::move(parts.front());
+  }
+
+  struct MergedWorklog {
+    std::string const* key;
+    std::string const* summary;
+    std::vector<Entry> entries;
+  };
+  std::vector<MergedWorklog> mergedWorklog;
+  std::unordered_map<std::string_view, std::size_t> worklogIndexByKey;
+
+  // Entry ids are unique across all issues
+  std::unordered_set<std::uint64_t> seenIds;
+  // Entries without id are told apart by their content. Equal entries of the
+  // same part are different records.
+  using EntryContent =
+      std::tuple<std::string_view, std::string_view, date, std::int64_t>;
+  std::map<EntryContent, std::size_t> partIndexByContent;
+
+  for (auto partIndex = 0U; partIndex < parts.size(); ++partIndex) {
+    for (auto const& worklog : parts[partIndex].worklog()) {
+      auto const [it, isInserted] =
+          worklogIndexByKey.emplace(worklog.key(), mergedWorklog.size());
+      if (isInserted) {
+        mergedWorklog.push_back({&worklog.key(), &worklog.summary(), {}});
+      }
+      auto& entries = mergedWorklog[it->second].entries;
+      for (auto const& entry : worklog.entries()) {
+        if (entry.id()) {
+          if (!seenIds.insert(entry.id().value()).second) {
+            continue;
+          }
+        } else {
+          auto const [contentIt, isNew] = partIndexByContent.emplace(
+              EntryContent{worklog.key(), entry.author(), entry.created(),
+                           entry.timeSpent().count()},
+              partIndex);
+          if (!isNew && contentIt->second != partIndex) {
+            continue;
+          }
+        }
+        entries.push_back(entry);
+      }
+    }
+  }
+
+  std::vector<Worklog> worklog;
+  worklog.reserve(mergedWorklog.size());
+  for (auto& merged : mergedWorklog) {
+    worklog.emplace_back(*merged.key, *merged.summary,
+                         std::move(merged.entries));
+  }
+  return UserTimeSheet{std::move(worklog)};
+}
+
+auto splitUserTimeSheet(UserTimeSheet const& combined)
+    -> std::unordered_map<std::string, UserTimeSheet> {
+  std::unordered_map<std::string, std::vector<Worklog>> worklogByAuthor;
+  for (auto const& worklog : combined.worklog()) {
+    std::unordered_map<std::string_view, std::vector<Entry>> entriesByAuthor;
+    std::vector<std::string_view> authors;
+    for (auto const& entry : worklog.entries()) {
+      auto& entries = entriesByAuthor[entry.author()];
+      if (entries.empty()) {
+        authors.push_back(entry.author());
+      }
+      entries.push_back(entry);
+    }
+    for (auto const author : authors) {
+      worklogByAuthor[std::string{author}].emplace_back(
+          worklog.key(), worklog.summary(),
+          std::move(entriesByAuthor[author]));
+    }
+  }
+
+  std::unordered_map<std::string, UserTimeSheet> timeSheets;
+  for (auto& [author, worklog] : worklogByAuthor) {
+    timeSheets.emplace(author, UserTimeSheet{std::move(worklog)});
+  }
+  return timeSheets;
+}
+
+auto userTimeSheetToJson(UserTimeSheet const& userTimeSheet) -> std::string {
+  static date const epoch{1970, 1, 1};
+  auto const kMSecsInDay = std::int64_t{24 * 60 * 60 * 1000};
+  auto worklogJson = nlohmann::json::array();
+  for (auto const& worklog : userTimeSheet.worklog()) {
+    auto entriesJson = nlohmann::json::array();
+    for (auto const& entry : worklog.entries()) {
+      nlohmann::json entryJson{
+          {"timeSpent", entry.timeSpent().count()},
+          {"author", entry.author()},
+          {"created", (entry.created() - epoch).days() * kMSecsInDay}};
+      if (entry.id()) {
+        entryJson["id"] = entry.id().value();
+      }
+      entriesJson.push_back(std::move(entryJson));
+    }
+    worklogJson.push_back({{"key", worklog.key()},
+                           {"summary", worklog.summary()},
+                           {"entries", std::move(entriesJson)}});
+  }
+  return nlohmann::json{{"worklog", std::move(worklogJson)}}.dump();
 }
 
 Worklog::Worklog(std::string key, std::string summary,
@@ -150,8 +567,11 @@ auto Worklog::summary() const -> std::string const& { return summary_; }
 auto Worklog::entries() const -> std::vector<Entry> const& { return entries_; }
 
 Entry::Entry(std::chrono::seconds timeSpent, std::string author,
-             boost::gregorian::date created)
-    : timeSpent_(timeSpent), author_(std::move(author)), created_(created) {}
+             boost::gregorian::date created, std::optional<std::uint64_t> id)
+    : timeSpent_(timeSpent),
+      author_(std::move(author)),
+      created_(created),
+      id_(id) {}
 
 auto Entry::timeSpent() const -> std::chrono::seconds const& {
   return timeSpent_;
@@ -161,6 +581,8 @@ auto Entry::author() const -> std::string const& { return author_; }
 
 auto Entry::created() const -> date const& { return created_; }
 
+auto Entry::id() const -> std::optional<std::uint64_t> const& { return id_; }
+
 UserTimeSheet::UserTimeSheet(std::vector<Worklog>&& worklog)
     : worklog_(std::move(worklog)) {}
 
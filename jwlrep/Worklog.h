@@ -4,18 +4,26 @@
 
 #pragma once
 
+#include <jwlrep/ChunkSource.h>
 #include <jwlrep/Outcome.h>
 
 #include <boost/date_time/gregorian/gregorian.hpp>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace jwlrep {
 
+class BodyBufferOptions;
+
 class Entry {
  public:
   Entry(std::chrono::seconds timeSpent, std::string author,
-        boost::gregorian::date created);
+        boost::gregorian::date created,
+        std::optional<std::uint64_t> id = std::nullopt);
 
   [[nodiscard]] auto timeSpent() const -> std::chrono::seconds const&;
 
@@ -23,12 +31,19 @@ class Entry {
 
   [[nodiscard]] auto created() const -> boost::gregorian::date const&;
 
+  /**
+   * Jira id of the worklog entry if it has been reported.
+   */
+  [[nodiscard]] auto id() const -> std::optional<std::uint64_t> const&;
+
  private:
   std::chrono::seconds timeSpent_;
 
   std::string author_;
 
   boost::gregorian::date created_;
+
+  std::optional<std::uint64_t> id_;
 };
 
 class Worklog {
@@ -51,6 +66,11 @@ class Worklog {
 
 class UserTimeSheet {
  public:
+  /**
+   * Empty timesheet. Required to pass it over the channel.
+   */
+  UserTimeSheet() = default;
+
   explicit UserTimeSheet(std::vector<Worklog>&& worklog);
 
   [[nodiscard]] auto worklog() const -> std::vector<Worklog> const&;
@@ -61,7 +81,64 @@ class UserTimeSheet {
 
 using TimeSheets = std::vector<UserTimeSheet>;
 
-auto createUserTimeSheetFromJson(std::string const& userTimeSheetJsonStr)
+/**
+ * Backend of the timesheet parser.
+ */
+enum class JsonParser {
+  /**
+   * Streaming SAX parser. Always available. Document is not accumulated.
+   */
+  Nlohmann,
+  /**
+   * simdjson On Demand parser. Available if built with JWLREP_WITH_SIMDJSON.
+   * Whole document is accumulated before parsing, the one which exceeds the
+   * memory budget is spilled to the temporary file. Internal buffers of the
+   * parser are sized by the document and are not limited by the budget.
+   */
+  Simdjson
+};
+
+[[nodiscard]] auto isJsonParserAvailable(JsonParser jsonParser) -> bool;
+
+/**
+ * Parse user timesheet in a single pass while chunks are arriving. Required
+ * fields are checked during parsing, unknown fields are skipped.
+ */
+auto createUserTimeSheetFromJson(ChunkSource const& nextChunk)
+    -> Expected<UserTimeSheet>;
+
+auto createUserTimeSheetFromJson(std::string_view userTimeSheetJsonStr)
+    -> Expected<UserTimeSheet>;
+
+/**
+ * Combine timesheets of the same user for the adjacent periods. Worklogs of
+ * the same issue are merged, duplicated entries are dropped: entries with the
+ * same id or, if id is unknown, equal entries reported by different parts.
+ * Order of the first appearance is kept.
+ */
+auto mergeUserTimeSheets(std::vector<UserTimeSheet>&& parts) -> UserTimeSheet;
+
+/**
+ * Split timesheet of several users by the entry author. Order of the
+ * worklog is kept for each of them.
+ */
+auto splitUserTimeSheet(UserTimeSheet const& combined)
+    -> std::unordered_map<std::string, UserTimeSheet>;
+
+/**
+ * Document which is read back by createUserTimeSheetFromJson. Entries are
+ * written as created at midnight UTC of their day.
+ */
+auto userTimeSheetToJson(UserTimeSheet const& userTimeSheet) -> std::string;
+
+/**
+ * Parse user timesheet with the given backend. Falls back to Nlohmann if the
+ * backend is not available. Body buffer options limit the memory of the
+ * document accumulated by the backend, defaults are used if not given.
+ */
+auto createUserTimeSheetFromJson(
+    ChunkSource const& nextChunk, JsonParser jsonParser,
+    BodyBufferOptions const* bodyBufferOptions = nullptr)
     -> Expected<UserTimeSheet>;
 
 }  // namespace jwlrep
\ No newline at end of file
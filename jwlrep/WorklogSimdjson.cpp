@@ -0,0 +1,309 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/DateTimeUtil.h>
+#include <jwlrep/Logger.h>
+#include <jwlrep/SpillBuffer.h>
+#include <jwlrep/WorklogSimdjson.h>
+
+#include <charconv>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <simdjson.h>
+#include <string>
+#include <system_error>
+
+namespace {
+
+namespace ondemand = simdjson::ondemand;
+
+/**
+ * Capacity of the parser which is kept between the documents if the memory
+ * budget is not given.
+ */
+auto const kDefaultReusedParserCapacity = std::size_t{16U * 1024U * 1024U};
+
+/**
+ * Non-negative number. Fractional part is dropped.
+ */
+auto getUnsigned(ondemand::value value, std::uint64_t& result)
+    -> simdjson::error_code {
+  ondemand::number number;
+  if (auto const error = value.get_number().get(number)) {
+    return error;
+  }
+  switch (number.get_number_type()) {
+    case ondemand::number_type::unsigned_integer:
+      result = number.get_uint64();
+      return simdjson::SUCCESS;
+    // Integers which fit int64 are reported as signed
+    case ondemand::number_type::signed_integer:
+      if (number.get_int64() < 0) {
+        return simdjson::INCORRECT_TYPE;
+      }
+      result = static_cast<std::uint64_t>(number.get_int64());
+      return simdjson::SUCCESS;
+    case ondemand::number_type::floating_point_number:
+      if (number.get_double() < 0.0) {
+        return simdjson::INCORRECT_TYPE;
+      }
+      result = static_cast<std::uint64_t>(number.get_double());
+      return simdjson::SUCCESS;
+    default:
+      return simdjson::INCORRECT_TYPE;
+  }
+}
+
+auto getString(ondemand::value value, std::optional<std::string>& result)
+    -> simdjson::error_code {
+  std::string_view view;
+  if (auto const error = value.get_string().get(view)) {
+    return error;
+  }
+  result.emplace(view);
+  return simdjson::SUCCESS;
+}
+
+/**
+ * Id is optional. It might be reported as a string, value of unexpected type
+ * is ignored.
+ */
+auto getId(ondemand::value value) -> std::optional<std::uint64_t> {
+  ondemand::json_type type;
+  if (value.type().get(type) != simdjson::SUCCESS) {
+    return std::nullopt;
+  }
+  std::uint64_t id = 0U;
+  if (type == ondemand::json_type::number) {
+    if (getUnsigned(value, id) != simdjson::SUCCESS) {
+      return std::nullopt;
+    }
+    return id;
+  }
+  std::string_view idStr;
+  if (type != ondemand::json_type::string ||
+      value.get_string().get(idStr) != simdjson::SUCCESS) {
+    return std::nullopt;
+  }
+  auto const* const end = idStr.data() + idStr.size();
+  auto const [ptr, errorCode] = std::from_chars(idStr.data(), end, id);
+  if (errorCode != std::errc{} || ptr != end) {
+    return std::nullopt;
+  }
+  return id;
+}
+
+auto parseEntries(ondemand::array entriesArray,
+                  std::vector<jwlrep::Entry>& entries)
+    -> simdjson::error_code {
+  for (auto entryValue : entriesArray) {
+    ondemand::object entryObject;
+    if (auto const error = entryValue.get_object().get(entryObject)) {
+      return error;
+    }
+
+    std::optional<std::uint64_t> timeSpent;
+    std::optional<std::string> author;
+    std::optional<std::uint64_t> created;
+    std::optional<std::uint64_t> id;
+    for (auto field : entryObject) {
+      std::string_view key;
+      if (auto const error = field.unescaped_key().get(key)) {
+        return error;
+      }
+      // Values of unknown fields are skipped by the parser
+      auto error = simdjson::SUCCESS;
+      if (key == "timeSpent") {
+        error = getUnsigned(field.value(), timeSpent.emplace());
+      } else if (key == "author") {
+        error = getString(field.value(), author);
+      } else if (key == "created") {
+        error = getUnsigned(field.value(), created.emplace());
+      } else if (key == "id") {
+        id = getId(field.value());
+      }
+      if (error) {
+        return error;
+      }
+    }
+    if (!timeSpent || !author || !created) {
+      return simdjson::NO_SUCH_FIELD;
+    }
+
+    entries.emplace_back(std::chrono::seconds{timeSpent.value()},
+                         std::move(author.value()),
+                         jwlrep::dateTimeFromMSecSinceEpoch(
+                             boost::posix_time::milliseconds(created.value()))
+                             .date(),
+                         id);
+  }
+  return simdjson::SUCCESS;
+}
+
+auto parseWorklog(ondemand::array worklogArray,
+                  std::vector<jwlrep::Worklog>& worklog)
+    -> simdjson::error_code {
+  for (auto worklogValue : worklogArray) {
+    ondemand::object worklogObject;
+    if (auto const error = worklogValue.get_object().get(worklogObject)) {
+      return error;
+    }
+
+    std::optional<std::string> key;
+    std::optional<std::string> summary;
+    std::optional<std::vector<jwlrep::Entry>> entries;
+    for (auto field : worklogObject) {
+      std::string_view fieldKey;
+      if (auto const error = field.unescaped_key().get(fieldKey)) {
+        return error;
+      }
+      auto error = simdjson::SUCCESS;
+      if (fieldKey == "key") {
+        error = getString(field.value(), key);
+      } else if (fieldKey == "summary") {
+        error = getString(field.value(), summary);
+      } else if (fieldKey == "entries") {
+        ondemand::array entriesArray;
+        error = field.value().get_array().get(entriesArray);
+        if (!error) {
+          error = parseEntries(entriesArray, entries.emplace());
+        }
+      }
+      if (error) {
+        return error;
+      }
+    }
+    if (!key || !summary || !entries) {
+      return simdjson::NO_SUCH_FIELD;
+    }
+
+    worklog.emplace_back(std::move(key.value()), std::move(summary.value()),
+                         std::move(entries.value()));
+  }
+  return simdjson::SUCCESS;
+}
+
+auto parseUserTimeSheet(ondemand::parser& parser,
+                        simdjson::padded_string_view json,
+                        std::vector<jwlrep::Worklog>& worklog)
+    -> simdjson::error_code {
+  ondemand::document document;
+  if (auto const error = parser.iterate(json).get(document)) {
+    return error;
+  }
+  ondemand::object rootObject;
+  if (auto const error = document.get_object().get(rootObject)) {
+    return error;
+  }
+
+  auto isWorklogFound = false;
+  for (auto field : rootObject) {
+    std::string_view key;
+    if (auto const error = field.unescaped_key().get(key)) {
+      return error;
+    }
+    if (key != "worklog") {
+      continue;
+    }
+    ondemand::array worklogArray;
+    if (auto const error = field.value().get_array().get(worklogArray)) {
+      return error;
+    }
+    if (auto const error = parseWorklog(worklogArray, worklog)) {
+      return error;
+    }
+    isWorklogFound = true;
+  }
+  if (!isWorklogFound) {
+    return simdjson::NO_SUCH_FIELD;
+  }
+  // Trailing content is not allowed
+  return document.at_end() ? simdjson::SUCCESS : simdjson::TRAILING_CONTENT;
+}
+
+auto checkDocumentSize(std::size_t size) -> std::error_code {
+  if (size <= simdjson::SIMDJSON_MAXSIZE_BYTES) {
+    return {};
+  }
+  LOG_ERROR("Worklog of {} bytes exceeds simdjson limit of {} bytes", size,
+            simdjson::SIMDJSON_MAXSIZE_BYTES);
+  return make_error_code(std::errc::value_too_large);
+}
+
+/**
+ * Parser keeps internal buffers sized by the largest document, so it is
+ * reused only for the documents which fit reusedParserCapacity. Buffers of
+ * the larger ones are freed right after parsing.
+ */
+auto parsePadded(simdjson::padded_string_view json,
+                 std::size_t reusedParserCapacity)
+    -> jwlrep::Expected<jwlrep::UserTimeSheet> {
+  std::vector<jwlrep::Worklog> worklog;
+  simdjson::error_code error = simdjson::SUCCESS;
+  if (json.length() <= reusedParserCapacity) {
+    thread_local ondemand::parser parser;
+    error = parseUserTimeSheet(parser, json, worklog);
+  } else {
+    ondemand::parser parser;
+    error = parseUserTimeSheet(parser, json, worklog);
+  }
+  if (error) {
+    LOG_ERROR("Failed to parse worklog: {}", simdjson::error_message(error));
+    return make_error_code(std::errc::invalid_argument);
+  }
+  return jwlrep::UserTimeSheet{std::move(worklog)};
+}
+
+}  // namespace
+
+namespace jwlrep {
+
+auto createUserTimeSheetFromJsonSimdjson(
+    ChunkSource const& nextChunk, BodyBufferOptions const* bodyBufferOptions)
+    -> Expected<UserTimeSheet> {
+  auto memoryBudget = std::numeric_limits<std::size_t>::max();
+  auto reusedParserCapacity = kDefaultReusedParserCapacity;
+  std::filesystem::path spillDirectory;
+  if (bodyBufferOptions != nullptr) {
+    memoryBudget = bodyBufferOptions->memoryBudget();
+    reusedParserCapacity = memoryBudget;
+    spillDirectory = bodyBufferOptions->spillDirectory();
+  }
+
+  SpillBuffer buffer{memoryBudget, std::move(spillDirectory),
+                     simdjson::SIMDJSON_PADDING};
+  for (auto chunk = nextChunk(); !chunk.empty(); chunk = nextChunk()) {
+    // Document which can't be parsed is not accumulated
+    auto errorCode = checkDocumentSize(buffer.size() + chunk.size());
+    if (errorCode) {
+      return errorCode;
+    }
+    errorCode = buffer.append(chunk);
+    if (errorCode) {
+      return errorCode;
+    }
+  }
+  auto const jsonOrError = buffer.view();
+  if (!jsonOrError) {
+    return jsonOrError.error();
+  }
+  auto const json = jsonOrError.value();
+  return parsePadded(
+      simdjson::padded_string_view(json.data(), json.size(),
+                                   json.size() + simdjson::SIMDJSON_PADDING),
+      reusedParserCapacity);
+}
+
+auto createUserTimeSheetFromJsonSimdjson(std::string_view userTimeSheetJsonStr)
+    -> Expected<UserTimeSheet> {
+  if (auto const errorCode = checkDocumentSize(userTimeSheetJsonStr.size())) {
+    return errorCode;
+  }
+  simdjson::padded_string const json(userTimeSheetJsonStr);
+  return parsePadded(json, kDefaultReusedParserCapacity);
+}
+
+}  // namespace jwlrep
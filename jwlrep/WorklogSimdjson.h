@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#pragma once
+
+#include <jwlrep/ChunkSource.h>
+#include <jwlrep/Outcome.h>
+#include <jwlrep/Worklog.h>
+
+#include <string_view>
+
+namespace jwlrep {
+
+class BodyBufferOptions;
+
+/**
+ * Parse user timesheet with simdjson On Demand API. Produces the same result
+ * as the SAX parser. Chunks are accumulated into the padded buffer first.
+ * Document which exceeds the memory budget is spilled to the temporary file
+ * and parsed from its memory-mapped view. Document over simdjson size limit
+ * (4 GiB) is rejected with value_too_large before being accumulated.
+ */
+auto createUserTimeSheetFromJsonSimdjson(
+    ChunkSource const& nextChunk,
+    BodyBufferOptions const* bodyBufferOptions = nullptr)
+    -> Expected<UserTimeSheet>;
+
+auto createUserTimeSheetFromJsonSimdjson(std::string_view userTimeSheetJsonStr)
+    -> Expected<UserTimeSheet>;
+
+}  // namespace jwlrep
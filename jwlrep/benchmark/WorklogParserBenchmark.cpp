@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/Worklog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <string>
+#include <string_view>
+
+namespace {
+
+auto const kBytesPerMB = 1024.0 * 1024.0;
+auto const kDefaultSizeMB = 16U;
+auto const kRunsCount = 5U;
+
+/**
+ * Same chunk size as the network body buffer.
+ */
+auto const kChunkSize = 64U * 1024U;
+
+/**
+ * Timesheet which looks like Jira response: known fields are mixed with the
+ * unknown ones which parser must skip.
+ */
+auto generateTimeSheet(std::size_t sizeBytes) -> std::string {
+  std::string json = R"({"startDate": 1604181600000, "worklog": [)";
+  for (auto issue = 0U; json.size() < sizeBytes; ++issue) {
+    if (issue != 0U) {
+      json += ',';
+    }
+    json += fmt::format(
+        R"({{"key": "PRJ-{0}", "summary": "Summary of the issue {0}", )"
+        R"("fields": [{{"label": "x", "value": [1, null]}}], "entries": [)",
+        issue);
+    auto const kEntriesPerIssue = 20U;
+    for (auto entry = 0U; entry < kEntriesPerIssue; ++entry) {
+      json += fmt::format(
+          R"({}{{"id": {}, "comment": "Work on the issue {}", )"
+          R"("timeSpent": {}, "author": "user{}", "created": {}}})",
+          entry == 0U ? "" : ",", issue * kEntriesPerIssue + entry, issue,
+          (entry + 1U) * 900U, entry % 7U, 1604507259177ULL + entry * 1000U);
+    }
+    json += "]}";
+  }
+  json += "]}";
+  return json;
+}
+
+auto parse(std::string_view json, jwlrep::JsonParser jsonParser)
+    -> jwlrep::Expected<jwlrep::UserTimeSheet> {
+  return jwlrep::createUserTimeSheetFromJson(
+      [rest = json]() mutable {
+        auto const chunk = rest.substr(0U, kChunkSize);
+        rest.remove_prefix(chunk.size());
+        return chunk;
+      },
+      jsonParser);
+}
+
+auto isSame(jwlrep::UserTimeSheet const& lhs, jwlrep::UserTimeSheet const& rhs)
+    -> bool {
+  auto const isSameEntry = [](auto const& lhsEntry, auto const& rhsEntry) {
+    return lhsEntry.timeSpent() == rhsEntry.timeSpent() &&
+           lhsEntry.author() == rhsEntry.author() &&
+           lhsEntry.created() == rhsEntry.created();
+  };
+  auto const isSameWorklog = [&](auto const& lhsWorklog,
+                                 auto const& rhsWorklog) {
+    return lhsWorklog.key() == rhsWorklog.key() &&
+           lhsWorklog.summary() == rhsWorklog.summary() &&
+           std::equal(lhsWorklog.entries().begin(), lhsWorklog.entries().end(),
+                      rhsWorklog.entries().begin(), rhsWorklog.entries().end(),
+                      isSameEntry);
+  };
+  return std::equal(lhs.worklog().begin(), lhs.worklog().end(),
+                    rhs.worklog().begin(), rhs.worklog().end(), isSameWorklog);
+}
+
+/**
+ * Best time of several runs.
+ */
+auto measure(std::string_view json, jwlrep::JsonParser jsonParser)
+    -> std::chrono::duration<double> {
+  auto best = std::chrono::duration<double>::max();
+  for (auto run = 0U; run < kRunsCount; ++run) {
+    auto const startedAt = std::chrono::steady_clock::now();
+    auto const userTimeSheetOrError = parse(json, jsonParser);
+    auto const elapsed = std::chrono::steady_clock::now() - startedAt;
+    if (!userTimeSheetOrError) {
+      return std::chrono::duration<double>::zero();
+    }
+    best = std::min<std::chrono::duration<double>>(best, elapsed);
+  }
+  return best;
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+  auto const sizeMB = argc > 1 ? std::strtoul(argv[1], nullptr, 10)  // NOLINT
+                               : kDefaultSizeMB;
+  auto const json =
+      generateTimeSheet(static_cast<std::size_t>(sizeMB * kBytesPerMB));
+  fmt::print("Timesheet size: {:.1f} MB\n",
+             static_cast<double>(json.size()) / kBytesPerMB);
+
+  auto const nlohmannOrError = parse(json, jwlrep::JsonParser::Nlohmann);
+  auto const simdjsonOrError = parse(json, jwlrep::JsonParser::Simdjson);
+  if (!nlohmannOrError || !simdjsonOrError) {
+    fmt::print("Failed to parse timesheet\n");
+    return EXIT_FAILURE;
+  }
+  if (!isSame(nlohmannOrError.value(), simdjsonOrError.value())) {
+    fmt::print("Parsers give different timesheets\n");
+    return EXIT_FAILURE;
+  }
+
+  for (auto const jsonParser :
+       {jwlrep::JsonParser::Nlohmann, jwlrep::JsonParser::Simdjson}) {
+    auto const elapsed = measure(json, jsonParser);
+    fmt::print("{:>8}: {:8.1f} ms {:8.1f} MB/s\n",
+               jsonParser == jwlrep::JsonParser::Nlohmann ? "nlohmann"
+                                                          : "simdjson",
+               elapsed.count() * 1000.0,
+               static_cast<double>(json.size()) / kBytesPerMB /
+                   elapsed.count());
+  }
+  return EXIT_SUCCESS;
+}
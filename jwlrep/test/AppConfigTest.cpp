@@ -30,6 +30,8 @@ TEST_CASE("Valid config", "[AppConfig]") {
           "https");
   REQUIRE(appConfigOrError.value().credentials().serverUrl().host() ==
           "my.server.com");
+  REQUIRE(appConfigOrError.value().credentials().authMode() ==
+          jwlrep::AuthMode::Basic);
   REQUIRE(appConfigOrError.value().options().dateStart().year() == 2020);
   REQUIRE(appConfigOrError.value().options().dateStart().month() == 11);
   REQUIRE(appConfigOrError.value().options().dateStart().day() == 21);
@@ -38,6 +40,272 @@ TEST_CASE("Valid config", "[AppConfig]") {
   REQUIRE(appConfigOrError.value().options().dateEnd().day() == 23);
   REQUIRE(appConfigOrError.value().options().defaultAssociation() == "SOP");
   REQUIRE(appConfigOrError.value().options().associations().size() == 2);
+  REQUIRE(appConfigOrError.value().options().jsonParser() ==
+          jwlrep::JsonParser::Nlohmann);
+  REQUIRE(appConfigOrError.value().options().cpuThreads() == 1U);
+  REQUIRE(appConfigOrError.value().options().dataSource() ==
+          jwlrep::DataSource::TimesheetGadget);
+}
+
+TEST_CASE("Parsing options", "[AppConfig]") {
+  const auto *const config = R"(
+    {
+      "credentials": {
+        "serverUrl":"https://my.server.com",
+        "userName":"LOGIN",
+        "password":"PASSWORD"
+      },
+      "options": {
+        "dateStart": "2020-11-21",
+        "dateEnd": "2020-12-23",
+        "users": ["User1", "User2"],
+        "defaultAssociation": "SOP",
+        "associations": {"[Common]": "Common", "[Arch]": "Non-SOP"},
+        "jsonParser": "simdjson",
+        "cpuThreads": 2,
+        "dataSource": "restApi"
+      }
+    }
+  )";
+  auto const appConfigOrError = jwlrep::createAppConfigFromJson(config);
+  REQUIRE(appConfigOrError.has_value());
+  REQUIRE(appConfigOrError.value().options().jsonParser() ==
+          jwlrep::JsonParser::Simdjson);
+  REQUIRE(appConfigOrError.value().options().cpuThreads() == 2U);
+  REQUIRE(appConfigOrError.value().options().dataSource() ==
+          jwlrep::DataSource::RestApi);
+}
+
+TEST_CASE("Parsing credentials", "[AppConfig]") {
+  const auto *const config = R"(
+    {
+      "credentials": {
+        "serverUrl":"https://my.server.com",
+        "userName":"LOGIN",
+        "password":"",
+        "authMode":"token",
+        "token":"TOKEN"
+      },
+      "options": {
+        "dateStart": "2020-11-21",
+        "dateEnd": "2020-12-23",
+        "users": ["User1", "User2"],
+        "defaultAssociation": "SOP",
+        "associations": {"[Common]": "Common", "[Arch]": "Non-SOP"}
+      }
+    }
+  )";
+  auto const appConfigOrError = jwlrep::createAppConfigFromJson(config);
+  REQUIRE(appConfigOrError.has_value());
+  REQUIRE(appConfigOrError.value().credentials().authMode() ==
+          jwlrep::AuthMode::Token);
+  REQUIRE(appConfigOrError.value().credentials().token() == "TOKEN");
+}
+
+TEST_CASE("Network options are optional", "[AppConfig]") {
+  const auto *const config = R"(
+    {
+      "credentials": {
+        "serverUrl":"https://my.server.com",
+        "userName":"LOGIN",
+        "password":"PASSWORD"
+      },
+      "options": {
+        "dateStart": "2020-11-21",
+        "dateEnd": "2020-12-23",
+        "users": ["User1", "User2"],
+        "defaultAssociation": "SOP",
+        "associations": {"[Common]": "Common", "[Arch]": "Non-SOP"}
+      }
+    }
+  )";
+  auto const appConfigOrError = jwlrep::createAppConfigFromJson(config);
+  REQUIRE(appConfigOrError.has_value());
+  auto const &connectionPool =
+      appConfigOrError.value().network().connectionPool();
+  REQUIRE(connectionPool.maxSize() > 0U);
+  REQUIRE(connectionPool.idleTimeout().count() > 0);
+  REQUIRE(connectionPool.connectAttemptDelay().count() > 0);
+  auto const &tlsSessionCache =
+      appConfigOrError.value().network().tlsSessionCache();
+  REQUIRE(tlsSessionCache.enabled());
+  REQUIRE(tlsSessionCache.filePath().empty());
+  REQUIRE(appConfigOrError.value().network().maxParallelRequests() > 0U);
+  auto const &adaptiveConcurrency =
+      appConfigOrError.value().network().adaptiveConcurrency();
+  REQUIRE(!adaptiveConcurrency.enabled());
+  REQUIRE(adaptiveConcurrency.minLimit() > 0U);
+  REQUIRE(adaptiveConcurrency.initialLimit() >= adaptiveConcurrency.minLimit());
+  auto const &retry = appConfigOrError.value().network().retry();
+  REQUIRE(retry.maxAttempts() > 1U);
+  REQUIRE(retry.attemptTimeout() <= retry.totalTimeout());
+  REQUIRE(retry.baseDelay() <= retry.maxDelay());
+  auto const &hedging = appConfigOrError.value().network().hedging();
+  REQUIRE(!hedging.enabled());
+  REQUIRE(hedging.maxHedgeRatio() < 1.0);
+  auto const &dateRangeChunking =
+      appConfigOrError.value().network().dateRangeChunking();
+  REQUIRE(!dateRangeChunking.enabled());
+  REQUIRE(dateRangeChunking.minDays() <= dateRangeChunking.initialDays());
+  REQUIRE(dateRangeChunking.initialDays() <= dateRangeChunking.maxDays());
+  REQUIRE(dateRangeChunking.targetResponseSize() > 0U);
+  REQUIRE(appConfigOrError.value().network().threads() == 1U);
+  auto const &dnsCache = appConfigOrError.value().network().dnsCache();
+  REQUIRE(dnsCache.enabled());
+  REQUIRE(dnsCache.ttl().count() > 0);
+  REQUIRE(dnsCache.filePath().empty());
+  REQUIRE(appConfigOrError.value().network().timingFilePath().empty());
+  auto const &responseCache =
+      appConfigOrError.value().network().responseCache();
+  REQUIRE(!responseCache.enabled());
+  REQUIRE(!responseCache.directoryPath().empty());
+  REQUIRE(responseCache.maxSize() > 0U);
+  REQUIRE(!responseCache.trustClosedRanges());
+  auto const &incrementalSync =
+      appConfigOrError.value().network().incrementalSync();
+  REQUIRE(!incrementalSync.enabled());
+  REQUIRE(!incrementalSync.filePath().empty());
+  REQUIRE(incrementalSync.overlap().days() > 0);
+  REQUIRE(incrementalSync.fullResyncInterval().days() > 0);
+  auto const &batchFetch = appConfigOrError.value().network().batchFetch();
+  REQUIRE(!batchFetch.enabled());
+  REQUIRE(batchFetch.groups().empty());
+  auto const &rateLimit = appConfigOrError.value().network().rateLimit();
+  REQUIRE(!rateLimit.enabled());
+  REQUIRE(rateLimit.requestsPerSec() == Approx(10.0));
+  REQUIRE(rateLimit.burst() == 10U);
+  auto const &circuitBreaker =
+      appConfigOrError.value().network().circuitBreaker();
+  REQUIRE(!circuitBreaker.enabled());
+  REQUIRE(circuitBreaker.consecutiveFailures() == 5U);
+  REQUIRE(circuitBreaker.failureRate() == Approx(0.5));
+  REQUIRE(circuitBreaker.windowSize() == 20U);
+  REQUIRE(circuitBreaker.openDuration() == std::chrono::seconds(30));
+  auto const &bodyBuffer = appConfigOrError.value().network().bodyBuffer();
+  REQUIRE(bodyBuffer.memoryBudget() == 16384U * 1024U);
+  REQUIRE(bodyBuffer.spillDirectory().empty());
+}
+
+TEST_CASE("Network options", "[AppConfig]") {
+  const auto *const config = R"(
+    {
+      "credentials": {
+        "serverUrl":"https://my.server.com",
+        "userName":"LOGIN",
+        "password":"PASSWORD"
+      },
+      "options": {
+        "dateStart": "2020-11-21",
+        "dateEnd": "2020-12-23",
+        "users": ["User1", "User2"],
+        "defaultAssociation": "SOP",
+        "associations": {"[Common]": "Common", "[Arch]": "Non-SOP"}
+      },
+      "network": {
+        "connectionPool": {"maxSize": 4, "idleTimeoutSec": 15,
+                           "connectAttemptDelayMSec": 0},
+        "tlsSessionCache": {"enabled": false, "file": "sessions.txt"},
+        "maxParallelRequests": 3,
+        "adaptiveConcurrency": {"enabled": true, "minLimit": 2,
+                                "initialLimit": 3, "latencyTolerance": 1.5,
+                                "backoffRatio": 0.7},
+        "retry": {"maxAttempts": 3, "attemptTimeoutSec": 5,
+                  "totalTimeoutSec": 20, "baseDelayMSec": 100,
+                  "maxDelayMSec": 2000},
+        "hedging": {"enabled": true, "percentile": 0.9, "minSamples": 5,
+                    "maxHedgeRatio": 0.2},
+        "dateRangeChunking": {"enabled": true, "initialDays": 14,
+                              "minDays": 7, "maxDays": 28,
+                              "targetResponseKiB": 512},
+        "threads": 4,
+        "dnsCache": {"enabled": false, "ttlSec": 60, "file": "hosts.txt"},
+        "timingFile": "timing.jsonl",
+        "responseCache": {"enabled": true, "directory": "cache",
+                          "maxSizeMb": 2, "trustClosedRanges": true},
+        "incrementalSync": {"enabled": true, "file": "sync.jsonl",
+                            "overlapDays": 3, "fullResyncDays": 5},
+        "batchFetch": {"enabled": true, "groups": ["team1", "team2"]},
+        "rateLimit": {"enabled": true, "requestsPerSec": 2.5, "burst": 5},
+        "circuitBreaker": {"enabled": true, "consecutiveFailures": 3,
+                           "failureRate": 0.25, "windowSize": 8, "openSec": 5},
+        "bodyBuffer": {"memoryBudgetKiB": 512, "spillDirectory": "/tmp"}
+      }
+    }
+  )";
+  auto const appConfigOrError = jwlrep::createAppConfigFromJson(config);
+  REQUIRE(appConfigOrError.has_value());
+  auto const &connectionPool =
+      appConfigOrError.value().network().connectionPool();
+  REQUIRE(connectionPool.maxSize() == 4U);
+  REQUIRE(connectionPool.idleTimeout() == std::chrono::seconds{15});
+  REQUIRE(connectionPool.connectAttemptDelay().count() == 0);
+  auto const &tlsSessionCache =
+      appConfigOrError.value().network().tlsSessionCache();
+  REQUIRE(!tlsSessionCache.enabled());
+  REQUIRE(tlsSessionCache.filePath() == "sessions.txt");
+  REQUIRE(appConfigOrError.value().network().maxParallelRequests() == 3U);
+  auto const &adaptiveConcurrency =
+      appConfigOrError.value().network().adaptiveConcurrency();
+  REQUIRE(adaptiveConcurrency.enabled());
+  REQUIRE(adaptiveConcurrency.minLimit() == 2U);
+  REQUIRE(adaptiveConcurrency.initialLimit() == 3U);
+  REQUIRE(adaptiveConcurrency.latencyTolerance() == Approx(1.5));
+  REQUIRE(adaptiveConcurrency.backoffRatio() == Approx(0.7));
+  auto const &retry = appConfigOrError.value().network().retry();
+  REQUIRE(retry.maxAttempts() == 3U);
+  REQUIRE(retry.attemptTimeout() == std::chrono::seconds{5});
+  REQUIRE(retry.totalTimeout() == std::chrono::seconds{20});
+  REQUIRE(retry.baseDelay() == std::chrono::milliseconds{100});
+  REQUIRE(retry.maxDelay() == std::chrono::milliseconds{2000});
+  auto const &hedging = appConfigOrError.value().network().hedging();
+  REQUIRE(hedging.enabled());
+  REQUIRE(hedging.percentile() == Approx(0.9));
+  REQUIRE(hedging.minSamples() == 5U);
+  REQUIRE(hedging.maxHedgeRatio() == Approx(0.2));
+  auto const &dateRangeChunking =
+      appConfigOrError.value().network().dateRangeChunking();
+  REQUIRE(dateRangeChunking.enabled());
+  REQUIRE(dateRangeChunking.initialDays() == 14U);
+  REQUIRE(dateRangeChunking.minDays() == 7U);
+  REQUIRE(dateRangeChunking.maxDays() == 28U);
+  REQUIRE(dateRangeChunking.targetResponseSize() == 512U * 1024U);
+  REQUIRE(appConfigOrError.value().network().threads() == 4U);
+  auto const &dnsCache = appConfigOrError.value().network().dnsCache();
+  REQUIRE(!dnsCache.enabled());
+  REQUIRE(dnsCache.ttl() == std::chrono::seconds{60});
+  REQUIRE(dnsCache.filePath() == "hosts.txt");
+  REQUIRE(appConfigOrError.value().network().timingFilePath() ==
+          "timing.jsonl");
+  auto const &responseCache =
+      appConfigOrError.value().network().responseCache();
+  REQUIRE(responseCache.enabled());
+  REQUIRE(responseCache.directoryPath() == "cache");
+  REQUIRE(responseCache.maxSize() == 2U * 1024U * 1024U);
+  REQUIRE(responseCache.trustClosedRanges());
+  auto const &incrementalSync =
+      appConfigOrError.value().network().incrementalSync();
+  REQUIRE(incrementalSync.enabled());
+  REQUIRE(incrementalSync.filePath() == "sync.jsonl");
+  REQUIRE(incrementalSync.overlap().days() == 3);
+  REQUIRE(incrementalSync.fullResyncInterval().days() == 5);
+  auto const &batchFetch = appConfigOrError.value().network().batchFetch();
+  REQUIRE(batchFetch.enabled());
+  REQUIRE(batchFetch.groups() ==
+          std::vector<std::string>{"team1", "team2"});
+  auto const &rateLimit = appConfigOrError.value().network().rateLimit();
+  REQUIRE(rateLimit.enabled());
+  REQUIRE(rateLimit.requestsPerSec() == Approx(2.5));
+  REQUIRE(rateLimit.burst() == 5U);
+  auto const &circuitBreaker =
+      appConfigOrError.value().network().circuitBreaker();
+  REQUIRE(circuitBreaker.enabled());
+  REQUIRE(circuitBreaker.consecutiveFailures() == 3U);
+  REQUIRE(circuitBreaker.failureRate() == Approx(0.25));
+  REQUIRE(circuitBreaker.windowSize() == 8U);
+  REQUIRE(circuitBreaker.openDuration() == std::chrono::seconds(5));
+  auto const &bodyBuffer = appConfigOrError.value().network().bodyBuffer();
+  REQUIRE(bodyBuffer.memoryBudget() == 512U * 1024U);
+  REQUIRE(bodyBuffer.spillDirectory() == "/tmp");
 }
 
 TEST_CASE("Associations keys are normalized during load", "[AppConfig]") {
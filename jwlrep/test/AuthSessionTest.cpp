@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AuthSession.h>
+#include <jwlrep/GeneralError.h>
+
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+
+namespace {
+
+namespace http = boost::beast::http;
+
+auto makeResponse(http::status status,
+                  std::vector<std::string> const& setCookies)
+    -> jwlrep::HttpResponse {
+  jwlrep::HttpResponse response{status, 11};
+  for (auto const& setCookie : setCookies) {
+    response.insert(http::field::set_cookie, setCookie);
+  }
+  return response;
+}
+
+}  // namespace
+
+TEST_CASE("Cookies are taken from the response", "[AuthSession]") {
+  auto const cookies = jwlrep::parseSetCookies(makeResponse(
+      http::status::ok,
+      {"JSESSIONID=ABC; Path=/; HttpOnly",
+       "atlassian.xsrf.token=X|Y|lin; Path=/; Secure",
+       "seraph.rememberme.cookie=; Max-Age=0; Path=/", "malformed"}));
+  REQUIRE(cookies == std::map<std::string, std::string>{
+                         {"JSESSIONID", "ABC"},
+                         {"atlassian.xsrf.token", "X|Y|lin"},
+                         {"seraph.rememberme.cookie", ""}});
+}
+
+TEST_CASE("Rejected session is renewed once", "[AuthSession]") {
+  jwlrep::AuthSession authSession;
+  auto loginsCount = 0U;
+  auto const login =
+      [&loginsCount]() -> jwlrep::Expected<jwlrep::HttpResponse> {
+    ++loginsCount;
+    return makeResponse(
+        http::status::ok,
+        {fmt::format("JSESSIONID=S{}; Path=/", loginsCount),
+         "atlassian.xsrf.token=T; Path=/"});
+  };
+
+  auto const ticket = authSession.ticket();
+  REQUIRE(ticket.cookie.empty());
+  REQUIRE_FALSE(authSession.renew(ticket.generation, login));
+  auto const firstTicket = authSession.ticket();
+  REQUIRE(firstTicket.cookie == "JSESSIONID=S1; atlassian.xsrf.token=T");
+
+  // Requests which got the same rejected session renew it once
+  REQUIRE_FALSE(authSession.renew(firstTicket.generation, login));
+  REQUIRE_FALSE(authSession.renew(firstTicket.generation, login));
+  REQUIRE(authSession.ticket().cookie ==
+          "JSESSIONID=S2; atlassian.xsrf.token=T");
+  REQUIRE(authSession.loginsCount() == 2U);
+  REQUIRE(loginsCount == 2U);
+}
+
+TEST_CASE("Failed login keeps session closed", "[AuthSession]") {
+  jwlrep::AuthSession authSession;
+  auto const rejectedLogin = []() -> jwlrep::Expected<jwlrep::HttpResponse> {
+    return makeResponse(http::status::unauthorized, {});
+  };
+  REQUIRE(authSession.renew(0U, rejectedLogin) ==
+          jwlrep::GeneralError::AuthenticationFailed);
+
+  // Server hasn't set the cookies
+  auto const sessionlessLogin =
+      []() -> jwlrep::Expected<jwlrep::HttpResponse> {
+    return makeResponse(http::status::ok, {});
+  };
+  REQUIRE(authSession.renew(0U, sessionlessLogin) ==
+          jwlrep::GeneralError::AuthenticationFailed);
+  REQUIRE(authSession.ticket().cookie.empty());
+  REQUIRE(authSession.loginsCount() == 0U);
+}
@@ -3,6 +3,7 @@
 // Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
 
 #include <jwlrep/Base64.h>
+#include <jwlrep/GeneralError.h>
 
 #include <catch2/catch.hpp>
 
@@ -22,4 +23,30 @@ TEST_CASE("Http basic auth (aladdin:opensesame)", "[Base64]") {
   const auto *const plainUserNameAndPwd = "aladdin:opensesame";
   REQUIRE(jwlrep::base64Encode(plainUserNameAndPwd) ==
           "YWxhZGRpbjpvcGVuc2VzYW1l");
-}
\ No newline at end of file
+}
+
+TEST_CASE("Decode", "[Base64]") {
+  auto const decodedOrError = jwlrep::base64Decode("ZGVtbzpwQDU1dzByZA==");
+  REQUIRE(decodedOrError.has_value());
+  REQUIRE(decodedOrError.value() == "demo:p@55w0rd");
+}
+
+TEST_CASE("Decode empty", "[Base64]") {
+  auto const decodedOrError = jwlrep::base64Decode("");
+  REQUIRE(decodedOrError.has_value());
+  REQUIRE(decodedOrError.value().empty());
+}
+
+TEST_CASE("Decode invalid", "[Base64]") {
+  auto const decodedOrError = jwlrep::base64Decode("bm9u*ZTpub25l");
+  REQUIRE(decodedOrError.has_error());
+  REQUIRE(decodedOrError.error() == jwlrep::GeneralError::WrongArg);
+}
+
+TEST_CASE("Encode-decode binary", "[Base64]") {
+  auto const binary = std::string{"\x00\x01\xfe\xff\x80", 5U};
+  auto const decodedOrError =
+      jwlrep::base64Decode(jwlrep::base64Encode(binary));
+  REQUIRE(decodedOrError.has_value());
+  REQUIRE(decodedOrError.value() == binary);
+}
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/CircuitBreaker.h>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+using State = jwlrep::CircuitBreaker::State;
+using Permit = jwlrep::CircuitBreaker::Permit;
+
+auto makeOptions(std::size_t consecutiveFailures, double failureRate,
+                 std::size_t windowSize) -> jwlrep::CircuitBreakerOptions {
+  return jwlrep::CircuitBreakerOptions{true, consecutiveFailures, failureRate,
+                                       windowSize, std::chrono::seconds(30)};
+}
+
+}  // namespace
+
+TEST_CASE("Circuit is opened by consecutive failures", "[CircuitBreaker]") {
+  auto const now = jwlrep::CircuitBreaker::Clock::now();
+  jwlrep::CircuitBreaker circuitBreaker{makeOptions(3U, 1.0, 10U)};
+  circuitBreaker.onResult(Permit::Request, true, now);
+  circuitBreaker.onResult(Permit::Request, true, now);
+  // Success breaks the run
+  circuitBreaker.onResult(Permit::Request, false, now);
+  circuitBreaker.onResult(Permit::Request, true, now);
+  circuitBreaker.onResult(Permit::Request, true, now);
+  REQUIRE(circuitBreaker.state() == State::Closed);
+  REQUIRE(circuitBreaker.allow(now) == Permit::Request);
+
+  circuitBreaker.onResult(Permit::Request, true, now);
+  REQUIRE(circuitBreaker.state() == State::Open);
+  REQUIRE(circuitBreaker.allow(now + std::chrono::seconds(29)) ==
+          Permit::Rejected);
+  REQUIRE(circuitBreaker.stats().trips == 1U);
+  REQUIRE(circuitBreaker.stats().rejected == 1U);
+}
+
+TEST_CASE("Circuit is opened by failure rate", "[CircuitBreaker]") {
+  auto const now = jwlrep::CircuitBreaker::Clock::now();
+  jwlrep::CircuitBreaker circuitBreaker{makeOptions(10U, 0.5, 4U)};
+  circuitBreaker.onResult(Permit::Request, true, now);
+  circuitBreaker.onResult(Permit::Request, false, now);
+  circuitBreaker.onResult(Permit::Request, true, now);
+  REQUIRE(circuitBreaker.state() == State::Closed);
+
+  // Window is full: 2 of 4 have failed
+  circuitBreaker.onResult(Permit::Request, false, now);
+  REQUIRE(circuitBreaker.state() == State::Open);
+}
+
+TEST_CASE("Single probe is sent by half-open circuit", "[CircuitBreaker]") {
+  auto now = jwlrep::CircuitBreaker::Clock::now();
+  jwlrep::CircuitBreaker circuitBreaker{makeOptions(1U, 1.0, 10U)};
+  circuitBreaker.onResult(Permit::Request, true, now);
+  REQUIRE(circuitBreaker.state() == State::Open);
+
+  // Failed probe opens the circuit again
+  now += std::chrono::seconds(30);
+  REQUIRE(circuitBreaker.allow(now) == Permit::Probe);
+  REQUIRE(circuitBreaker.state() == State::HalfOpen);
+  REQUIRE(circuitBreaker.allow(now) == Permit::Rejected);
+  circuitBreaker.onResult(Permit::Probe, true, now);
+  REQUIRE(circuitBreaker.state() == State::Open);
+  REQUIRE(circuitBreaker.allow(now) == Permit::Rejected);
+
+  now += std::chrono::seconds(30);
+  REQUIRE(circuitBreaker.allow(now) == Permit::Probe);
+  circuitBreaker.onResult(Permit::Probe, false, now);
+  REQUIRE(circuitBreaker.state() == State::Closed);
+  REQUIRE(circuitBreaker.allow(now) == Permit::Request);
+  REQUIRE(circuitBreaker.stats().trips == 2U);
+  REQUIRE(circuitBreaker.stats().rejected == 2U);
+}
+
+TEST_CASE("Late result of the ordinary request is not taken for the probe",
+          "[CircuitBreaker]") {
+  auto now = jwlrep::CircuitBreaker::Clock::now();
+  jwlrep::CircuitBreaker circuitBreaker{makeOptions(1U, 1.0, 10U)};
+  REQUIRE(circuitBreaker.allow(now) == Permit::Request);
+  circuitBreaker.onResult(Permit::Request, true, now);
+  REQUIRE(circuitBreaker.state() == State::Open);
+
+  now += std::chrono::seconds(30);
+  REQUIRE(circuitBreaker.allow(now) == Permit::Probe);
+  // Request sent before the circuit was opened succeeds
+  circuitBreaker.onResult(Permit::Request, false, now);
+  REQUIRE(circuitBreaker.state() == State::HalfOpen);
+  REQUIRE(circuitBreaker.allow(now) == Permit::Rejected);
+
+  circuitBreaker.onResult(Permit::Probe, false, now);
+  REQUIRE(circuitBreaker.state() == State::Closed);
+}
+
+TEST_CASE("Allowed request is checked again before sending",
+          "[CircuitBreaker]") {
+  auto const now = jwlrep::CircuitBreaker::Clock::now();
+  jwlrep::CircuitBreaker circuitBreaker{makeOptions(1U, 1.0, 10U)};
+  auto openedCount = 0U;
+  circuitBreaker.setOpenHandler([&openedCount]() { ++openedCount; });
+  auto const permit = circuitBreaker.allow(now);
+  REQUIRE(circuitBreaker.isAllowed(permit));
+
+  circuitBreaker.onResult(Permit::Request, true, now);
+  REQUIRE(openedCount == 1U);
+  REQUIRE_FALSE(circuitBreaker.isAllowed(permit));
+  circuitBreaker.onAborted();
+  REQUIRE(circuitBreaker.stats().aborted == 1U);
+
+  // Probe is sent by the half-open circuit
+  auto const later = now + std::chrono::seconds(30);
+  REQUIRE(circuitBreaker.allow(later) == Permit::Probe);
+  REQUIRE(circuitBreaker.isAllowed(Permit::Probe));
+  REQUIRE_FALSE(circuitBreaker.isAllowed(Permit::Request));
+
+  // Failed probe opens the circuit again
+  circuitBreaker.onResult(Permit::Probe, true, later);
+  REQUIRE(openedCount == 2U);
+}
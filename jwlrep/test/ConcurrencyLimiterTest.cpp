@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/ConcurrencyLimiter.h>
+
+#include <algorithm>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+#include <catch2/catch.hpp>
+#include <vector>
+
+namespace {
+
+auto const kLatency = std::chrono::milliseconds(100);
+
+auto makeOptions(std::size_t minLimit, std::size_t initialLimit)
+    -> jwlrep::AdaptiveConcurrencyOptions {
+  return jwlrep::AdaptiveConcurrencyOptions{true, minLimit, initialLimit, 2.0,
+                                            0.5};
+}
+
+}  // namespace
+
+TEST_CASE("Limit grows by one per window of successful requests",
+          "[ConcurrencyLimiter]") {
+  jwlrep::AimdController controller(makeOptions(1U, 4U), 16U);
+  for (auto i = 0U; i < 4U; ++i) {
+    controller.onSample(kLatency, jwlrep::RequestOutcome::Success);
+  }
+  REQUIRE(controller.limit() == 5U);
+  REQUIRE(controller.trajectory().size() == 2U);
+  REQUIRE(controller.trajectory().back().second == 5U);
+}
+
+TEST_CASE("Limit does not exceed max", "[ConcurrencyLimiter]") {
+  jwlrep::AimdController controller(makeOptions(1U, 4U), 6U);
+  for (auto i = 0U; i < 100U; ++i) {
+    controller.onSample(kLatency, jwlrep::RequestOutcome::Success);
+  }
+  REQUIRE(controller.limit() == 6U);
+}
+
+TEST_CASE("Limit is cut on overload", "[ConcurrencyLimiter]") {
+  jwlrep::AimdController controller(makeOptions(1U, 8U), 16U);
+  controller.onSample(kLatency, jwlrep::RequestOutcome::Overload);
+  REQUIRE(controller.limit() == 4U);
+}
+
+TEST_CASE("Limit is cut once per window", "[ConcurrencyLimiter]") {
+  jwlrep::AimdController controller(makeOptions(1U, 8U), 16U);
+  for (auto i = 0U; i < 4U; ++i) {
+    controller.onSample(kLatency, jwlrep::RequestOutcome::Overload);
+  }
+  REQUIRE(controller.limit() == 4U);
+  controller.onSample(kLatency, jwlrep::RequestOutcome::Overload);
+  REQUIRE(controller.limit() == 2U);
+}
+
+TEST_CASE("Limit does not drop below min", "[ConcurrencyLimiter]") {
+  jwlrep::AimdController controller(makeOptions(3U, 4U), 16U);
+  for (auto i = 0U; i < 20U; ++i) {
+    controller.onSample(kLatency, jwlrep::RequestOutcome::Overload);
+  }
+  REQUIRE(controller.limit() == 3U);
+}
+
+TEST_CASE("Failures do not change limit", "[ConcurrencyLimiter]") {
+  jwlrep::AimdController controller(makeOptions(1U, 4U), 16U);
+  for (auto i = 0U; i < 20U; ++i) {
+    controller.onSample(kLatency, jwlrep::RequestOutcome::Failure);
+  }
+  REQUIRE(controller.limit() == 4U);
+}
+
+TEST_CASE("Limit is cut when latency climbs", "[ConcurrencyLimiter]") {
+  jwlrep::AimdController controller(makeOptions(1U, 8U), 8U);
+  for (auto i = 0U; i < 20U; ++i) {
+    controller.onSample(kLatency, jwlrep::RequestOutcome::Success);
+  }
+  REQUIRE(controller.limit() == 8U);
+  for (auto i = 0U; i < 3U; ++i) {
+    controller.onSample(kLatency * 10, jwlrep::RequestOutcome::Success);
+  }
+  REQUIRE(controller.limit() == 4U);
+}
+
+TEST_CASE("Limiter holds requests over the limit", "[ConcurrencyLimiter]") {
+  jwlrep::ConcurrencyLimiter limiter(makeOptions(1U, 2U), 2U);
+  auto inFlight = 0U;
+  auto maxInFlight = 0U;
+  std::vector<boost::fibers::fiber> fibers;
+  for (auto i = 0U; i < 10U; ++i) {
+    fibers.emplace_back([&]() {
+      limiter.acquire();
+      maxInFlight = std::max(maxInFlight, ++inFlight);
+      boost::this_fiber::yield();
+      --inFlight;
+      limiter.release(kLatency, jwlrep::RequestOutcome::Success);
+    });
+  }
+  for (auto& fiber : fibers) {
+    fiber.join();
+  }
+  REQUIRE(maxInFlight == 2U);
+  REQUIRE(!limiter.trajectoryToString().empty());
+}
+
+TEST_CASE("Cancelled waiter is woken up without taking the room",
+          "[ConcurrencyLimiter]") {
+  jwlrep::ConcurrencyLimiter limiter(makeOptions(1U, 1U), 1U);
+  REQUIRE(limiter.acquire());
+
+  auto isCancelled = false;
+  auto isAcquired = true;
+  boost::fibers::fiber waiting{[&]() {
+    isAcquired = limiter.acquire([&isCancelled]() { return isCancelled; });
+  }};
+  boost::this_fiber::yield();
+  isCancelled = true;
+  limiter.wakeUp();
+  waiting.join();
+  REQUIRE_FALSE(isAcquired);
+
+  // Room of the cancelled waiter is not taken
+  limiter.release(kLatency, jwlrep::RequestOutcome::Success);
+  REQUIRE(limiter.acquire());
+}
@@ -0,0 +1,538 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/ConnectionPool.h>
+#include <jwlrep/ErrorCodeUtil.h>
+#include <jwlrep/FiberThreadPool.h>
+#include <jwlrep/RequestCancellation.h>
+#include <jwlrep/TlsSessionCache.h>
+
+#include <array>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+#include <catch2/catch.hpp>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+#include <vector>
+
+namespace {
+
+using boost::asio::ip::make_address;
+using boost::asio::ip::tcp;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+auto const kTimeout = seconds(5);
+
+/**
+ * Server context with the self-signed certificate generated on the fly.
+ * TLS 1.2 doesn't send session tickets after the handshake, so the idle
+ * connection has nothing to read. TLS 1.3 server sends them right after the
+ * handshake.
+ */
+auto makeServerContext(boost::asio::ssl::context::method method)
+    -> std::unique_ptr<boost::asio::ssl::context> {
+  auto context = std::make_unique<boost::asio::ssl::context>(method);
+
+  std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> keyContext{
+      EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr), &EVP_PKEY_CTX_free};
+  EVP_PKEY* rawKey = nullptr;
+  EVP_PKEY_keygen_init(keyContext.get());
+  EVP_PKEY_CTX_set_rsa_keygen_bits(keyContext.get(), 2048);
+  EVP_PKEY_keygen(keyContext.get(), &rawKey);
+  std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key{rawKey,
+                                                           &EVP_PKEY_free};
+
+  std::unique_ptr<X509, decltype(&X509_free)> certificate{X509_new(),
+                                                          &X509_free};
+  ASN1_INTEGER_set(X509_get_serialNumber(certificate.get()), 1);
+  X509_gmtime_adj(X509_getm_notBefore(certificate.get()), 0);
+  X509_gmtime_adj(X509_getm_notAfter(certificate.get()), 3600);
+  X509_set_pubkey(certificate.get(), key.get());
+  auto* const name = X509_get_subject_name(certificate.get());
+  // NOLINTNEXTLINE
+  auto const* const commonName = reinterpret_cast<unsigned char const*>(
+      "localhost");
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, commonName, -1, -1, 0);
+  X509_set_issuer_name(certificate.get(), name);
+  X509_sign(certificate.get(), key.get(), EVP_sha256());
+
+  SSL_CTX_use_certificate(context->native_handle(), certificate.get());
+  SSL_CTX_use_PrivateKey(context->native_handle(), key.get());
+  return context;
+}
+
+/**
+ * Accepts TLS connections and keeps them open until stopped. Must be started
+ * and stopped by the fiber of the thread which runs the io_context.
+ */
+class TlsServer final {
+ public:
+  explicit TlsServer(boost::asio::io_context& ioContext,
+                     boost::asio::ssl::context::method method =
+                         boost::asio::ssl::context::tlsv12_server)
+      : context_(makeServerContext(method)),
+        acceptor_(ioContext, {make_address("127.0.0.1"), 0U}) {}
+
+  [[nodiscard]] auto endpoints() const -> tcp::resolver::results_type {
+    return tcp::resolver::results_type::create(acceptor_.local_endpoint(),
+                                               "localhost", "https");
+  }
+
+  /**
+   * Whether connection is closed by server right after the handshake.
+   */
+  void closeAfterHandshake() { isClosedAfterHandshake_ = true; }
+
+  void start() {
+    fibers_.emplace_back([this]() {
+      while (true) {
+        auto stream =
+            std::make_shared<boost::asio::ssl::stream<tcp::socket>>(
+                acceptor_.get_executor(), *context_);
+        boost::system::error_code errorCode;
+        acceptor_.async_accept(stream->next_layer(),
+                               boost::fibers::asio::this_yield()[errorCode]);
+        if (errorCode || !acceptor_.is_open()) {
+          return;
+        }
+        ++acceptedCount_;
+        streams_.push_back(stream);
+        fibers_.emplace_back([this, stream]() { serve(*stream); });
+      }
+    });
+  }
+
+  void stop() {
+    boost::system::error_code ignored;
+    acceptor_.close(ignored);
+    for (auto const& stream : streams_) {
+      stream->next_layer().close(ignored);
+    }
+    // Fibers are added by the accepting fiber, which is joined first
+    for (std::size_t index = 0U; index < fibers_.size(); ++index) {
+      fibers_[index].join();
+    }
+  }
+
+  [[nodiscard]] auto acceptedCount() const -> std::size_t {
+    return acceptedCount_;
+  }
+
+ private:
+  void serve(boost::asio::ssl::stream<tcp::socket>& stream) {
+    boost::system::error_code errorCode;
+    stream.async_handshake(boost::asio::ssl::stream_base::server,
+                           boost::fibers::asio::this_yield()[errorCode]);
+    if (errorCode || isClosedAfterHandshake_) {
+      stream.next_layer().close(errorCode);
+      return;
+    }
+    std::array<char, 1U> data{};
+    while (!errorCode) {
+      stream.async_read_some(boost::asio::buffer(data),
+                             boost::fibers::asio::this_yield()[errorCode]);
+    }
+  }
+
+  std::unique_ptr<boost::asio::ssl::context> context_;
+
+  tcp::acceptor acceptor_;
+
+  bool isClosedAfterHandshake_{false};
+
+  std::size_t acceptedCount_{0U};
+
+  std::vector<std::shared_ptr<boost::asio::ssl::stream<tcp::socket>>>
+      streams_;
+
+  /**
+   * Deque keeps the fibers in place while the new ones are added.
+   */
+  std::deque<boost::fibers::fiber> fibers_;
+};
+
+/**
+ * Run function in the fiber of the second thread together with the server.
+ */
+void runWithServer(
+    TlsServer& server, jwlrep::FiberThreadPool& threadPool,
+    std::function<void(boost::fibers::asio::yield_t&)> const& function) {
+  threadPool.runOnEachThread([&](std::size_t threadIndex) {
+    if (threadIndex != 1U) {
+      return;
+    }
+    server.start();
+    function(boost::fibers::asio::this_yield());
+    server.stop();
+  });
+}
+
+}  // namespace
+
+TEST_CASE("Idle connection is reused", "[ConnectionPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  TlsServer server{ioContext};
+  boost::asio::ssl::context clientContext{
+      boost::asio::ssl::context::tlsv12_client};
+
+  std::vector<bool> reused;
+  jwlrep::ConnectionPool::Stats stats;
+  runWithServer(server, threadPool, [&](auto& yield) {
+    jwlrep::ConnectionPool pool{
+        ioContext,
+        clientContext,
+        nullptr,
+        nullptr,
+        "localhost",
+        server.endpoints(),
+        jwlrep::ConnectionPoolOptions{2U, seconds(60), milliseconds(0)}};
+    for (auto i = 0U; i < 3U; ++i) {
+      auto leaseOrError = pool.acquire(kTimeout, yield);
+      if (!leaseOrError) {
+        return;
+      }
+      reused.push_back(leaseOrError.value().isReused());
+      leaseOrError.value().keepAlive();
+    }
+    stats = pool.stats();
+  });
+
+  REQUIRE(reused == std::vector<bool>{false, true, true});
+  REQUIRE(stats.created == 1U);
+  REQUIRE(stats.reused == 2U);
+  REQUIRE(stats.evicted == 0U);
+  REQUIRE(server.acceptedCount() == 1U);
+}
+
+TEST_CASE("Idle TLS 1.3 connection with session tickets is reused",
+          "[ConnectionPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  TlsServer server{ioContext, boost::asio::ssl::context::tlsv13_server};
+  boost::asio::ssl::context clientContext{
+      boost::asio::ssl::context::tlsv13_client};
+
+  std::vector<bool> reused;
+  jwlrep::ConnectionPool::Stats stats;
+  runWithServer(server, threadPool, [&](auto& yield) {
+    jwlrep::ConnectionPool pool{
+        ioContext,
+        clientContext,
+        nullptr,
+        nullptr,
+        "localhost",
+        server.endpoints(),
+        jwlrep::ConnectionPoolOptions{2U, seconds(60), milliseconds(0)}};
+    for (auto i = 0U; i < 3U; ++i) {
+      auto leaseOrError = pool.acquire(kTimeout, yield);
+      if (!leaseOrError) {
+        return;
+      }
+      reused.push_back(leaseOrError.value().isReused());
+      leaseOrError.value().keepAlive();
+      // Let the session tickets arrive while the connection is idle
+      { auto const released = std::move(leaseOrError.value()); }
+      boost::this_fiber::sleep_for(milliseconds(50));
+    }
+    stats = pool.stats();
+  });
+
+  REQUIRE(reused == std::vector<bool>{false, true, true});
+  REQUIRE(stats.created == 1U);
+  REQUIRE(stats.evicted == 0U);
+  REQUIRE(server.acceptedCount() == 1U);
+}
+
+TEST_CASE("Connection without keep-alive is closed", "[ConnectionPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  TlsServer server{ioContext};
+  boost::asio::ssl::context clientContext{
+      boost::asio::ssl::context::tlsv12_client};
+
+  std::vector<bool> reused;
+  jwlrep::ConnectionPool::Stats stats;
+  runWithServer(server, threadPool, [&](auto& yield) {
+    jwlrep::ConnectionPool pool{
+        ioContext,
+        clientContext,
+        nullptr,
+        nullptr,
+        "localhost",
+        server.endpoints(),
+        jwlrep::ConnectionPoolOptions{2U, seconds(60), milliseconds(0)}};
+    for (auto i = 0U; i < 2U; ++i) {
+      auto leaseOrError = pool.acquire(kTimeout, yield);
+      if (!leaseOrError) {
+        return;
+      }
+      reused.push_back(leaseOrError.value().isReused());
+    }
+    stats = pool.stats();
+  });
+
+  REQUIRE(reused == std::vector<bool>{false, false});
+  REQUIRE(stats.created == 2U);
+  REQUIRE(stats.reused == 0U);
+  REQUIRE(server.acceptedCount() == 2U);
+}
+
+TEST_CASE("Expired idle connection is evicted", "[ConnectionPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  TlsServer server{ioContext};
+  boost::asio::ssl::context clientContext{
+      boost::asio::ssl::context::tlsv12_client};
+
+  std::vector<bool> reused;
+  jwlrep::ConnectionPool::Stats stats;
+  runWithServer(server, threadPool, [&](auto& yield) {
+    // Zero idle timeout expires connection as soon as it is released
+    jwlrep::ConnectionPool pool{
+        ioContext,
+        clientContext,
+        nullptr,
+        nullptr,
+        "localhost",
+        server.endpoints(),
+        jwlrep::ConnectionPoolOptions{2U, seconds(0), milliseconds(0)}};
+    for (auto i = 0U; i < 2U; ++i) {
+      auto leaseOrError = pool.acquire(kTimeout, yield);
+      if (!leaseOrError) {
+        return;
+      }
+      reused.push_back(leaseOrError.value().isReused());
+      leaseOrError.value().keepAlive();
+    }
+    stats = pool.stats();
+  });
+
+  REQUIRE(reused == std::vector<bool>{false, false});
+  REQUIRE(stats.created == 2U);
+  REQUIRE(stats.evicted == 1U);
+}
+
+TEST_CASE("Connection closed by peer is evicted", "[ConnectionPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  TlsServer server{ioContext};
+  server.closeAfterHandshake();
+  boost::asio::ssl::context clientContext{
+      boost::asio::ssl::context::tlsv12_client};
+
+  std::vector<bool> reused;
+  jwlrep::ConnectionPool::Stats stats;
+  runWithServer(server, threadPool, [&](auto& yield) {
+    jwlrep::ConnectionPool pool{
+        ioContext,
+        clientContext,
+        nullptr,
+        nullptr,
+        "localhost",
+        server.endpoints(),
+        jwlrep::ConnectionPoolOptions{2U, seconds(60), milliseconds(0)}};
+    for (auto i = 0U; i < 2U; ++i) {
+      auto leaseOrError = pool.acquire(kTimeout, yield);
+      if (!leaseOrError) {
+        return;
+      }
+      reused.push_back(leaseOrError.value().isReused());
+      leaseOrError.value().keepAlive();
+      // Let the server close the connection
+      boost::this_fiber::sleep_for(milliseconds(50));
+    }
+    stats = pool.stats();
+  });
+
+  REQUIRE(reused == std::vector<bool>{false, false});
+  REQUIRE(stats.created == 2U);
+  REQUIRE(stats.evicted == 1U);
+}
+
+TEST_CASE("Session of the evicted idle connection is resumed",
+          "[ConnectionPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  TlsServer server{ioContext};
+  boost::asio::ssl::context clientContext{
+      boost::asio::ssl::context::tlsv12_client};
+  jwlrep::TlsSessionCache tlsSessionCache{clientContext};
+
+  runWithServer(server, threadPool, [&](auto& yield) {
+    // Zero idle timeout expires connection as soon as it is released
+    jwlrep::ConnectionPool pool{
+        ioContext,
+        clientContext,
+        &tlsSessionCache,
+        nullptr,
+        "localhost",
+        server.endpoints(),
+        jwlrep::ConnectionPoolOptions{2U, seconds(0), milliseconds(0)}};
+    for (auto i = 0U; i < 2U; ++i) {
+      auto leaseOrError = pool.acquire(kTimeout, yield);
+      if (!leaseOrError) {
+        return;
+      }
+      leaseOrError.value().keepAlive();
+    }
+  });
+
+  auto const stats = tlsSessionCache.stats();
+  REQUIRE(stats.full == 1U);
+  REQUIRE(stats.resumed == 1U);
+}
+
+TEST_CASE("Session of the dropped connection is not resumed",
+          "[ConnectionPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  TlsServer server{ioContext};
+  boost::asio::ssl::context clientContext{
+      boost::asio::ssl::context::tlsv12_client};
+  jwlrep::TlsSessionCache tlsSessionCache{clientContext};
+
+  runWithServer(server, threadPool, [&](auto& yield) {
+    jwlrep::ConnectionPool pool{
+        ioContext,
+        clientContext,
+        &tlsSessionCache,
+        nullptr,
+        "localhost",
+        server.endpoints(),
+        jwlrep::ConnectionPoolOptions{2U, seconds(60), milliseconds(0)}};
+    // Connection which is not kept alive is closed as failed
+    for (auto i = 0U; i < 2U; ++i) {
+      auto leaseOrError = pool.acquire(kTimeout, yield);
+      if (!leaseOrError) {
+        return;
+      }
+    }
+  });
+
+  auto const stats = tlsSessionCache.stats();
+  REQUIRE(stats.full == 2U);
+  REQUIRE(stats.resumed == 0U);
+}
+
+TEST_CASE("Exhausted pool waits for the released connection",
+          "[ConnectionPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  TlsServer server{ioContext};
+  boost::asio::ssl::context clientContext{
+      boost::asio::ssl::context::tlsv12_client};
+
+  auto isWaiting = false;
+  auto isWaiterReused = false;
+  auto isWaitExcluded = false;
+  jwlrep::ConnectionPool::Stats stats;
+  runWithServer(server, threadPool, [&](auto& yield) {
+    jwlrep::ConnectionPool pool{
+        ioContext,
+        clientContext,
+        nullptr,
+        nullptr,
+        "localhost",
+        server.endpoints(),
+        jwlrep::ConnectionPoolOptions{1U, seconds(60), milliseconds(0)}};
+    auto leaseOrError = pool.acquire(kTimeout, yield);
+    if (!leaseOrError) {
+      return;
+    }
+
+    auto isAcquired = false;
+    std::chrono::steady_clock::time_point releasedAt;
+    boost::fibers::fiber waiter{[&]() {
+      auto waiterLeaseOrError =
+          pool.acquire(kTimeout, boost::fibers::asio::this_yield());
+      isAcquired = true;
+      isWaiterReused =
+          waiterLeaseOrError && waiterLeaseOrError.value().isReused();
+      // Timeout of the waiter starts once the connection is released
+      isWaitExcluded = waiterLeaseOrError &&
+                       waiterLeaseOrError.value().takenAt() >= releasedAt;
+    }};
+    boost::this_fiber::sleep_for(milliseconds(50));
+    isWaiting = !isAcquired;
+
+    leaseOrError.value().keepAlive();
+    releasedAt = std::chrono::steady_clock::now();
+    { auto const released = std::move(leaseOrError.value()); }
+    waiter.join();
+    stats = pool.stats();
+  });
+
+  REQUIRE(isWaiting);
+  REQUIRE(isWaiterReused);
+  REQUIRE(isWaitExcluded);
+  REQUIRE(stats.created == 1U);
+  REQUIRE(server.acceptedCount() == 1U);
+}
+
+TEST_CASE("Cancelled request stops waiting for the connection",
+          "[ConnectionPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  TlsServer server{ioContext};
+  boost::asio::ssl::context clientContext{
+      boost::asio::ssl::context::tlsv12_client};
+
+  auto isAbortedBeforeRelease = false;
+  std::error_code waiterErrorCode;
+  runWithServer(server, threadPool, [&](auto& yield) {
+    jwlrep::ConnectionPool pool{
+        ioContext,
+        clientContext,
+        nullptr,
+        nullptr,
+        "localhost",
+        server.endpoints(),
+        jwlrep::ConnectionPoolOptions{1U, seconds(60), milliseconds(0)}};
+    auto leaseOrError = pool.acquire(kTimeout, yield);
+    if (!leaseOrError) {
+      return;
+    }
+
+    jwlrep::RequestCancellation cancellation;
+    auto isFinished = false;
+    boost::fibers::fiber waiter{[&]() {
+      auto const waiterLeaseOrError = pool.acquire(
+          kTimeout, boost::fibers::asio::this_yield(), nullptr, &cancellation);
+      isFinished = true;
+      if (!waiterLeaseOrError) {
+        waiterErrorCode = waiterLeaseOrError.error();
+      }
+    }};
+    boost::this_fiber::sleep_for(milliseconds(50));
+    cancellation.cancel();
+    boost::this_fiber::sleep_for(milliseconds(50));
+    isAbortedBeforeRelease = isFinished;
+
+    leaseOrError.value().keepAlive();
+    { auto const released = std::move(leaseOrError.value()); }
+    waiter.join();
+    pool.shutdown(kTimeout, yield);
+  });
+
+  REQUIRE(isAbortedBeforeRelease);
+  REQUIRE(waiterErrorCode ==
+          jwlrep::toStd(boost::asio::error::operation_aborted));
+}
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/ContentDecoder.h>
+
+#include <catch2/catch.hpp>
+#include <string>
+#include <zlib.h>
+
+namespace {
+
+auto const kGzipWindowBits = MAX_WBITS + 16;
+auto const kZlibWindowBits = MAX_WBITS;
+auto const kRawWindowBits = -MAX_WBITS;
+
+auto compress(std::string const& data, int windowBits) -> std::string {
+  z_stream stream{};
+  auto const kMemLevel = 8;
+  deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, kMemLevel,
+               Z_DEFAULT_STRATEGY);
+  std::string result(deflateBound(&stream, data.size()), '\0');
+  // NOLINTNEXTLINE
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  // NOLINTNEXTLINE
+  stream.next_out = reinterpret_cast<Bytef*>(result.data());
+  stream.avail_out = static_cast<uInt>(result.size());
+  deflate(&stream, Z_FINISH);
+  result.resize(stream.total_out);
+  deflateEnd(&stream);
+  return result;
+}
+
+/**
+ * Source which hands out the data in small chunks.
+ */
+auto makeSource(std::string_view data) -> jwlrep::ChunkSource {
+  return [rest = data]() mutable {
+    auto const kChunkSize = 10U;
+    auto const chunk = rest.substr(0U, kChunkSize);
+    rest.remove_prefix(chunk.size());
+    return chunk;
+  };
+}
+
+auto decodeAll(jwlrep::ContentDecoder& decoder) -> std::string {
+  std::string result;
+  for (auto chunk = decoder.nextChunk(); !chunk.empty();
+       chunk = decoder.nextChunk()) {
+    result.append(chunk);
+  }
+  return result;
+}
+
+auto makeBody() -> std::string {
+  std::string body;
+  auto const kEntriesCount = 10000U;
+  for (auto i = 0U; i < kEntriesCount; ++i) {
+    body += R"({"timeSpent": 3600, "author": "user", "created": 1604507259177})";
+  }
+  return body;
+}
+
+}  // namespace
+
+TEST_CASE("Identity body is passed as is", "[ContentDecoder]") {
+  std::string const body = R"({"worklog": []})";
+  for (auto const* const encoding : {"", "identity"}) {
+    auto const source = makeSource(body);
+    auto decoderOrError = jwlrep::ContentDecoder::create(encoding, source);
+    REQUIRE(decoderOrError.has_value());
+    auto& decoder = decoderOrError.value();
+    REQUIRE(!decoder.isEncoded());
+    REQUIRE(decodeAll(decoder) == body);
+    REQUIRE(!decoder.error());
+    REQUIRE(decoder.encodedSize() == body.size());
+  }
+}
+
+TEST_CASE("Gzip and deflate bodies are decoded", "[ContentDecoder]") {
+  auto const body = makeBody();
+  auto const [encoding, windowBits] =
+      GENERATE(std::make_pair("gzip", kGzipWindowBits),
+               std::make_pair("GZIP", kGzipWindowBits),
+               std::make_pair("deflate", kZlibWindowBits),
+               std::make_pair("deflate", kRawWindowBits));
+  auto const encodedBody = compress(body, windowBits);
+  auto const source = makeSource(encodedBody);
+  auto decoderOrError = jwlrep::ContentDecoder::create(encoding, source);
+  REQUIRE(decoderOrError.has_value());
+  auto& decoder = decoderOrError.value();
+  REQUIRE(decoder.isEncoded());
+  REQUIRE(decodeAll(decoder) == body);
+  REQUIRE(!decoder.error());
+  REQUIRE(decoder.encodedSize() == encodedBody.size());
+  REQUIRE(decoder.decodedSize() == body.size());
+  REQUIRE(decoder.encodedSize() < decoder.decodedSize());
+}
+
+TEST_CASE("Concatenated gzip members are decoded", "[ContentDecoder]") {
+  auto const encodedBody = compress("first ", kGzipWindowBits) +
+                           compress("second", kGzipWindowBits);
+  auto const source = makeSource(encodedBody);
+  auto decoderOrError = jwlrep::ContentDecoder::create("gzip", source);
+  REQUIRE(decoderOrError.has_value());
+  REQUIRE(decodeAll(decoderOrError.value()) == "first second");
+  REQUIRE(!decoderOrError.value().error());
+}
+
+TEST_CASE("Corrupted body is reported", "[ContentDecoder]") {
+  auto const body = makeBody();
+  auto const encodedBody = compress(body, kGzipWindowBits);
+
+  SECTION("Truncated") {
+    auto const source =
+        makeSource(std::string_view{encodedBody}.substr(0U, 100U));
+    auto decoderOrError = jwlrep::ContentDecoder::create("gzip", source);
+    REQUIRE(decoderOrError.has_value());
+    decodeAll(decoderOrError.value());
+    REQUIRE(decoderOrError.value().error() ==
+            std::errc::illegal_byte_sequence);
+  }
+
+  SECTION("Garbage") {
+    std::string const garbage(100U, 'x');
+    auto const source = makeSource(garbage);
+    auto decoderOrError = jwlrep::ContentDecoder::create("gzip", source);
+    REQUIRE(decoderOrError.has_value());
+    REQUIRE(decodeAll(decoderOrError.value()).empty());
+    REQUIRE(decoderOrError.value().error() ==
+            std::errc::illegal_byte_sequence);
+  }
+}
+
+TEST_CASE("Unsupported encoding is rejected", "[ContentDecoder]") {
+  jwlrep::ChunkSource const source = []() { return std::string_view{}; };
+  auto const decoderOrError = jwlrep::ContentDecoder::create("br", source);
+  REQUIRE(decoderOrError.has_error());
+  REQUIRE(decoderOrError.error() == std::errc::invalid_argument);
+}
@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/CpuWorkerPool.h>
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+auto makeChunkSource(std::vector<std::string> const& chunks)
+    -> jwlrep::ChunkSource {
+  auto index = std::make_shared<std::size_t>(0U);
+  return [&chunks, index]() -> std::string_view {
+    if (*index == chunks.size()) {
+      return {};
+    }
+    return chunks[(*index)++];
+  };
+}
+
+}  // namespace
+
+TEST_CASE("Task is run by worker thread", "[CpuWorkerPool]") {
+  jwlrep::CpuWorkerPool cpuWorkerPool{2U};
+  REQUIRE(cpuWorkerPool.size() == 2U);
+  auto future =
+      cpuWorkerPool.submit([]() { return std::this_thread::get_id(); });
+  REQUIRE(future.get() != std::this_thread::get_id());
+
+  // Task is taken from the queue before it is run
+  REQUIRE(cpuWorkerPool.stats().maxQueueDepth == 1U);
+  REQUIRE(cpuWorkerPool.queueDepth() == 0U);
+}
+
+TEST_CASE("Task is run in place without threads", "[CpuWorkerPool]") {
+  jwlrep::CpuWorkerPool cpuWorkerPool{0U};
+  auto future =
+      cpuWorkerPool.submit([]() { return std::this_thread::get_id(); });
+  REQUIRE(future.get() == std::this_thread::get_id());
+}
+
+TEST_CASE("Exception is delivered to the caller", "[CpuWorkerPool]") {
+  jwlrep::CpuWorkerPool cpuWorkerPool{1U};
+  auto future =
+      cpuWorkerPool.submit([]() -> int { throw std::runtime_error("failed"); });
+  REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+}
+
+TEST_CASE("All queued tasks are run", "[CpuWorkerPool]") {
+  std::vector<boost::fibers::future<int>> futures;
+  jwlrep::CpuWorkerPool cpuWorkerPool{3U};
+  for (auto index = 0; index < 100; ++index) {
+    futures.push_back(cpuWorkerPool.submit([index]() { return index * 2; }));
+  }
+  auto sum = 0;
+  for (auto& future : futures) {
+    sum += future.get();
+  }
+  REQUIRE(sum == 99 * 100);
+}
+
+TEST_CASE("Buffered chunks are consumed in order", "[CpuWorkerPool]") {
+  std::vector<std::string> chunks;
+  std::string expected;
+  for (auto index = 0; index < 50; ++index) {
+    chunks.push_back(std::to_string(index) + ",");
+    expected += chunks.back();
+  }
+
+  for (auto const threadsCount : {0U, 1U}) {
+    jwlrep::CpuWorkerPool cpuWorkerPool{threadsCount};
+    std::string document;
+    auto const errorCode = cpuWorkerPool.runBuffered(
+        makeChunkSource(chunks),
+        [&document](jwlrep::ChunkSource const& source) {
+          for (auto chunk = source(); !chunk.empty(); chunk = source()) {
+            document += chunk;
+          }
+          return std::error_code{};
+        });
+    REQUIRE(!errorCode);
+    REQUIRE(document == expected);
+  }
+}
+
+TEST_CASE("Body is consumed while it is being read", "[CpuWorkerPool]") {
+  std::vector<std::string> const chunks(100U, std::string(1000U, 'x'));
+  auto chunkSource = makeChunkSource(chunks);
+  std::atomic<std::size_t> readChunks{0U};
+  jwlrep::ChunkSource const source = [&chunkSource, &readChunks]() {
+    auto const chunk = chunkSource();
+    readChunks += chunk.empty() ? 0U : 1U;
+    return chunk;
+  };
+  jwlrep::CpuWorkerPool cpuWorkerPool{1U};
+  std::size_t readChunksOnStart = 0U;
+  std::size_t documentSize = 0U;
+  auto isDocumentValid = true;
+  auto const errorCode = cpuWorkerPool.runBuffered(
+      source, [&](jwlrep::ChunkSource const& queuedSource) {
+        for (auto chunk = queuedSource(); !chunk.empty();
+             chunk = queuedSource()) {
+          readChunksOnStart =
+              documentSize == 0U ? readChunks.load() : readChunksOnStart;
+          documentSize += chunk.size();
+          isDocumentValid = isDocumentValid &&
+                            chunk.find_first_not_of('x') == std::string::npos;
+        }
+        return std::error_code{};
+      });
+  REQUIRE(!errorCode);
+  REQUIRE(documentSize == 100000U);
+  REQUIRE(isDocumentValid);
+  REQUIRE(readChunksOnStart < chunks.size());
+  // Queue holds only a few chunks besides the ones being pushed and popped
+  REQUIRE(cpuWorkerPool.stats().maxBufferedSize <= 9000U);
+}
+
+TEST_CASE("Source is not read after the function has returned",
+          "[CpuWorkerPool]") {
+  std::vector<std::string> const chunks(100U, "chunk");
+  auto chunkSource = makeChunkSource(chunks);
+  std::size_t readChunks = 0U;
+  jwlrep::ChunkSource const source = [&chunkSource, &readChunks]() {
+    ++readChunks;
+    return chunkSource();
+  };
+  jwlrep::CpuWorkerPool cpuWorkerPool{1U};
+  auto const errorCode = cpuWorkerPool.runBuffered(
+      source, [](jwlrep::ChunkSource const& queuedSource) {
+        queuedSource();
+        return std::error_code{};
+      });
+  REQUIRE(!errorCode);
+  REQUIRE(readChunks < chunks.size());
+}
+
+TEST_CASE("Error of the buffered function is returned", "[CpuWorkerPool]") {
+  std::vector<std::string> const chunks(3U, "chunk");
+  jwlrep::CpuWorkerPool cpuWorkerPool{1U};
+  auto const errorCode = cpuWorkerPool.runBuffered(
+      makeChunkSource(chunks), [](jwlrep::ChunkSource const& /*source*/) {
+        return make_error_code(std::errc::invalid_argument);
+      });
+  REQUIRE(errorCode == std::errc::invalid_argument);
+}
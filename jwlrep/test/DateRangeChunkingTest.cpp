@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/DateRangeChunking.h>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+using boost::gregorian::date;
+using boost::gregorian::date_period;
+using boost::gregorian::days;
+
+auto makeOptions() -> jwlrep::DateRangeChunkingOptions {
+  return jwlrep::DateRangeChunkingOptions{true, 30U, 7U, 90U, 1000U};
+}
+
+}  // namespace
+
+TEST_CASE("Period is split into consecutive sub-ranges",
+          "[DateRangeChunking]") {
+  jwlrep::DateRangeSplitter splitter{
+      date_period{date{2020, 1, 1}, date{2020, 3, 1}}};
+  auto const first = splitter.next(31U);
+  REQUIRE(first);
+  REQUIRE(first->begin() == date{2020, 1, 1});
+  REQUIRE(first->last() == date{2020, 1, 31});
+  auto const second = splitter.next(7U);
+  REQUIRE(second);
+  REQUIRE(second->begin() == date{2020, 2, 1});
+  REQUIRE(second->last() == date{2020, 2, 7});
+  auto const third = splitter.next(100U);
+  REQUIRE(third);
+  REQUIRE(third->begin() == date{2020, 2, 8});
+  REQUIRE(third->last() == date{2020, 2, 29});
+  REQUIRE(!splitter.next(1U));
+}
+
+TEST_CASE("Single day period", "[DateRangeChunking]") {
+  jwlrep::DateRangeSplitter splitter{
+      date_period{date{2020, 1, 1}, date{2020, 1, 1} + days(1)}};
+  auto const range = splitter.next(30U);
+  REQUIRE(range);
+  REQUIRE(range->begin() == range->last());
+  REQUIRE(!splitter.next(30U));
+}
+
+TEST_CASE("Chunk starts with initial length", "[DateRangeChunking]") {
+  jwlrep::ChunkSizeController const controller{makeOptions()};
+  REQUIRE(controller.days() == 30U);
+}
+
+TEST_CASE("Chunk length follows data density", "[DateRangeChunking]") {
+  jwlrep::ChunkSizeController controller{makeOptions()};
+  // 100 bytes per day, target is 1000 bytes
+  controller.onResponse(30U, 3000U);
+  REQUIRE(controller.days() == 10U);
+  // 20 bytes per day
+  for (auto i = 0U; i < 20U; ++i) {
+    controller.onResponse(10U, 200U);
+  }
+  REQUIRE(controller.days() == 50U);
+}
+
+TEST_CASE("Chunk length is bounded", "[DateRangeChunking]") {
+  jwlrep::ChunkSizeController controller{makeOptions()};
+  controller.onResponse(30U, 30000000U);
+  REQUIRE(controller.days() == 7U);
+
+  jwlrep::ChunkSizeController emptyController{makeOptions()};
+  emptyController.onResponse(30U, 0U);
+  REQUIRE(emptyController.days() == 90U);
+}
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/DnsCache.h>
+#include <jwlrep/FiberThreadPool.h>
+
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+/**
+ * Run function in the fiber of the thread which runs io_context.
+ */
+template <typename Fn>
+void runWithIoContext(Fn&& function) {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  threadPool.runOnEachThread([&](std::size_t threadIndex) {
+    if (threadIndex == 1U) {
+      function(threadPool.ioContext(threadIndex));
+    }
+  });
+}
+
+auto firstAddress(jwlrep::DnsCache::Results const& results) -> std::string {
+  REQUIRE_FALSE(results.empty());
+  return results.begin()->endpoint().address().to_string();
+}
+
+jwlrep::DnsCacheOptions const kOptions{true, std::chrono::seconds(300), ""};
+
+}  // namespace
+
+TEST_CASE("Resolved addresses are cached", "[DnsCache]") {
+  jwlrep::DnsCache dnsCache{kOptions};
+  runWithIoContext([&dnsCache](boost::asio::io_context& ioContext) {
+    auto& yield = boost::fibers::asio::this_yield();
+    for (auto index = 0; index < 2; ++index) {
+      auto const resultsOrError =
+          dnsCache.lookup(ioContext, "127.0.0.1", "443", yield);
+      REQUIRE(resultsOrError);
+      REQUIRE(firstAddress(resultsOrError.value()) == "127.0.0.1");
+      REQUIRE(resultsOrError.value().begin()->endpoint().port() == 443U);
+    }
+  });
+
+  auto const stats = dnsCache.stats();
+  REQUIRE(stats.misses == 1U);
+  REQUIRE(stats.hits == 1U);
+  REQUIRE(stats.staleHits == 0U);
+}
+
+TEST_CASE("Cached addresses are saved and loaded", "[DnsCache]") {
+  auto const filePath =
+      std::filesystem::temp_directory_path() / "jwlrep-dns-cache-test";
+  {
+    jwlrep::DnsCache dnsCache{kOptions};
+    runWithIoContext([&dnsCache](boost::asio::io_context& ioContext) {
+      REQUIRE(dnsCache.lookup(ioContext, "127.0.0.1", "443",
+                              boost::fibers::asio::this_yield()));
+    });
+    REQUIRE_FALSE(dnsCache.save(filePath));
+  }
+
+  jwlrep::DnsCache dnsCache{kOptions};
+  REQUIRE_FALSE(dnsCache.load(filePath));
+  runWithIoContext([&dnsCache](boost::asio::io_context& ioContext) {
+    auto const resultsOrError = dnsCache.lookup(
+        ioContext, "127.0.0.1", "443", boost::fibers::asio::this_yield());
+    REQUIRE(resultsOrError);
+    REQUIRE(firstAddress(resultsOrError.value()) == "127.0.0.1");
+  });
+  std::filesystem::remove(filePath);
+
+  auto const stats = dnsCache.stats();
+  REQUIRE(stats.misses == 0U);
+  REQUIRE(stats.hits == 1U);
+}
+
+TEST_CASE("Expired addresses are served until refreshed", "[DnsCache]") {
+  auto const filePath =
+      std::filesystem::temp_directory_path() / "jwlrep-dns-cache-test";
+  std::ofstream(filePath) << "127.0.0.1 443 0 10.0.0.1 443\n";
+
+  jwlrep::DnsCache dnsCache{kOptions};
+  REQUIRE_FALSE(dnsCache.load(filePath));
+  std::filesystem::remove(filePath);
+  runWithIoContext([&dnsCache](boost::asio::io_context& ioContext) {
+    auto& yield = boost::fibers::asio::this_yield();
+    auto resultsOrError = dnsCache.lookup(ioContext, "127.0.0.1", "443", yield);
+    REQUIRE(resultsOrError);
+    REQUIRE(firstAddress(resultsOrError.value()) == "10.0.0.1");
+
+    dnsCache.waitRefreshes();
+    resultsOrError = dnsCache.lookup(ioContext, "127.0.0.1", "443", yield);
+    REQUIRE(resultsOrError);
+    REQUIRE(firstAddress(resultsOrError.value()) == "127.0.0.1");
+  });
+
+  auto const stats = dnsCache.stats();
+  REQUIRE(stats.hits == 2U);
+  REQUIRE(stats.staleHits == 1U);
+  REQUIRE(stats.refreshes == 1U);
+}
@@ -40,4 +40,41 @@ TEST_CASE("No key normalization. Fallback to default assosiation.",
       createOptions("SOP", boost::container::flat_map<std::string, std::string>{
                                {"[Arch]", "Non-SOP"}});
   REQUIRE(jwlrep::calculateLabel("[arch]My Task", options) == "SOP");
-}
\ No newline at end of file
+}
+
+TEST_CASE("Each issue is labeled", "[ExcelReport]") {
+  auto const options =
+      createOptions("SOP", boost::container::flat_map<std::string, std::string>{
+                               {"[arch]", "Non-SOP"}});
+  auto const created = boost::gregorian::date{2020, 11, 21};
+  std::vector<jwlrep::Worklog> worklog;
+  worklog.emplace_back(
+      "Key1", "[Arch] Task",
+      std::vector<jwlrep::Entry>{{std::chrono::hours{1}, "user", created}});
+  worklog.emplace_back(
+      "Key2", "Task",
+      std::vector<jwlrep::Entry>{{std::chrono::hours{2}, "user", created}});
+
+  auto const labeledTimeSheet = jwlrep::labelTimeSheet(
+      jwlrep::UserTimeSheet{std::move(worklog)}, options);
+
+  REQUIRE(labeledTimeSheet.userTimeSheet().worklog().size() == 2U);
+  REQUIRE(labeledTimeSheet.labels() ==
+          std::vector<std::string>{"Non-SOP", "SOP"});
+}
+
+TEST_CASE("User without entries is not added to the report", "[ExcelReport]") {
+  auto const options = createOptions("SOP", {});
+  auto const created = boost::gregorian::date{2020, 11, 21};
+  std::vector<jwlrep::Worklog> worklog;
+  worklog.emplace_back(
+      "Key1", "Task",
+      std::vector<jwlrep::Entry>{{std::chrono::hours{1}, "user", created}});
+
+  jwlrep::ExcelReportWriter reportWriter;
+  reportWriter.add(jwlrep::labelTimeSheet(jwlrep::UserTimeSheet{{}}, options));
+  REQUIRE(reportWriter.worksheetsCount() == 0U);
+  reportWriter.add(jwlrep::labelTimeSheet(
+      jwlrep::UserTimeSheet{std::move(worklog)}, options));
+  REQUIRE(reportWriter.worksheetsCount() == 1U);
+}
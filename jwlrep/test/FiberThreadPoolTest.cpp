@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/FiberThreadPool.h>
+#include <jwlrep/FiberUtil.h>
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Function is called on each thread", "[FiberThreadPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 3U};
+  REQUIRE(threadPool.size() == 3U);
+
+  std::mutex mutex;
+  std::set<std::size_t> indexes;
+  std::set<std::thread::id> threadIds;
+  threadPool.runOnEachThread([&](std::size_t threadIndex) {
+    std::lock_guard<std::mutex> lock(mutex);
+    indexes.insert(threadIndex);
+    threadIds.insert(std::this_thread::get_id());
+  });
+
+  REQUIRE(indexes == std::set<std::size_t>{0U, 1U, 2U});
+  REQUIRE(threadIds.size() == 3U);
+  REQUIRE(threadIds.count(std::this_thread::get_id()) == 1U);
+}
+
+TEST_CASE("Items are shared between threads", "[FiberThreadPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 4U};
+
+  auto const kItemsCount = 1000U;
+  std::atomic<unsigned> nextItem{0U};
+  std::mutex mutex;
+  std::vector<unsigned> processed;
+  threadPool.runOnEachThread([&](std::size_t /*threadIndex*/) {
+    jwlrep::runParallel(2U, [&]() {
+      for (auto item = nextItem.fetch_add(1U); item < kItemsCount;
+           item = nextItem.fetch_add(1U)) {
+        boost::this_fiber::yield();
+        std::lock_guard<std::mutex> lock(mutex);
+        processed.push_back(item);
+      }
+    });
+  });
+
+  std::sort(processed.begin(), processed.end());
+  REQUIRE(processed.size() == kItemsCount);
+  REQUIRE(std::adjacent_find(processed.begin(), processed.end()) ==
+          processed.end());
+}
+
+TEST_CASE("Single thread pool uses calling thread", "[FiberThreadPool]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 1U};
+  std::thread::id threadId;
+  threadPool.runOnEachThread(
+      [&threadId](std::size_t /*threadIndex*/) {
+        threadId = std::this_thread::get_id();
+      });
+  REQUIRE(threadId == std::this_thread::get_id());
+}
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/FiberUtil.h>
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <numeric>
+#include <vector>
+
+TEST_CASE("All items are processed", "[FiberUtil]") {
+  std::vector<int> items(100U);
+  std::iota(items.begin(), items.end(), 0);
+  std::vector<int> processed;
+  jwlrep::forEachParallel(
+      items, 8U, [&processed](int item) { processed.push_back(item); });
+  std::sort(processed.begin(), processed.end());
+  REQUIRE(processed == items);
+}
+
+TEST_CASE("Concurrency is limited", "[FiberUtil]") {
+  std::vector<int> items(50U);
+  auto inFlight = 0U;
+  auto maxInFlight = 0U;
+  jwlrep::forEachParallel(items, 4U, [&](int /*item*/) {
+    maxInFlight = std::max(maxInFlight, ++inFlight);
+    boost::this_fiber::yield();
+    --inFlight;
+  });
+  REQUIRE(maxInFlight == 4U);
+}
+
+TEST_CASE("Empty items", "[FiberUtil]") {
+  std::vector<int> items;
+  auto calls = 0U;
+  jwlrep::forEachParallel(items, 4U, [&calls](int /*item*/) { ++calls; });
+  REQUIRE(calls == 0U);
+}
+
+TEST_CASE("Workers run concurrently", "[FiberUtil]") {
+  auto nextItem = 0U;
+  auto inFlight = 0U;
+  auto maxInFlight = 0U;
+  std::vector<unsigned> processed;
+  jwlrep::runParallel(3U, [&]() {
+    for (auto item = nextItem++; item < 10U; item = nextItem++) {
+      maxInFlight = std::max(maxInFlight, ++inFlight);
+      boost::this_fiber::yield();
+      --inFlight;
+      processed.push_back(item);
+    }
+  });
+  REQUIRE(maxInFlight == 3U);
+  REQUIRE(processed.size() == 10U);
+}
+
+TEST_CASE("All functions are finished", "[FiberUtil]") {
+  auto first = false;
+  auto second = false;
+  jwlrep::waitAll(
+      [&first]() {
+        boost::this_fiber::yield();
+        first = true;
+      },
+      [&second]() { second = true; });
+  REQUIRE(first);
+  REQUIRE(second);
+}
+
+TEST_CASE("Channel is closed after expected values", "[FiberUtil]") {
+  boost::fibers::buffered_channel<int> channel{4U};
+  jwlrep::nchannel<int> producer{channel, 3U};
+  std::vector<int> consumed;
+  jwlrep::waitAll(
+      [&producer]() {
+        producer.push(1);
+        producer.skip();
+        producer.push(2);
+      },
+      [&channel, &consumed]() {
+        for (auto value = 0;
+             channel.pop(value) == boost::fibers::channel_op_status::success;) {
+          consumed.push_back(value);
+        }
+      });
+  REQUIRE(consumed == std::vector<int>{1, 2});
+}
+
+TEST_CASE("Channel without expected values is closed", "[FiberUtil]") {
+  boost::fibers::buffered_channel<int> channel{2U};
+  jwlrep::nchannel<int> producer{channel, 0U};
+  auto value = 0;
+  REQUIRE(channel.pop(value) == boost::fibers::channel_op_status::closed);
+}
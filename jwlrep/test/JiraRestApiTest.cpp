@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/JiraRestApi.h>
+#include <jwlrep/SpillBuffer.h>
+
+#include <catch2/catch.hpp>
+#include <string>
+#include <string_view>
+
+namespace {
+
+using boost::gregorian::date;
+using boost::gregorian::date_period;
+
+date_period const kPeriod{date(2020, 11, 1), date(2020, 12, 1)};
+
+}  // namespace
+
+TEST_CASE("Worklog search query is encoded", "[JiraRestApi]") {
+  auto const target =
+      jwlrep::makeWorklogSearchTarget("John \"J\" Doe", kPeriod, 200U, 100U);
+  REQUIRE(target ==
+          "/rest/api/2/search?jql=worklogAuthor%20%3D%20%22John%20%5C%22J%5C%22"
+          "%20Doe%22%20AND%20worklogDate%20%3E%3D%20%222020-11-01%22%20AND%20"
+          "worklogDate%20%3C%3D%20%222020-11-30%22%20ORDER%20BY%20key%20ASC"
+          "&fields=summary&startAt=200&maxResults=100");
+  REQUIRE(jwlrep::makeIssueWorklogTarget("PRJ-1", 0U, 1000U) ==
+          "/rest/api/2/issue/PRJ-1/worklog?startAt=0&maxResults=1000");
+}
+
+TEST_CASE("Search page is parsed", "[JiraRestApi]") {
+  auto const pageOrError = jwlrep::parseSearchPage(R"(
+    {"expand": "names", "startAt": 0, "maxResults": 50, "total": 120,
+     "issues": [{"id": "1", "key": "PRJ-1", "fields": {"summary": "First"}},
+                {"id": "2", "key": "PRJ-2", "fields": {"summary": "Second"}}]}
+  )");
+  REQUIRE(pageOrError);
+  auto const& page = pageOrError.value();
+  REQUIRE(page.maxResults == 50U);
+  REQUIRE(page.total == 120U);
+  REQUIRE(page.items.size() == 2U);
+  REQUIRE(page.items[1].key == "PRJ-2");
+  REQUIRE(page.items[1].summary == "Second");
+
+  REQUIRE(jwlrep::nextPageStarts(page.maxResults, page.total) ==
+          std::vector<std::size_t>{50U, 100U});
+  REQUIRE(jwlrep::nextPageStarts(50U, 50U).empty());
+
+  REQUIRE_FALSE(jwlrep::parseSearchPage(R"({"issues": []})"));
+}
+
+TEST_CASE("Search page over the body budget is parsed", "[JiraRestApi]") {
+  std::string json = R"({"startAt": 0, "maxResults": 100, "total": 100, )"
+                     R"("issues": [)";
+  for (auto index = 1; index <= 100; ++index) {
+    auto const key = "PRJ-" + std::to_string(index);
+    json += R"({"key": ")" + key + R"(", "fields": {"summary": ")" + key +
+            R"("}})";
+    json += index == 100 ? "]}" : ",";
+  }
+  // Page is received in chunks and spilled past the budget
+  auto const kMemoryBudget = std::size_t{256U};
+  REQUIRE(json.size() > kMemoryBudget);
+  jwlrep::SpillBuffer body{kMemoryBudget, "", 0U};
+  REQUIRE(!body.append([rest = std::string_view{json}]() mutable {
+    auto const chunk = rest.substr(0U, 100U);
+    rest.remove_prefix(chunk.size());
+    return chunk;
+  }));
+  REQUIRE(body.isSpilled());
+  REQUIRE(body.size() == json.size());
+
+  auto const bodyViewOrError = body.view();
+  REQUIRE(bodyViewOrError);
+  auto const pageOrError = jwlrep::parseSearchPage(bodyViewOrError.value());
+  REQUIRE(pageOrError);
+  auto const& page = pageOrError.value();
+  REQUIRE(page.items.size() == 100U);
+  REQUIRE(page.items[99].key == "PRJ-100");
+}
+
+TEST_CASE("Worklog of the user in the period is kept", "[JiraRestApi]") {
+  auto const* const json = R"(
+    {"startAt": 0, "maxResults": 1000, "total": 4, "worklogs": [
+      {"id": "10", "author": {"name": "user", "key": "user"},
+       "started": "2020-11-04T12:00:00.000+0000", "timeSpentSeconds": 3600},
+      {"id": "11", "author": {"name": "other", "key": "other"},
+       "started": "2020-11-04T12:00:00.000+0000", "timeSpentSeconds": 3600},
+      {"id": "12", "author": {"name": "user", "key": "user"},
+       "started": "2020-12-01T09:00:00.000+0000", "timeSpentSeconds": 3600},
+      {"id": "13", "author": {"name": "renamed", "key": "user"},
+       "started": "2020-11-30T23:00:00.000+0300", "timeSpentSeconds": 1800}
+    ]}
+  )";
+  auto const pageOrError = jwlrep::parseWorklogPage(json, "user", kPeriod);
+  REQUIRE(pageOrError);
+  auto const& page = pageOrError.value();
+  REQUIRE(page.total == 4U);
+  REQUIRE(page.items.size() == 2U);
+  REQUIRE(page.items[0].id() == 10U);
+  REQUIRE(page.items[0].author() == "user");
+  REQUIRE(page.items[0].created() == date(2020, 11, 4));
+  REQUIRE(page.items[0].timeSpent() == std::chrono::seconds(3600));
+  REQUIRE(page.items[1].id() == 13U);
+  REQUIRE(page.items[1].created() == date(2020, 11, 30));
+
+  REQUIRE_FALSE(jwlrep::parseWorklogPage(
+      R"({"maxResults": 1, "total": 1, "worklogs": [{"id": "1"}]})", "user",
+      kPeriod));
+}
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/ErrorCodeUtil.h>
+#include <jwlrep/FiberThreadPool.h>
+#include <jwlrep/NetUtil.h>
+
+#include <catch2/catch.hpp>
+#include <vector>
+
+namespace {
+
+using boost::asio::ip::make_address;
+using boost::asio::ip::tcp;
+
+auto makeResults(std::vector<tcp::endpoint> const& endpoints)
+    -> tcp::resolver::results_type {
+  return tcp::resolver::results_type::create(
+      endpoints.begin(), endpoints.end(), "example.com", "https");
+}
+
+auto const kIpv4First = tcp::endpoint{make_address("192.0.2.1"), 443U};
+auto const kIpv4Second = tcp::endpoint{make_address("192.0.2.2"), 443U};
+auto const kIpv6First = tcp::endpoint{make_address("2001:db8::1"), 443U};
+auto const kIpv6Second = tcp::endpoint{make_address("2001:db8::2"), 443U};
+
+}  // namespace
+
+TEST_CASE("Address families alternate", "[NetUtil]") {
+  auto const results =
+      makeResults({kIpv6First, kIpv6Second, kIpv4First, kIpv4Second});
+  REQUIRE(jwlrep::interleaveAddressFamilies(results, std::nullopt) ==
+          std::vector<tcp::endpoint>{kIpv6First, kIpv4First, kIpv6Second,
+                                     kIpv4Second});
+}
+
+TEST_CASE("Preferred address family goes first", "[NetUtil]") {
+  auto const results = makeResults({kIpv6First, kIpv6Second, kIpv4First});
+  REQUIRE(jwlrep::interleaveAddressFamilies(results, tcp::v4()) ==
+          std::vector<tcp::endpoint>{kIpv4First, kIpv6First, kIpv6Second});
+}
+
+TEST_CASE("Connection is made to the responding endpoint", "[NetUtil]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  tcp::acceptor acceptor{ioContext, {make_address("127.0.0.1"), 0U}};
+  auto const listeningEndpoint = acceptor.local_endpoint();
+
+  // Port of the closed acceptor refuses connections
+  tcp::endpoint refusingEndpoint;
+  {
+    tcp::acceptor closedAcceptor{ioContext, {make_address("127.0.0.1"), 0U}};
+    refusingEndpoint = closedAcceptor.local_endpoint();
+  }
+
+  std::optional<tcp::endpoint> connectedEndpoint;
+  std::error_code errorCode;
+  threadPool.runOnEachThread([&](std::size_t threadIndex) {
+    if (threadIndex != 1U) {
+      return;
+    }
+    auto socketOrError = jwlrep::connectFirst(
+        ioContext, {refusingEndpoint, listeningEndpoint},
+        std::chrono::milliseconds(250), std::chrono::seconds(5));
+    if (socketOrError) {
+      connectedEndpoint = socketOrError.value().remote_endpoint();
+    } else {
+      errorCode = socketOrError.error();
+    }
+  });
+
+  REQUIRE_FALSE(errorCode);
+  REQUIRE(connectedEndpoint == listeningEndpoint);
+}
+
+TEST_CASE("Error of the last attempt is returned", "[NetUtil]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  tcp::endpoint refusingEndpoint;
+  {
+    tcp::acceptor closedAcceptor{ioContext, {make_address("127.0.0.1"), 0U}};
+    refusingEndpoint = closedAcceptor.local_endpoint();
+  }
+
+  std::error_code errorCode;
+  threadPool.runOnEachThread([&](std::size_t threadIndex) {
+    if (threadIndex != 1U) {
+      return;
+    }
+    auto const socketOrError =
+        jwlrep::connectFirst(ioContext, {refusingEndpoint, refusingEndpoint},
+                             std::chrono::milliseconds(0),
+                             std::chrono::seconds(5));
+    if (!socketOrError) {
+      errorCode = socketOrError.error();
+    }
+  });
+
+  REQUIRE(errorCode == std::errc::connection_refused);
+}
+
+TEST_CASE("Cancelled connect is not attempted", "[NetUtil]") {
+  jwlrep::FiberThreadPool threadPool{
+      std::make_shared<boost::asio::io_context>(), 2U};
+  auto& ioContext = threadPool.ioContext(1U);
+  tcp::acceptor acceptor{ioContext, {make_address("127.0.0.1"), 0U}};
+
+  std::error_code errorCode;
+  threadPool.runOnEachThread([&](std::size_t threadIndex) {
+    if (threadIndex != 1U) {
+      return;
+    }
+    jwlrep::RequestCancellation cancellation;
+    cancellation.cancel();
+    auto const socketOrError = jwlrep::connectFirst(
+        ioContext, {acceptor.local_endpoint()}, std::chrono::milliseconds(0),
+        std::chrono::seconds(5), &cancellation);
+    if (!socketOrError) {
+      errorCode = socketOrError.error();
+    }
+  });
+
+  REQUIRE(errorCode == jwlrep::toStd(boost::asio::error::operation_aborted));
+}
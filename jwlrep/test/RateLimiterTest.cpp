@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/RateLimiter.h>
+#include <jwlrep/RequestCancellation.h>
+
+#include <boost/fiber/fiber.hpp>
+#include <boost/fiber/operations.hpp>
+#include <catch2/catch.hpp>
+#include <vector>
+
+namespace {
+
+using std::chrono::milliseconds;
+
+}  // namespace
+
+TEST_CASE("Burst is served without waiting", "[RateLimiter]") {
+  auto const startedAt = jwlrep::RateLimiter::Clock::now();
+  jwlrep::RateLimiter rateLimiter{jwlrep::RateLimitOptions{true, 10.0, 3U},
+                                  startedAt};
+  for (auto i = 0U; i < 3U; ++i) {
+    REQUIRE(rateLimiter.reserve(startedAt).count() == 0);
+  }
+  // Each next token is refilled in 100 ms
+  REQUIRE(rateLimiter.reserve(startedAt) == milliseconds(100));
+  REQUIRE(rateLimiter.reserve(startedAt) == milliseconds(200));
+
+  auto const stats = rateLimiter.stats();
+  REQUIRE(stats.requests == 5U);
+  REQUIRE(stats.delayed == 2U);
+}
+
+TEST_CASE("Bucket is refilled up to the burst", "[RateLimiter]") {
+  auto const startedAt = jwlrep::RateLimiter::Clock::now();
+  jwlrep::RateLimiter rateLimiter{jwlrep::RateLimitOptions{true, 10.0, 2U},
+                                  startedAt};
+  REQUIRE(rateLimiter.reserve(startedAt).count() == 0);
+  REQUIRE(rateLimiter.reserve(startedAt).count() == 0);
+  REQUIRE(rateLimiter.reserve(startedAt) == milliseconds(100));
+
+  // Reserved token is paid back first
+  auto const later = startedAt + milliseconds(150);
+  REQUIRE(rateLimiter.reserve(later) == milliseconds(50));
+
+  // Idle period doesn't accumulate more than the burst
+  auto const afterIdle = later + std::chrono::seconds(10);
+  REQUIRE(rateLimiter.reserve(afterIdle).count() == 0);
+  REQUIRE(rateLimiter.reserve(afterIdle).count() == 0);
+  REQUIRE(rateLimiter.reserve(afterIdle) == milliseconds(100));
+}
+
+TEST_CASE("Waiting fibers are suspended", "[RateLimiter]") {
+  jwlrep::RateLimiter rateLimiter{jwlrep::RateLimitOptions{true, 100.0, 1U}};
+  std::vector<boost::fibers::fiber> fibers;
+  for (auto i = 0U; i < 4U; ++i) {
+    fibers.emplace_back([&rateLimiter]() { rateLimiter.acquire(); });
+  }
+  for (auto& fiber : fibers) {
+    fiber.join();
+  }
+
+  // Fibers have waited 10, 20 and 30 ms
+  auto const stats = rateLimiter.stats();
+  REQUIRE(stats.requests == 4U);
+  REQUIRE(stats.delayed == 3U);
+  REQUIRE(stats.waitTime >= milliseconds(60));
+}
+
+TEST_CASE("Cancelled wait ends early and returns the token", "[RateLimiter]") {
+  jwlrep::RateLimiter rateLimiter{jwlrep::RateLimitOptions{true, 1.0, 1U}};
+  REQUIRE(rateLimiter.acquire());
+
+  // Next token is refilled in a second
+  jwlrep::RequestCancellation cancellation;
+  auto isAcquired = true;
+  auto const startedAt = jwlrep::RateLimiter::Clock::now();
+  boost::fibers::fiber waiting{[&rateLimiter, &cancellation, &isAcquired]() {
+    isAcquired = rateLimiter.acquire(&cancellation);
+  }};
+  boost::this_fiber::sleep_for(milliseconds(10));
+  cancellation.cancel();
+  waiting.join();
+  REQUIRE_FALSE(isAcquired);
+  REQUIRE(jwlrep::RateLimiter::Clock::now() - startedAt < milliseconds(500));
+
+  // Returned token is taken by the next request, so it waits no longer than
+  // the cancelled one would have
+  REQUIRE(rateLimiter.reserve(jwlrep::RateLimiter::Clock::now()) <=
+          milliseconds(1000));
+  REQUIRE(rateLimiter.stats().cancelled == 1U);
+}
+
+TEST_CASE("Cancelled request doesn't take the token", "[RateLimiter]") {
+  jwlrep::RateLimiter rateLimiter{jwlrep::RateLimitOptions{true, 1.0, 1U}};
+  jwlrep::RequestCancellation cancellation;
+  cancellation.cancel();
+  REQUIRE_FALSE(rateLimiter.acquire(&cancellation));
+  REQUIRE(rateLimiter.stats().requests == 0U);
+  REQUIRE(rateLimiter.reserve(jwlrep::RateLimiter::Clock::now()).count() == 0);
+}
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/LatencyStats.h>
+#include <jwlrep/RequestHedging.h>
+
+#include <boost/fiber/operations.hpp>
+#include <catch2/catch.hpp>
+#include <memory>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Percentile of latencies", "[RequestHedging]") {
+  jwlrep::LatencyStats latencyStats;
+  REQUIRE(!latencyStats.percentile(0.5));
+  for (auto i = 1; i <= 100; ++i) {
+    latencyStats.add(std::chrono::milliseconds{101 - i});
+  }
+  REQUIRE(latencyStats.count() == 100U);
+  REQUIRE(latencyStats.percentile(0.5) == 50ms);
+  REQUIRE(latencyStats.percentile(0.95) == 95ms);
+  REQUIRE(latencyStats.percentile(1.0) == 100ms);
+  REQUIRE(latencyStats.percentile(0.0) == 1ms);
+}
+
+TEST_CASE("Percentile of latencies in window", "[RequestHedging]") {
+  jwlrep::LatencyStats latencyStats{4U};
+  for (auto i = 0; i < 10; ++i) {
+    latencyStats.add(1s);
+  }
+  for (auto i = 1; i <= 4; ++i) {
+    latencyStats.add(std::chrono::milliseconds{i});
+  }
+  REQUIRE(latencyStats.count() == 14U);
+  REQUIRE(latencyStats.percentile(1.0) == 4ms);
+  REQUIRE(latencyStats.percentile(0.5) == 2ms);
+  latencyStats.add(10ms);
+  REQUIRE(latencyStats.percentile(1.0) == 10ms);
+  REQUIRE(latencyStats.percentile(0.0) == 2ms);
+}
+
+TEST_CASE("Hedging starts after enough samples", "[RequestHedging]") {
+  jwlrep::HedgingPolicy hedgingPolicy(
+      jwlrep::HedgingOptions{true, 0.5, 3U, 1.0});
+  hedgingPolicy.onCompleted(10ms, false);
+  hedgingPolicy.onCompleted(20ms, false);
+  REQUIRE(!hedgingPolicy.hedgeDelay());
+  hedgingPolicy.onCompleted(30ms, false);
+  REQUIRE(hedgingPolicy.hedgeDelay() == 20ms);
+}
+
+TEST_CASE("Hedges are limited by ratio", "[RequestHedging]") {
+  jwlrep::HedgingPolicy hedgingPolicy(
+      jwlrep::HedgingOptions{true, 0.5, 1U, 0.1});
+  for (auto i = 0U; i < 9U; ++i) {
+    hedgingPolicy.onRequest();
+  }
+  REQUIRE(!hedgingPolicy.tryHedge());
+  hedgingPolicy.onRequest();
+  REQUIRE(hedgingPolicy.tryHedge());
+  REQUIRE(!hedgingPolicy.tryHedge());
+  hedgingPolicy.onCompleted(10ms, true);
+
+  auto const stats = hedgingPolicy.stats();
+  REQUIRE(stats.requests == 10U);
+  REQUIRE(stats.hedges == 1U);
+  REQUIRE(stats.hedgeWins == 1U);
+}
+
+TEST_CASE("Background attempts are joined", "[RequestHedging]") {
+  auto isDone = false;
+  jwlrep::BackgroundAttempts backgroundAttempts;
+  auto const isFinished = std::make_shared<bool>(false);
+  backgroundAttempts.add(boost::fibers::fiber{[&isDone, isFinished]() {
+                           boost::this_fiber::sleep_for(20ms);
+                           *isFinished = true;
+                           isDone = true;
+                         }},
+                         isFinished);
+  REQUIRE(backgroundAttempts.size() == 1U);
+  backgroundAttempts.join();
+  REQUIRE(isDone);
+  REQUIRE(backgroundAttempts.size() == 0U);
+}
+
+TEST_CASE("Finished background attempts are released", "[RequestHedging]") {
+  jwlrep::BackgroundAttempts backgroundAttempts;
+  auto const isFinished = std::make_shared<bool>(false);
+  backgroundAttempts.add(
+      boost::fibers::fiber{[isFinished]() { *isFinished = true; }},
+      isFinished);
+  boost::this_fiber::yield();
+  REQUIRE(*isFinished);
+
+  auto const isRunning = std::make_shared<bool>(false);
+  backgroundAttempts.add(boost::fibers::fiber{[]() {
+                           boost::this_fiber::sleep_for(20ms);
+                         }},
+                         isRunning);
+  REQUIRE(backgroundAttempts.size() == 1U);
+  backgroundAttempts.join();
+}
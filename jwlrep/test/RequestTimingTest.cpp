@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/RequestTiming.h>
+
+#include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+using std::chrono::milliseconds;
+
+TEST_CASE("Durations of the repeated phase are summed", "[RequestTiming]") {
+  jwlrep::RequestTiming timing;
+  timing.add(jwlrep::RequestPhase::Write, milliseconds(2));
+
+  jwlrep::RequestTiming retryTiming;
+  retryTiming.add(jwlrep::RequestPhase::Write, milliseconds(3));
+  retryTiming.add(jwlrep::RequestPhase::Body, milliseconds(5));
+  timing.merge(retryTiming);
+
+  REQUIRE(timing.get(jwlrep::RequestPhase::Write) == milliseconds(5));
+  REQUIRE(timing.get(jwlrep::RequestPhase::Body) == milliseconds(5));
+  REQUIRE_FALSE(timing.get(jwlrep::RequestPhase::Connect));
+}
+
+TEST_CASE("User timing contains passed phases", "[RequestTiming]") {
+  jwlrep::RequestTiming timing;
+  timing.add(jwlrep::RequestPhase::FirstByte, milliseconds(12));
+  timing.add(jwlrep::RequestPhase::Parse, std::chrono::microseconds(1500));
+
+  auto const json = nlohmann::json::parse(toJsonLine("User", 2U, timing));
+  REQUIRE(json["user"] == "User");
+  REQUIRE(json["requests"] == 2);
+  REQUIRE(json["ttfbMs"] == 12.0);
+  REQUIRE(json["parseMs"] == 1.5);
+  REQUIRE_FALSE(json.contains("connectMs"));
+}
+
+TEST_CASE("Percentiles are reported per phase", "[RequestTiming]") {
+  jwlrep::RequestTimingStats stats;
+  for (auto index = 1; index <= 100; ++index) {
+    jwlrep::RequestTiming timing;
+    timing.add(jwlrep::RequestPhase::Body, milliseconds(index));
+    stats.add(timing);
+  }
+
+  auto const lines = stats.toJsonLines();
+  REQUIRE(lines.size() == 1U);
+  auto const json = nlohmann::json::parse(lines.front());
+  REQUIRE(json["phase"] == "body");
+  REQUIRE(json["count"] == 100);
+  REQUIRE(json["p50Ms"] == 50.0);
+  REQUIRE(json["p90Ms"] == 90.0);
+  REQUIRE(json["p99Ms"] == 99.0);
+  REQUIRE(json["maxMs"] == 100.0);
+}
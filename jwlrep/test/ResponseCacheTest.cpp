@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/AppConfig.h>
+#include <jwlrep/ContentDecoder.h>
+#include <jwlrep/ResponseCache.h>
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+auto const kDirectoryPath =
+    std::filesystem::temp_directory_path() / "jwlrep-response-cache-test";
+
+auto const kEtag = "\"etag\"";
+
+auto const kLastModified = "Wed, 21 Oct 2015 07:28:00 GMT";
+
+auto openCache(std::size_t maxSize) -> std::unique_ptr<jwlrep::ResponseCache> {
+  auto cacheOrError = jwlrep::ResponseCache::create(
+      jwlrep::ResponseCacheOptions{true, kDirectoryPath.string(), maxSize,
+                                   false});
+  REQUIRE(cacheOrError);
+  return std::move(cacheOrError.value());
+}
+
+auto createCache(std::size_t maxSize)
+    -> std::unique_ptr<jwlrep::ResponseCache> {
+  std::filesystem::remove_all(kDirectoryPath);
+  return openCache(maxSize);
+}
+
+auto countFiles() -> std::ptrdiff_t {
+  return std::distance(std::filesystem::directory_iterator(kDirectoryPath),
+                       std::filesystem::directory_iterator{});
+}
+
+void storeBody(jwlrep::ResponseCache& cache, std::string const& key,
+               std::string_view contentEncoding, std::string const& body) {
+  auto writerOrError = cache.store(key, contentEncoding, kEtag, kLastModified);
+  REQUIRE(writerOrError);
+  auto& writer = *writerOrError.value();
+  auto const kChunkSize = 1000U;
+  for (std::size_t offset = 0U; offset < body.size(); offset += kChunkSize) {
+    writer.write(std::string_view{body}.substr(offset, kChunkSize));
+  }
+  REQUIRE_FALSE(writer.commit());
+}
+
+auto readBody(jwlrep::CachedResponse const& cachedResponse) -> std::string {
+  jwlrep::CachedBodyReader reader{cachedResponse};
+  jwlrep::ChunkSource const source = [&reader]() {
+    return reader.nextChunk();
+  };
+  auto decoderOrError =
+      jwlrep::ContentDecoder::create(cachedResponse.contentEncoding, source);
+  REQUIRE(decoderOrError);
+  auto& decoder = decoderOrError.value();
+  std::string body;
+  for (auto chunk = decoder.nextChunk(); !chunk.empty();
+       chunk = decoder.nextChunk()) {
+    body.append(chunk);
+  }
+  REQUIRE_FALSE(decoder.error());
+  return body;
+}
+
+}  // namespace
+
+TEST_CASE("Stored response is found with validators", "[ResponseCache]") {
+  auto const cache = createCache(1024U * 1024U);
+  REQUIRE_FALSE(cache->find("key"));
+
+  std::string body;
+  auto const kEntriesCount = 1000U;
+  for (auto i = 0U; i < kEntriesCount; ++i) {
+    body += R"({"timeSpent": 3600, "author": "user"})";
+  }
+  storeBody(*cache, "key", "", body);
+
+  auto const cachedResponse = cache->find("key");
+  REQUIRE(cachedResponse);
+  REQUIRE(cachedResponse->etag == kEtag);
+  REQUIRE(cachedResponse->lastModified == kLastModified);
+  // Identity body is compressed
+  REQUIRE(cachedResponse->contentEncoding == "gzip");
+  REQUIRE(std::filesystem::file_size(cachedResponse->filePath) < body.size());
+  REQUIRE(readBody(cachedResponse.value()) == body);
+  REQUIRE(cache->stats().stored == 1U);
+  REQUIRE_FALSE(cache->find("other key"));
+}
+
+TEST_CASE("Uncommitted response is not stored", "[ResponseCache]") {
+  auto const cache = createCache(1024U * 1024U);
+  storeBody(*cache, "key", "", "old");
+  {
+    auto writerOrError = cache->store("key", "", kEtag, kLastModified);
+    REQUIRE(writerOrError);
+    writerOrError.value()->write("new");
+  }
+
+  auto const cachedResponse = cache->find("key");
+  REQUIRE(cachedResponse);
+  REQUIRE(readBody(cachedResponse.value()) == "old");
+  REQUIRE(cache->stats().stored == 1U);
+  // Only the entry is left
+  REQUIRE(countFiles() == 1);
+}
+
+TEST_CASE("Least recently used responses are evicted", "[ResponseCache]") {
+  auto const kMaxSize = 1024U * 1024U;
+  auto const cache = createCache(kMaxSize);
+  // Body which is already encoded is stored as is
+  std::string const body(kMaxSize * 2U / 5U, 'x');
+  auto const pause = []() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  };
+  storeBody(*cache, "first", "gzip", body);
+  pause();
+  storeBody(*cache, "second", "gzip", body);
+  pause();
+  REQUIRE(cache->find("first"));
+  pause();
+  storeBody(*cache, "third", "gzip", body);
+
+  cache->evict();
+
+  REQUIRE(cache->stats().evicted == 1U);
+  REQUIRE(cache->find("first"));
+  REQUIRE_FALSE(cache->find("second"));
+  REQUIRE(cache->find("third"));
+}
+
+TEST_CASE("Response which is being stored is not evicted", "[ResponseCache]") {
+  auto const kMaxSize = 1024U;
+  auto const cache = createCache(kMaxSize);
+  auto writerOrError = cache->store("key", "gzip", kEtag, kLastModified);
+  REQUIRE(writerOrError);
+  auto& writer = *writerOrError.value();
+  writer.write(std::string(kMaxSize * 2U, 'x'));
+
+  cache->evict();
+
+  REQUIRE(cache->stats().evicted == 0U);
+  REQUIRE_FALSE(writer.commit());
+  REQUIRE(cache->find("key"));
+  REQUIRE(countFiles() == 1);
+}
+
+TEST_CASE("Stale temporary files are removed on open", "[ResponseCache]") {
+  createCache(1024U * 1024U);
+  auto const tempFilePath = kDirectoryPath / "0123456789abcdef.0.tmp";
+  // Interrupted run leaves the temporary file behind
+  std::ofstream{tempFilePath} << "interrupted";
+  REQUIRE(std::filesystem::exists(tempFilePath));
+
+  auto const cache = openCache(1024U * 1024U);
+  storeBody(*cache, "key", "", "body");
+
+  REQUIRE_FALSE(std::filesystem::exists(tempFilePath));
+  REQUIRE(cache->find("key"));
+  REQUIRE(countFiles() == 1);
+}
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/GeneralError.h>
+#include <jwlrep/RetryPolicy.h>
+
+#include <catch2/catch.hpp>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+auto makeResponse(boost::beast::http::status status) -> jwlrep::HttpResponse {
+  jwlrep::HttpResponse response;
+  response.result(status);
+  return response;
+}
+
+auto makeOptions() -> jwlrep::RetryOptions {
+  return jwlrep::RetryOptions{4U, 10s, 60s, 500ms, 10s};
+}
+
+}  // namespace
+
+TEST_CASE("Backoff grows exponentially", "[RetryPolicy]") {
+  REQUIRE(jwlrep::computeBackoff(0U, 100ms, 10s, 1.0) == 100ms);
+  REQUIRE(jwlrep::computeBackoff(1U, 100ms, 10s, 1.0) == 200ms);
+  REQUIRE(jwlrep::computeBackoff(3U, 100ms, 10s, 1.0) == 800ms);
+}
+
+TEST_CASE("Backoff is capped", "[RetryPolicy]") {
+  REQUIRE(jwlrep::computeBackoff(10U, 100ms, 1s, 1.0) == 1s);
+  REQUIRE(jwlrep::computeBackoff(100U, 100ms, 1s, 1.0) == 1s);
+}
+
+TEST_CASE("Backoff is jittered", "[RetryPolicy]") {
+  REQUIRE(jwlrep::computeBackoff(2U, 100ms, 10s, 0.0) == 0ms);
+  REQUIRE(jwlrep::computeBackoff(2U, 100ms, 10s, 0.5) == 200ms);
+}
+
+TEST_CASE("Retry-After in seconds", "[RetryPolicy]") {
+  auto const now = std::chrono::system_clock::now();
+  REQUIRE(jwlrep::parseRetryAfter("120", now) == 120s);
+  REQUIRE(jwlrep::parseRetryAfter("0", now) == 0s);
+}
+
+TEST_CASE("Retry-After as HTTP date", "[RetryPolicy]") {
+  // Wed, 21 Oct 2015 07:28:00 GMT
+  auto const date = std::chrono::system_clock::time_point{1445412480s};
+  REQUIRE(jwlrep::parseRetryAfter("Wed, 21 Oct 2015 07:28:00 GMT",
+                                  date - 30s) == 30s);
+  REQUIRE(jwlrep::parseRetryAfter("Wed, 21 Oct 2015 07:28:00 GMT",
+                                  date + 30s) == 0s);
+}
+
+TEST_CASE("Huge Retry-After is capped", "[RetryPolicy]") {
+  auto const now = std::chrono::system_clock::now();
+  REQUIRE(jwlrep::parseRetryAfter("1000000000000000000", now) == 24h);
+  REQUIRE(jwlrep::parseRetryAfter("99999999999999999999999", now) == 24h);
+  REQUIRE(jwlrep::parseRetryAfter("Fri, 31 Dec 9999 23:59:59 GMT", now) ==
+          24h);
+}
+
+TEST_CASE("Malformed Retry-After is ignored", "[RetryPolicy]") {
+  auto const now = std::chrono::system_clock::now();
+  REQUIRE(!jwlrep::parseRetryAfter("", now));
+  REQUIRE(!jwlrep::parseRetryAfter("-5", now));
+  REQUIRE(!jwlrep::parseRetryAfter("10 seconds", now));
+  REQUIRE(!jwlrep::parseRetryAfter("tomorrow", now));
+}
+
+TEST_CASE("Transient failures are retryable", "[RetryPolicy]") {
+  namespace http = boost::beast::http;
+  jwlrep::Expected<jwlrep::HttpResponse> const networkError{
+      jwlrep::GeneralError::NetworkError};
+  REQUIRE(jwlrep::isRetryable(networkError));
+  jwlrep::Expected<jwlrep::HttpResponse> const malformedBody{
+      make_error_code(std::errc::invalid_argument)};
+  REQUIRE(!jwlrep::isRetryable(malformedBody));
+  REQUIRE(jwlrep::isRetryable(makeResponse(http::status::too_many_requests)));
+  REQUIRE(jwlrep::isRetryable(makeResponse(http::status::bad_gateway)));
+  REQUIRE(
+      jwlrep::isRetryable(makeResponse(http::status::service_unavailable)));
+  REQUIRE(!jwlrep::isRetryable(makeResponse(http::status::ok)));
+  REQUIRE(!jwlrep::isRetryable(makeResponse(http::status::unauthorized)));
+  REQUIRE(!jwlrep::isRetryable(makeResponse(http::status::not_found)));
+}
+
+TEST_CASE("Attempts are limited", "[RetryPolicy]") {
+  jwlrep::RetryPolicy retryPolicy(makeOptions());
+  auto const response = makeResponse(boost::beast::http::status::bad_gateway);
+  REQUIRE(retryPolicy.nextDelay(0U, response, 0s));
+  REQUIRE(retryPolicy.nextDelay(2U, response, 0s));
+  REQUIRE(!retryPolicy.nextDelay(3U, response, 0s));
+}
+
+TEST_CASE("Total timeout is respected", "[RetryPolicy]") {
+  jwlrep::RetryPolicy retryPolicy(makeOptions());
+  auto const response = makeResponse(boost::beast::http::status::bad_gateway);
+  REQUIRE(!retryPolicy.nextDelay(0U, response, 60s));
+  REQUIRE(retryPolicy.attemptTimeout(0s) == 10s);
+  REQUIRE(retryPolicy.attemptTimeout(55s) == 5s);
+  REQUIRE(retryPolicy.attemptTimeout(70s) == 0s);
+}
+
+TEST_CASE("Retry-After is honored", "[RetryPolicy]") {
+  jwlrep::RetryPolicy retryPolicy(makeOptions());
+  auto response = makeResponse(boost::beast::http::status::too_many_requests);
+  response.set(boost::beast::http::field::retry_after, "20");
+  REQUIRE(retryPolicy.nextDelay(0U, response, 0s) == 20s);
+  response.set(boost::beast::http::field::retry_after, "120");
+  REQUIRE(!retryPolicy.nextDelay(0U, response, 0s));
+  response.set(boost::beast::http::field::retry_after, "1000000000000000000");
+  REQUIRE(!retryPolicy.nextDelay(0U, response, 0s));
+}
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/SpillBuffer.h>
+
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <string>
+
+namespace {
+
+auto countFiles(std::filesystem::path const& directory) -> std::size_t {
+  return static_cast<std::size_t>(
+      std::distance(std::filesystem::directory_iterator{directory},
+                    std::filesystem::directory_iterator{}));
+}
+
+auto makeDirectory(std::string const& name) -> std::filesystem::path {
+  auto const directory = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  return directory;
+}
+
+}  // namespace
+
+TEST_CASE("Document within the budget is kept in memory", "[SpillBuffer]") {
+  auto const directory = makeDirectory("jwlrep-spill-memory");
+  jwlrep::SpillBuffer buffer{16U, directory, 4U};
+  REQUIRE(!buffer.append("{\"a\":"));
+  REQUIRE(!buffer.append("1}"));
+
+  auto const viewOrError = buffer.view();
+  REQUIRE(viewOrError);
+  auto const view = viewOrError.value();
+  REQUIRE(view == "{\"a\":1}");
+  REQUIRE(std::string(view.data() + view.size(), 4U) == std::string(4U, '\0'));
+  REQUIRE(!buffer.isSpilled());
+  REQUIRE(countFiles(directory) == 0U);
+}
+
+TEST_CASE("Document over the budget is spilled to file", "[SpillBuffer]") {
+  auto const directory = makeDirectory("jwlrep-spill-file");
+  {
+    jwlrep::SpillBuffer buffer{8U, directory, 4U};
+    REQUIRE(!buffer.append("{\"worklog\":"));
+    REQUIRE(buffer.isSpilled());
+    REQUIRE(!buffer.append("[]}"));
+    REQUIRE(buffer.size() == 14U);
+    REQUIRE(countFiles(directory) == 1U);
+
+    auto const viewOrError = buffer.view();
+    REQUIRE(viewOrError);
+    auto const view = viewOrError.value();
+    REQUIRE(view == "{\"worklog\":[]}");
+    REQUIRE(std::string(view.data() + view.size(), 4U) ==
+            std::string(4U, '\0'));
+  }
+  // File is removed with the buffer
+  REQUIRE(countFiles(directory) == 0U);
+}
+
+TEST_CASE("Spill fails if directory doesn't exist", "[SpillBuffer]") {
+  auto const directory = makeDirectory("jwlrep-spill-missing") / "missing";
+  jwlrep::SpillBuffer buffer{4U, directory, 4U};
+  REQUIRE(buffer.append("{\"worklog\":[]}"));
+}
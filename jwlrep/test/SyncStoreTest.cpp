@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/SyncStore.h>
+
+#include <catch2/catch.hpp>
+#include <filesystem>
+
+namespace {
+
+using boost::gregorian::date;
+using boost::gregorian::date_period;
+using boost::gregorian::days;
+
+auto makeTimeSheet(std::vector<std::pair<date, std::uint64_t>> const& entries)
+    -> jwlrep::UserTimeSheet {
+  std::vector<jwlrep::Entry> worklogEntries;
+  for (auto const& [created, id] : entries) {
+    worklogEntries.emplace_back(std::chrono::seconds(3600), "user", created,
+                                id);
+  }
+  std::vector<jwlrep::Worklog> worklog;
+  worklog.emplace_back("K-1", "Summary", std::move(worklogEntries));
+  return jwlrep::UserTimeSheet{std::move(worklog)};
+}
+
+auto entryIds(jwlrep::UserTimeSheet const& userTimeSheet)
+    -> std::vector<std::uint64_t> {
+  std::vector<std::uint64_t> ids;
+  for (auto const& worklog : userTimeSheet.worklog()) {
+    for (auto const& entry : worklog.entries()) {
+      ids.push_back(entry.id().value());
+    }
+  }
+  return ids;
+}
+
+}  // namespace
+
+TEST_CASE("Days since the last sync are requested", "[SyncStore]") {
+  date_period const reportPeriod{date(2020, 11, 1), date(2020, 12, 1)};
+  jwlrep::SyncedTimeSheet syncedTimeSheet{reportPeriod, date(2020, 11, 20),
+                                          date(2020, 11, 20), {}};
+
+  auto const period =
+      jwlrep::incrementalSyncPeriod(reportPeriod, syncedTimeSheet, days(3));
+  REQUIRE(period);
+  REQUIRE(period->begin() == date(2020, 11, 17));
+  REQUIRE(period->end() == reportPeriod.end());
+
+  // Overlap never goes before the report start
+  REQUIRE(jwlrep::incrementalSyncPeriod(reportPeriod, syncedTimeSheet,
+                                        days(30))
+              ->begin() == reportPeriod.begin());
+
+  // Stored timesheet starts after the report
+  syncedTimeSheet.period = {date(2020, 11, 2), date(2020, 12, 1)};
+  REQUIRE_FALSE(
+      jwlrep::incrementalSyncPeriod(reportPeriod, syncedTimeSheet, days(3)));
+
+  // Stored timesheet ends before the requested days
+  syncedTimeSheet.period = {date(2020, 10, 1), date(2020, 11, 10)};
+  REQUIRE_FALSE(
+      jwlrep::incrementalSyncPeriod(reportPeriod, syncedTimeSheet, days(3)));
+}
+
+TEST_CASE("Whole period is requested again after the resync interval",
+          "[SyncStore]") {
+  date_period const reportPeriod{date(2020, 11, 1), date(2020, 12, 1)};
+  jwlrep::SyncedTimeSheet syncedTimeSheet{reportPeriod, date(2020, 11, 20),
+                                          date(2020, 11, 14), {}};
+
+  REQUIRE_FALSE(
+      jwlrep::isFullResyncDue(syncedTimeSheet, days(7), date(2020, 11, 20)));
+  REQUIRE(
+      jwlrep::isFullResyncDue(syncedTimeSheet, days(7), date(2020, 11, 21)));
+
+  // Timesheet stored before the full sync day was tracked
+  syncedTimeSheet.fullySyncedOn = date(boost::gregorian::not_a_date_time);
+  REQUIRE(
+      jwlrep::isFullResyncDue(syncedTimeSheet, days(7), date(2020, 11, 20)));
+}
+
+TEST_CASE("Stored entries of the requested days are replaced",
+          "[SyncStore]") {
+  auto const storedTimeSheet = makeTimeSheet({{date(2020, 10, 31), 1U},
+                                              {date(2020, 11, 1), 2U},
+                                              {date(2020, 11, 16), 3U},
+                                              {date(2020, 11, 17), 4U}});
+  // Entry 4 has been deleted
+  auto fetchedTimeSheet =
+      makeTimeSheet({{date(2020, 11, 18), 5U}, {date(2020, 11, 20), 6U}});
+
+  auto const userTimeSheet = jwlrep::mergeSyncedTimeSheet(
+      storedTimeSheet, date(2020, 11, 1), date(2020, 11, 17),
+      std::move(fetchedTimeSheet));
+
+  REQUIRE(userTimeSheet.worklog().size() == 1U);
+  REQUIRE(entryIds(userTimeSheet) ==
+          std::vector<std::uint64_t>{2U, 3U, 5U, 6U});
+}
+
+TEST_CASE("Synced timesheets are saved and loaded", "[SyncStore]") {
+  auto const filePath =
+      std::filesystem::temp_directory_path() / "jwlrep-sync-store-test";
+  date_period const period{date(2020, 11, 1), date(2020, 12, 1)};
+  {
+    jwlrep::SyncStore syncStore{"server"};
+    syncStore.put("user", {period, date(2020, 11, 20), date(2020, 11, 18),
+                           makeTimeSheet({{date(2020, 11, 2), 1U},
+                                          {date(2020, 11, 19), 2U}})});
+    REQUIRE_FALSE(syncStore.save(filePath));
+  }
+
+  jwlrep::SyncStore syncStore{"server"};
+  REQUIRE_FALSE(syncStore.load(filePath));
+  auto const syncedTimeSheet = syncStore.find("user");
+  REQUIRE(syncedTimeSheet);
+  REQUIRE(syncedTimeSheet->period == period);
+  REQUIRE(syncedTimeSheet->syncedOn == date(2020, 11, 20));
+  REQUIRE(syncedTimeSheet->fullySyncedOn == date(2020, 11, 18));
+  REQUIRE(entryIds(syncedTimeSheet->timeSheet) ==
+          std::vector<std::uint64_t>{1U, 2U});
+  auto const& entry = syncedTimeSheet->timeSheet.worklog().front().entries()[1];
+  REQUIRE(entry.created() == date(2020, 11, 19));
+  REQUIRE(entry.timeSpent() == std::chrono::seconds(3600));
+  REQUIRE(entry.author() == "user");
+  REQUIRE_FALSE(syncStore.find("other user"));
+
+  // Timesheets of the other server are not used
+  jwlrep::SyncStore otherSyncStore{"other server"};
+  REQUIRE_FALSE(otherSyncStore.load(filePath));
+  REQUIRE_FALSE(otherSyncStore.find("user"));
+  std::filesystem::remove(filePath);
+}
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: MIT
+
+// Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
+
+#include <jwlrep/GeneralError.h>
+#include <jwlrep/TlsSessionCache.h>
+
+#include <array>
+#include <catch2/catch.hpp>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <openssl/ssl.h>
+#include <sstream>
+#include <string>
+
+namespace {
+
+using SslPtr = std::unique_ptr<SSL, decltype(&SSL_free)>;
+
+auto const kSessionKey = std::string{"jira.example.com:443"};
+
+auto makeSsl(boost::asio::ssl::context& sslContext) -> SslPtr {
+  return SslPtr{SSL_new(sslContext.native_handle()), &SSL_free};
+}
+
+/**
+ * Resumable TLS 1.2 session as if it was received during the handshake.
+ */
+auto makeSession(SSL* ssl, unsigned char idByte) -> SSL_SESSION* {
+  auto* const session = SSL_SESSION_new();
+  std::array<unsigned char, 32U> id{};
+  id.fill(idByte);
+  std::array<unsigned char, 48U> masterKey{};
+  masterKey.fill(0x42U);
+  SSL_SESSION_set1_id(session, id.data(), id.size());
+  SSL_SESSION_set1_master_key(session, masterKey.data(), masterKey.size());
+  SSL_SESSION_set_protocol_version(session, TLS1_2_VERSION);
+  // TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256
+  std::array<unsigned char, 2U> const cipherId{0xC0U, 0x2FU};
+  SSL_SESSION_set_cipher(session, SSL_CIPHER_find(ssl, cipherId.data()));
+  SSL_SESSION_set_time(session, static_cast<long>(std::time(nullptr)));
+  SSL_SESSION_set_timeout(session, 3600L);
+  return session;
+}
+
+/**
+ * Pass the session to the cache the same way OpenSSL does once the handshake
+ * is done.
+ */
+void addSession(boost::asio::ssl::context& sslContext,
+                jwlrep::TlsSessionCache& cache, std::string const& key,
+                unsigned char idByte) {
+  auto const ssl = makeSsl(sslContext);
+  cache.prepare(ssl.get(), key);
+  auto* const onNewSession =
+      SSL_CTX_sess_get_new_cb(sslContext.native_handle());
+  onNewSession(ssl.get(), makeSession(ssl.get(), idByte));
+}
+
+/**
+ * First byte of the id of the session attached to the new connection, zero
+ * if none is attached.
+ */
+auto preparedSessionIdByte(boost::asio::ssl::context& sslContext,
+                           jwlrep::TlsSessionCache& cache,
+                           std::string const& key) -> unsigned char {
+  auto const ssl = makeSsl(sslContext);
+  cache.prepare(ssl.get(), key);
+  auto const* const session = SSL_get_session(ssl.get());
+  if (session == nullptr) {
+    return 0U;
+  }
+  unsigned int idLength = 0U;
+  auto const* const id = SSL_SESSION_get_id(session, &idLength);
+  return idLength > 0U ? id[0] : 0U;
+}
+
+auto makeFilePath(std::string const& name) -> std::filesystem::path {
+  auto const filePath = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(filePath);
+  return filePath;
+}
+
+auto readFile(std::filesystem::path const& filePath) -> std::string {
+  std::ifstream file(filePath);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+}  // namespace
+
+TEST_CASE("Saved sessions are loaded by the next run", "[TlsSessionCache]") {
+  auto const filePath = makeFilePath("jwlrep-tls-round-trip.txt");
+  {
+    boost::asio::ssl::context sslContext{
+        boost::asio::ssl::context::tls_client};
+    jwlrep::TlsSessionCache cache{sslContext};
+    addSession(sslContext, cache, kSessionKey, 0x11U);
+    addSession(sslContext, cache, "other.example.com:443", 0x22U);
+    REQUIRE(!cache.save(filePath));
+  }
+
+  boost::asio::ssl::context sslContext{boost::asio::ssl::context::tls_client};
+  jwlrep::TlsSessionCache cache{sslContext};
+  REQUIRE(preparedSessionIdByte(sslContext, cache, kSessionKey) == 0U);
+  REQUIRE(!cache.load(filePath));
+  REQUIRE(preparedSessionIdByte(sslContext, cache, kSessionKey) == 0x11U);
+  REQUIRE(preparedSessionIdByte(sslContext, cache, "other.example.com:443") ==
+          0x22U);
+  REQUIRE(preparedSessionIdByte(sslContext, cache, "unknown:443") == 0U);
+  std::filesystem::remove(filePath);
+}
+
+TEST_CASE("Malformed sessions are skipped", "[TlsSessionCache]") {
+  auto const filePath = makeFilePath("jwlrep-tls-malformed.txt");
+  std::string validLine;
+  {
+    boost::asio::ssl::context sslContext{
+        boost::asio::ssl::context::tls_client};
+    jwlrep::TlsSessionCache cache{sslContext};
+    addSession(sslContext, cache, kSessionKey, 0x11U);
+    REQUIRE(!cache.save(filePath));
+    validLine = readFile(filePath);
+  }
+  {
+    std::ofstream file(filePath, std::ios::trunc);
+    // Not base64, base64 of not DER and the valid session
+    file << "bad-base64:443 bm9u*ZTpub25l\n"
+         << "bad-der:443 ZGVtbzpwQDU1dzByZA==\n"
+         << validLine;
+  }
+
+  boost::asio::ssl::context sslContext{boost::asio::ssl::context::tls_client};
+  jwlrep::TlsSessionCache cache{sslContext};
+  REQUIRE(!cache.load(filePath));
+  REQUIRE(preparedSessionIdByte(sslContext, cache, "bad-base64:443") == 0U);
+  REQUIRE(preparedSessionIdByte(sslContext, cache, "bad-der:443") == 0U);
+  REQUIRE(preparedSessionIdByte(sslContext, cache, kSessionKey) == 0x11U);
+  std::filesystem::remove(filePath);
+}
+
+TEST_CASE("Missing sessions file is reported", "[TlsSessionCache]") {
+  boost::asio::ssl::context sslContext{boost::asio::ssl::context::tls_client};
+  jwlrep::TlsSessionCache cache{sslContext};
+  REQUIRE(cache.load(makeFilePath("jwlrep-tls-missing.txt")) ==
+          jwlrep::GeneralError::SystemError);
+}
+
+TEST_CASE("Sessions file is readable by owner only", "[TlsSessionCache]") {
+  auto const filePath = makeFilePath("jwlrep-tls-permissions.txt");
+  boost::asio::ssl::context sslContext{boost::asio::ssl::context::tls_client};
+  jwlrep::TlsSessionCache cache{sslContext};
+  addSession(sslContext, cache, kSessionKey, 0x11U);
+  REQUIRE(!cache.save(filePath));
+
+  using std::filesystem::perms;
+  auto const permissions = std::filesystem::status(filePath).permissions();
+  REQUIRE((permissions & (perms::group_all | perms::others_all)) ==
+          perms::none);
+  REQUIRE((permissions & perms::owner_read) == perms::owner_read);
+  std::filesystem::remove(filePath);
+}
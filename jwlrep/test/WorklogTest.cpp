@@ -2,6 +2,7 @@
 
 // Copyright (C) 2020 Malinovsky Rodion (rodionmalino@gmail.com)
 
+#include <jwlrep/AppConfig.h>
 #include <jwlrep/Worklog.h>
 
 #include <catch2/catch.hpp>
@@ -144,3 +145,263 @@ TEST_CASE("Worklog: Invalid user timesheet. Missing summary", "[Worklog]") {
   REQUIRE(userTimeSheetOrError.has_error());
   REQUIRE(userTimeSheetOrError.error() == std::errc::invalid_argument);
 }
+
+TEST_CASE("Worklog: Invalid user timesheet. Missing author", "[Worklog]") {
+  char const *const worklogJsonStr = R"(
+  {"worklog": [{"key": "Key1", "summary": "Summary1",
+                "entries": [{"timeSpent": 3600, "created": 1604507259177}]}]}
+  )";
+  auto const userTimeSheetOrError =
+      jwlrep::createUserTimeSheetFromJson(worklogJsonStr);
+  REQUIRE(userTimeSheetOrError.has_error());
+  REQUIRE(userTimeSheetOrError.error() == std::errc::invalid_argument);
+}
+
+TEST_CASE("Worklog: Invalid user timesheet. Wrong type", "[Worklog]") {
+  char const *const worklogJsonStr = R"(
+  {"worklog": [{"key": "Key1", "summary": "Summary1",
+                "entries": [{"timeSpent": "1h", "author": "user1",
+                             "created": 1604507259177}]}]}
+  )";
+  auto const userTimeSheetOrError =
+      jwlrep::createUserTimeSheetFromJson(worklogJsonStr);
+  REQUIRE(userTimeSheetOrError.has_error());
+  REQUIRE(userTimeSheetOrError.error() == std::errc::invalid_argument);
+}
+
+TEST_CASE("Worklog: unknown fields are skipped", "[Worklog]") {
+  char const *const worklogJsonStr = R"(
+  {"expand": {"worklog": [{"key": "Fake"}]},
+   "worklog": [{"key": "Key1", "summary": "Summary1",
+                "fields": [{"key": "x", "value": [1, {"a": null}]}],
+                "entries": [{"id": 1, "comment": {"text": "c"},
+                             "timeSpent": 3600, "author": "user1",
+                             "created": 1604507259177, "edited": true}]}],
+   "startDate": 1604181600000}
+  )";
+  auto const userTimeSheetOrError =
+      jwlrep::createUserTimeSheetFromJson(worklogJsonStr);
+  REQUIRE(userTimeSheetOrError.has_value());
+  auto const &worklog = userTimeSheetOrError.value().worklog();
+  REQUIRE(worklog.size() == 1U);
+  REQUIRE(worklog[0U].key() == "Key1");
+  REQUIRE(worklog[0U].entries().size() == 1U);
+  REQUIRE(worklog[0U].entries()[0U].timeSpent() == std::chrono::hours{1});
+}
+
+TEST_CASE("Worklog: comments are ignored", "[Worklog]") {
+  char const *const worklogJsonStr = R"(
+  // Saved response
+  {"worklog": [{"key": "Key1", "summary": "Summary1", /* no fields */
+                "entries": [{"timeSpent": 3600, "author": "user1",
+                             "created": 1604507259177}]}],
+   "startDate": 1604181600000}
+  )";
+  auto const userTimeSheetOrError =
+      jwlrep::createUserTimeSheetFromJson(worklogJsonStr);
+  REQUIRE(userTimeSheetOrError.has_value());
+  REQUIRE(userTimeSheetOrError.value().worklog().size() == 1U);
+}
+
+TEST_CASE("Worklog: timesheet is parsed from chunks", "[Worklog]") {
+  std::string_view const worklogJsonStr = R"(
+  {"worklog": [{"key": "Key1", "summary": "Summary1",
+                "entries": [{"timeSpent": 3600, "author": "user1",
+                             "created": 1604507259177},
+                            {"timeSpent": 7200, "author": "user2",
+                             "created": 1604507697037}]}]}
+  )";
+  auto const kChunkSize = 7U;
+  auto rest = worklogJsonStr;
+  auto chunksCount = 0U;
+  auto const userTimeSheetOrError =
+      jwlrep::createUserTimeSheetFromJson([&rest, &chunksCount]() {
+        auto const chunk = rest.substr(0U, kChunkSize);
+        rest.remove_prefix(chunk.size());
+        ++chunksCount;
+        return chunk;
+      });
+  REQUIRE(userTimeSheetOrError.has_value());
+  REQUIRE(chunksCount > 1U);
+  auto const &entries = userTimeSheetOrError.value().worklog()[0U].entries();
+  REQUIRE(entries.size() == 2U);
+  REQUIRE(entries[1U].author() == "user2");
+  REQUIRE(entries[1U].timeSpent() == std::chrono::hours{2});
+}
+
+#ifdef JWLREP_WITH_SIMDJSON
+
+TEST_CASE("Worklog: simdjson parser gives the same timesheet", "[Worklog]") {
+  std::string_view const worklogJsonStr = R"(
+  {"expand": {"worklog": [{"key": "Fake"}]},
+   "worklog": [{"key": "Key1", "summary": "Summary1",
+                "fields": [{"key": "x", "value": [1, {"a": null}]}],
+                "entries": [{"id": 1, "timeSpent": 3600, "author": "user1",
+                             "created": 1604507259177},
+                            {"timeSpent": 7200.0, "author": "us\u0065r2",
+                             "created": 1604507697037}]},
+               {"key": "Key2", "summary": "Summary2", "entries": []}]}
+  )";
+  auto const expectedOrError =
+      jwlrep::createUserTimeSheetFromJson(worklogJsonStr);
+  REQUIRE(expectedOrError.has_value());
+  auto const userTimeSheetOrError = jwlrep::createUserTimeSheetFromJson(
+      [rest = worklogJsonStr]() mutable {
+        auto const kChunkSize = 7U;
+        auto const chunk = rest.substr(0U, kChunkSize);
+        rest.remove_prefix(chunk.size());
+        return chunk;
+      },
+      jwlrep::JsonParser::Simdjson);
+  REQUIRE(userTimeSheetOrError.has_value());
+
+  auto const &expected = expectedOrError.value().worklog();
+  auto const &worklog = userTimeSheetOrError.value().worklog();
+  REQUIRE(worklog.size() == expected.size());
+  for (auto i = 0U; i < worklog.size(); ++i) {
+    REQUIRE(worklog[i].key() == expected[i].key());
+    REQUIRE(worklog[i].summary() == expected[i].summary());
+    REQUIRE(worklog[i].entries().size() == expected[i].entries().size());
+    for (auto j = 0U; j < worklog[i].entries().size(); ++j) {
+      auto const &entry = worklog[i].entries()[j];
+      auto const &expectedEntry = expected[i].entries()[j];
+      REQUIRE(entry.timeSpent() == expectedEntry.timeSpent());
+      REQUIRE(entry.author() == expectedEntry.author());
+      REQUIRE(entry.created() == expectedEntry.created());
+    }
+  }
+}
+
+TEST_CASE("Worklog: simdjson parser rejects invalid timesheet", "[Worklog]") {
+  auto const isRejected = [](std::string_view worklogJsonStr) {
+    auto isConsumed = false;
+    auto const userTimeSheetOrError = jwlrep::createUserTimeSheetFromJson(
+        [&isConsumed, worklogJsonStr]() {
+          auto const chunk = isConsumed ? std::string_view{} : worklogJsonStr;
+          isConsumed = true;
+          return chunk;
+        },
+        jwlrep::JsonParser::Simdjson);
+    return userTimeSheetOrError.has_error() &&
+           userTimeSheetOrError.error() == std::errc::invalid_argument;
+  };
+  REQUIRE(isRejected(R"({"worklog": [)"));
+  REQUIRE(isRejected(R"({"worklog": [{"key": "Key1", "entries": []}]})"));
+  REQUIRE(isRejected(R"({"worklog": [{"key": "Key1", "summary": "Summary1",
+      "entries": [{"timeSpent": "1h", "author": "user1", "created": 1}]}]})"));
+  REQUIRE(isRejected(R"({"worklog": []} {})"));
+  REQUIRE(isRejected(R"({"issues": []})"));
+}
+
+TEST_CASE("Worklog: simdjson parser reads spilled timesheet", "[Worklog]") {
+  std::string_view const worklogJsonStr = R"(
+  {"worklog": [{"key": "Key1", "summary": "Summary1",
+                "entries": [{"id": 1, "timeSpent": 3600, "author": "user1",
+                             "created": 1604507259177}]}]}
+  )";
+  // Budget is smaller than the document, so it is parsed from the file
+  jwlrep::BodyBufferOptions const bodyBufferOptions{16U, ""};
+  auto const userTimeSheetOrError = jwlrep::createUserTimeSheetFromJson(
+      [rest = worklogJsonStr]() mutable {
+        auto const kChunkSize = 7U;
+        auto const chunk = rest.substr(0U, kChunkSize);
+        rest.remove_prefix(chunk.size());
+        return chunk;
+      },
+      jwlrep::JsonParser::Simdjson, &bodyBufferOptions);
+  REQUIRE(userTimeSheetOrError.has_value());
+  auto const &worklog = userTimeSheetOrError.value().worklog();
+  REQUIRE(worklog.size() == 1U);
+  REQUIRE(worklog[0U].key() == "Key1");
+  REQUIRE(worklog[0U].entries().size() == 1U);
+  REQUIRE(worklog[0U].entries()[0U].timeSpent() ==
+          std::chrono::seconds(3600));
+}
+
+#endif
+
+TEST_CASE("Worklog: entry id is parsed", "[Worklog]") {
+  char const *const worklogJsonStr = R"(
+  {"worklog": [{"key": "Key1", "summary": "Summary1",
+                "entries": [{"id": 10, "timeSpent": 3600, "author": "user1",
+                             "created": 1604507259177},
+                            {"id": "11", "timeSpent": 3600, "author": "user1",
+                             "created": 1604507259177},
+                            {"id": [null], "timeSpent": 3600, "author": "user1",
+                             "created": 1604507259177}]}]}
+  )";
+  auto const userTimeSheetOrError =
+      jwlrep::createUserTimeSheetFromJson(worklogJsonStr);
+  REQUIRE(userTimeSheetOrError.has_value());
+  auto const &entries = userTimeSheetOrError.value().worklog()[0U].entries();
+  REQUIRE(entries.size() == 3U);
+  REQUIRE(entries[0U].id() == 10U);
+  REQUIRE(entries[1U].id() == 11U);
+  REQUIRE(!entries[2U].id());
+}
+
+TEST_CASE("Worklog: timesheets of sub-ranges are merged", "[Worklog]") {
+  auto const makeEntry = [](std::optional<std::uint64_t> id,
+                            std::string author, unsigned short day) {
+    return jwlrep::Entry{std::chrono::hours{1}, std::move(author),
+                         boost::gregorian::date{2020, 11, day}, id};
+  };
+  std::vector<jwlrep::UserTimeSheet> parts;
+  parts.emplace_back(std::vector<jwlrep::Worklog>{
+      jwlrep::Worklog{"Key1", "Summary1",
+                      {makeEntry(1U, "user1", 1), makeEntry(2U, "user1", 2)}},
+      jwlrep::Worklog{"Key2",
+                      "Summary2",
+                      {makeEntry(std::nullopt, "user1", 3),
+                       makeEntry(std::nullopt, "user1", 3)}}});
+  parts.emplace_back(std::vector<jwlrep::Worklog>{
+      jwlrep::Worklog{"Key3", "Summary3", {makeEntry(3U, "user1", 8)}},
+      jwlrep::Worklog{"Key1",
+                      "Summary1",
+                      {makeEntry(2U, "user1", 2), makeEntry(4U, "user1", 9)}},
+      jwlrep::Worklog{"Key2",
+                      "Summary2",
+                      {makeEntry(std::nullopt, "user1", 3),
+                       makeEntry(std::nullopt, "user1", 10)}}});
+
+  auto const userTimeSheet = jwlrep::mergeUserTimeSheets(std::move(parts));
+  auto const &worklog = userTimeSheet.worklog();
+  REQUIRE(worklog.size() == 3U);
+  REQUIRE(worklog[0U].key() == "Key1");
+  REQUIRE(worklog[0U].entries().size() == 3U);
+  REQUIRE(worklog[0U].entries()[2U].id() == 4U);
+  REQUIRE(worklog[1U].key() == "Key2");
+  // Equal entries of the same part are kept, repeated in other part dropped
+  REQUIRE(worklog[1U].entries().size() == 3U);
+  REQUIRE(worklog[1U].entries()[2U].created() ==
+          boost::gregorian::date{2020, 11, 10});
+  REQUIRE(worklog[2U].key() == "Key3");
+  REQUIRE(worklog[2U].summary() == "Summary3");
+}
+
+TEST_CASE("Worklog: timesheet of several users is split by author",
+          "[Worklog]") {
+  auto const makeEntry = [](std::uint64_t id, std::string author) {
+    return jwlrep::Entry{std::chrono::hours{1}, std::move(author),
+                         boost::gregorian::date{2020, 11, 1}, id};
+  };
+  jwlrep::UserTimeSheet const combined{std::vector<jwlrep::Worklog>{
+      jwlrep::Worklog{"Key1",
+                      "Summary1",
+                      {makeEntry(1U, "user1"), makeEntry(2U, "user2"),
+                       makeEntry(3U, "user1")}},
+      jwlrep::Worklog{"Key2", "Summary2", {makeEntry(4U, "user2")}}}};
+
+  auto const timeSheets = jwlrep::splitUserTimeSheet(combined);
+  REQUIRE(timeSheets.size() == 2U);
+  auto const &user1Worklog = timeSheets.at("user1").worklog();
+  REQUIRE(user1Worklog.size() == 1U);
+  REQUIRE(user1Worklog[0U].key() == "Key1");
+  REQUIRE(user1Worklog[0U].summary() == "Summary1");
+  REQUIRE(user1Worklog[0U].entries().size() == 2U);
+  REQUIRE(user1Worklog[0U].entries()[1U].id() == 3U);
+  auto const &user2Worklog = timeSheets.at("user2").worklog();
+  REQUIRE(user2Worklog.size() == 2U);
+  REQUIRE(user2Worklog[0U].entries()[0U].id() == 2U);
+  REQUIRE(user2Worklog[1U].key() == "Key2");
+}